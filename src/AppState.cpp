@@ -16,7 +16,7 @@ namespace kx {
 	// --- UI State ---
 	bool g_isInspectorWindowOpen = true;
 	bool g_showInspectorWindow = true;
-	bool g_capturePaused = false;
+	bool g_showHexDumpPane = true;
 
 	// --- Filtering State ---
 	// Header Filtering
@@ -29,8 +29,7 @@ namespace kx {
 	// Direction Filtering
 	DirectionFilterMode g_packetDirectionFilterMode = DirectionFilterMode::ShowAll; // Default to showing all directions
 
-
-	// --- Shutdown Synchronization ---
-	std::atomic<bool> g_isShuttingDown = false;
+	// Payload Search
+	bool g_showSearchMatchesOnly = false;
 
 } // namespace kx
\ No newline at end of file
@@ -23,7 +23,7 @@ namespace kx {
     // --- UI State ---
     extern bool g_isInspectorWindowOpen; // Controls main loop / unload trigger
     extern bool g_showInspectorWindow;   // Controls GUI visibility (toggle via hotkey)
-    extern bool g_capturePaused;         // Controls packet capture logging
+    extern bool g_showHexDumpPane;       // Hex dump of the focused packet below the log
 
     // --- Filtering State ---
 	// Header Filtering Mode (Include/Exclude/All) - applies to items checked below
@@ -49,7 +49,9 @@ namespace kx {
     };
     extern DirectionFilterMode g_packetDirectionFilterMode;
 
-    // --- Shutdown Synchronization ---
-    extern std::atomic<bool> g_isShuttingDown; // Flag to signal shutdown to hooks
+    // Payload Search: when set, the packet log only shows packets matched by the current search
+    extern bool g_showSearchMatchesOnly;
+
+    // Capture paused / shutting-down / decrypt-on-demand state lives in Capture::g_captureControl (CaptureControl.h)
 
 } // namespace kx
\ No newline at end of file
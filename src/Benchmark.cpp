@@ -0,0 +1,479 @@
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Benchmark.h"
+#include "Config.h"          // For APP_VERSION, MSG_SEND_PATTERN
+#include "CryptoUtils.h"
+#include "FilterExpression.h"
+#include "FilterUtils.h"
+#include "FormattingUtils.h"
+#include "HookQuiescence.h"
+#include "PacketData.h"
+#include "PacketHeaders.h"
+#include "PacketMetadata.h"
+#include "PacketSort.h"
+#include "PatternScanner.h"
+#include "RC4SnapshotPool.h"
+#include "TrafficGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+namespace kx::Benchmark {
+
+    namespace {
+
+        // Fixed seed so every run benchmarks exactly the same inputs.
+        constexpr std::uint32_t SYNTHETIC_SEED = 0x4B58u;
+        constexpr std::size_t SYNTHETIC_LOG_SIZE = 100000;
+
+        std::atomic<bool> s_isRunning = false;
+        std::mutex s_resultsMutex;
+        std::vector<BenchmarkResult> s_lastResults;
+
+        // Prevents the optimizer from discarding benchmarked work.
+        volatile std::size_t s_sink = 0;
+
+        std::string DescribeFilterState(const Filtering::FilterSnapshot& filters) {
+            std::stringstream ss;
+            ss << "log_" << SYNTHETIC_LOG_SIZE << "_mode_";
+            switch (filters.mode) {
+                case FilterMode::IncludeOnly: ss << "include"; break;
+                case FilterMode::Exclude:     ss << "exclude"; break;
+                case FilterMode::ShowAll:
+                default:                      ss << "all"; break;
+            }
+            switch (filters.directionMode) {
+                case DirectionFilterMode::ShowSentOnly:     ss << "_sent"; break;
+                case DirectionFilterMode::ShowReceivedOnly: ss << "_recv"; break;
+                case DirectionFilterMode::ShowAll:
+                default:                                    break;
+            }
+            return ss.str();
+        }
+
+        // Times `iterations` calls of fn after a short warm-up. bytesPerIteration is
+        // used to derive throughput and may be 0.
+        template <typename Fn>
+        BenchmarkResult Measure(const char* name, const std::string& distribution,
+            std::size_t iterations, double bytesPerIteration, Fn&& fn)
+        {
+            for (std::size_t k = 0; k < std::min<std::size_t>(iterations / 10 + 1, 1000); ++k) {
+                fn(k);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t k = 0; k < iterations; ++k) {
+                fn(k);
+            }
+            auto end = std::chrono::steady_clock::now();
+
+            BenchmarkResult result;
+            result.name = name;
+            result.distribution = distribution;
+            result.iterations = iterations;
+            result.totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+            result.nsPerOp = iterations > 0 ? (result.totalMs * 1.0e6) / static_cast<double>(iterations) : 0.0;
+            if (bytesPerIteration > 0.0 && result.totalMs > 0.0) {
+                result.mbPerSec = (bytesPerIteration * static_cast<double>(iterations)) / (result.totalMs * 1000.0);
+            }
+            return result;
+        }
+
+        std::string EscapeJson(const std::string& text) {
+            std::string out;
+            out.reserve(text.size());
+            for (char c : text) {
+                if (c == '"' || c == '\\') out += '\\';
+                out += c;
+            }
+            return out;
+        }
+
+    } // anonymous namespace
+
+
+    std::deque<PacketInfo> MakeSyntheticLog(std::size_t count) {
+        LoadTest::TrafficConfig config;
+        config.seed = SYNTHETIC_SEED;
+        LoadTest::TrafficGenerator generator(config);
+
+        std::deque<PacketInfo> log;
+        auto now = std::chrono::system_clock::now();
+        for (std::size_t n = 0; n < count; ++n) {
+            LoadTest::SyntheticPacket packet = generator.Next();
+            PacketInfo info;
+            info.timestamp = now - std::chrono::milliseconds(count - n);
+            info.direction = packet.direction;
+            info.bufferState = packet.bufferState;
+            info.size = static_cast<int>(packet.payload.size());
+            info.data.assign(packet.payload.data(), packet.payload.data() + packet.payload.size());
+            if (packet.rc4State.has_value()) {
+                PacketPayload decrypted = info.data;
+                Crypto::rc4_process_inplace(packet.rc4State.value(), decrypted.data(), decrypted.size());
+                info.decryptedData = std::move(decrypted);
+            }
+            info.rawHeaderId = info.GetDisplayData()[0];
+            info.name = GetPacketName(info.direction, info.rawHeaderId);
+            if (info.name.find("_UNKNOWN") != std::string::npos) {
+                info.specialType = InternalPacketType::UNKNOWN_HEADER;
+            }
+            log.push_back(std::move(info));
+        }
+        return log;
+    }
+
+    std::string CurrentTimestampIso() {
+        std::time_t now = std::time(nullptr);
+        std::tm utc;
+        gmtime_s(&utc, &now);
+        std::stringstream ss;
+        ss << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ");
+        return ss.str();
+    }
+
+    std::vector<BenchmarkResult> RunAll(const Filtering::FilterSnapshot& filters) {
+        std::vector<BenchmarkResult> results;
+        const std::deque<PacketInfo> log = MakeSyntheticLog(SYNTHETIC_LOG_SIZE);
+        const std::uint8_t rc4Key[] = { 0x4B, 0x58, 0x50, 0x49 };
+        const GameStructs::RC4State rc4 = Crypto::rc4_initialize_state(rc4Key, sizeof(rc4Key));
+
+        // --- rc4_process_inplace ---
+        {
+            // The raw log mix: mostly tens of bytes (CMSG) plus long-tailed SMSG sizes.
+            std::vector<std::vector<std::uint8_t>> buffers;
+            buffers.reserve(4096);
+            for (std::size_t k = 0; k < 4096 && k < log.size(); ++k) buffers.push_back(log[k].data.ToVector());
+            double avgSize = 0.0;
+            for (const auto& b : buffers) avgSize += static_cast<double>(b.size());
+            avgSize /= static_cast<double>(buffers.size());
+
+            results.push_back(Measure("rc4_process_inplace", "packet_mix", 200000, avgSize, [&](std::size_t k) {
+                auto& buffer = buffers[k % buffers.size()];
+                Crypto::rc4_process_inplace(rc4, buffer);
+                s_sink += buffer.empty() ? 0 : buffer[0];
+            }));
+
+            for (std::size_t size : { std::size_t{ 32 }, std::size_t{ 1400 }, std::size_t{ 16 * 1024 } }) {
+                std::vector<std::uint8_t> buffer(size, 0xAB);
+                std::size_t iterations = std::max<std::size_t>(2000, (64u * 1024u * 1024u) / size);
+                results.push_back(Measure("rc4_process_inplace", "fixed_" + std::to_string(size) + "b",
+                    iterations, static_cast<double>(size), [&](std::size_t) {
+                        Crypto::rc4_process_inplace(rc4, buffer);
+                        s_sink += buffer[0];
+                    }));
+            }
+        }
+
+        // --- RC4SnapshotPool (random-access snapshot reconstruction) ---
+        {
+            LoadTest::TrafficConfig config;
+            config.seed = SYNTHETIC_SEED;
+            LoadTest::TrafficGenerator generator(config);
+
+            RC4SnapshotPool pool;
+            std::vector<RC4SnapshotId> ids;
+            ids.reserve(SYNTHETIC_LOG_SIZE);
+            for (std::size_t n = 0; n < SYNTHETIC_LOG_SIZE; ++n) {
+                LoadTest::SyntheticPacket packet = generator.Next();
+                if (!packet.rc4State.has_value()) continue;
+                GameStructs::RC4State after = packet.rc4State.value();
+                Crypto::rc4_process_stream(after, packet.payload.data(), packet.payload.size());
+                ids.push_back(pool.Add(packet.rc4State.value(), packet.payload.size(), after));
+            }
+
+            if (!ids.empty()) {
+                std::mt19937 rng(SYNTHETIC_SEED);
+                std::vector<RC4SnapshotId> order(4096);
+                for (auto& id : order) id = ids[rng() % ids.size()];
+
+                GameStructs::RC4State state;
+                BenchmarkResult get = Measure("RC4SnapshotPool::Get", "random_access_packet_mix", 20000, 0.0, [&](std::size_t k) {
+                    pool.Get(order[k % order.size()], state);
+                    s_sink += state.S[0];
+                });
+                get.bytesPerItem = static_cast<double>(pool.MemoryBytes()) / static_cast<double>(ids.size());
+                results.push_back(get);
+            }
+        }
+
+        // --- InFlightScope (added to every detour invocation) ---
+        {
+            Quiescence::InFlightTracker tracker;
+            results.push_back(Measure("InFlightScope", "enter_exit_uncontended", 10000000, 0.0, [&](std::size_t) {
+                Quiescence::InFlightScope scope(tracker);
+            }));
+        }
+
+        // --- GetPacketName ---
+        {
+            std::vector<std::uint8_t> known;
+            for (const auto& header : GetKnownCMSGHeaders()) known.push_back(header.first);
+            results.push_back(Measure("GetPacketName", "cmsg_known", 1000000, 0.0, [&](std::size_t k) {
+                s_sink += GetPacketName(PacketDirection::Sent, known[k % known.size()]).size();
+            }));
+            results.push_back(Measure("GetPacketName", "smsg_unknown", 1000000, 0.0, [&](std::size_t k) {
+                s_sink += GetPacketName(PacketDirection::Received, static_cast<std::uint8_t>(k)).size();
+            }));
+        }
+
+        // --- ShouldDisplayPacket / GetFilteredPacketIndices ---
+        {
+            const std::string filterDistribution = DescribeFilterState(filters);
+            results.push_back(Measure("ShouldDisplayPacket", filterDistribution, log.size() * 10, 0.0, [&](std::size_t k) {
+                s_sink += Filtering::ShouldDisplayPacket(log[k % log.size()], filters) ? 1 : 0;
+            }));
+            results.push_back(Measure("GetFilteredPacketIndices", filterDistribution, 20, 0.0, [&](std::size_t) {
+                s_sink += Filtering::GetFilteredPacketIndices(log, filters).size();
+            }));
+            const PacketMetadataStore metadata = BuildPacketMetadata(log);
+            const Filtering::FilterKernel bestKernel = Filtering::DetectFilterKernel();
+            for (Filtering::FilterKernel kernel : { Filtering::FilterKernel::Scalar, Filtering::FilterKernel::SSSE3, Filtering::FilterKernel::AVX2 }) {
+                if (static_cast<int>(kernel) > static_cast<int>(bestKernel)) break;
+                results.push_back(Measure("GetFilteredPacketIndices", filterDistribution + "_columnar_" + Filtering::GetFilterKernelName(kernel), 20, 0.0, [&](std::size_t) {
+                    s_sink += Filtering::GetFilteredPacketIndices(log, metadata, kernel, filters).size();
+                }));
+            }
+        }
+
+        // --- Filter expression VM (1M evaluations each; compare with ShouldDisplayPacket above) ---
+        {
+            const std::pair<const char*, const char*> expressions[] = {
+                { "dir_hdr_len", "dir==S && hdr in {0x12,0x0B} && len>20" },
+                { "u32_field", "len > 8 && u32@4 == 0x1234 || hdr == 0x11" },
+                { "bytes_contains", "bytes contains \"41 ?? 42\" && dir==R" },
+            };
+            for (const auto& [label, text] : expressions) {
+                std::string error;
+                auto filter = Filtering::CompileFilterExpression(text, error);
+                if (!filter) {
+                    std::cerr << "[Benchmark] Filter expression failed to compile: " << error << std::endl;
+                    continue;
+                }
+                results.push_back(Measure("CompiledFilter::Evaluate", std::string(label) + "_1m", 1000000, 0.0, [&](std::size_t k) {
+                    s_sink += filter->Evaluate(log[k % log.size()]) ? 1 : 0;
+                }));
+            }
+            results.push_back(Measure("CompileFilterExpression", "dir_hdr_len", 10000, 0.0, [&](std::size_t) {
+                std::string error;
+                s_sink += Filtering::CompileFilterExpression(expressions[0].second, error)->InstructionCount();
+            }));
+        }
+
+        // --- PacketSort (re-sorting a 1M-row view; the synthetic log repeated 10x) ---
+        {
+            constexpr std::size_t SORT_ROWS = 1000000;
+            PacketMetadataStore metadata;
+            metadata.Reserve(SORT_ROWS);
+            PacketInfo row;
+            for (std::size_t n = 0; n < SORT_ROWS; ++n) {
+                const PacketInfo& source = log[n % log.size()];
+                row.timestamp = source.timestamp + std::chrono::milliseconds(log.size() * (n / log.size()));
+                row.direction = source.direction;
+                row.rawHeaderId = source.rawHeaderId;
+                row.specialType = source.specialType;
+                row.size = source.size;
+                row.bufferState = source.bufferState;
+                metadata.Append(row);
+            }
+            std::vector<int> all(SORT_ROWS);
+            for (std::size_t n = 0; n < SORT_ROWS; ++n) all[n] = static_cast<int>(n);
+
+            const std::pair<const char*, std::vector<Sorting::SortSpec>> sorts[] = {
+                { "time_desc_1m", { { Sorting::SortColumn::Time, true } } },
+                { "size_desc_1m", { { Sorting::SortColumn::Size, true } } },
+                { "name_then_delta_1m", { { Sorting::SortColumn::Name, false }, { Sorting::SortColumn::DeltaTime, true } } },
+            };
+            for (const auto& [label, specs] : sorts) {
+                results.push_back(Measure("SortIndices", label, 5, 0.0, [&](std::size_t) {
+                    std::vector<int> view = all;
+                    Sorting::SortIndices(view, metadata, specs);
+                    s_sink += static_cast<std::size_t>(view[0]);
+                }));
+            }
+            results.push_back(Measure("SortIndices", "time_desc_1m_single_thread", 5, 0.0, [&](std::size_t) {
+                std::vector<int> view = all;
+                Sorting::SortIndices(view, metadata, sorts[0].second, 1);
+                s_sink += static_cast<std::size_t>(view[0]);
+            }));
+        }
+
+        // --- Payload storage (copying the original + decrypted payloads of a log entry) ---
+        {
+            const std::size_t sampleCount = std::min<std::size_t>(4096, log.size());
+            std::vector<std::vector<std::uint8_t>> vectors;
+            vectors.reserve(sampleCount);
+            // Footprint per stored payload: the object itself plus whatever it allocates,
+            // counting a typical CRT heap block header for every allocation.
+            constexpr double HEAP_BLOCK_OVERHEAD = 16.0;
+            double vectorHeapBytes = 0.0;
+            double payloadHeapBytes = 0.0;
+            double payloadBytes = 0.0;
+            for (std::size_t k = 0; k < sampleCount; ++k) {
+                const PacketPayload& payload = log[k].data;
+                vectors.push_back(payload.ToVector());
+                payloadBytes += static_cast<double>(payload.size());
+                if (!payload.empty()) vectorHeapBytes += static_cast<double>(payload.size()) + HEAP_BLOCK_OVERHEAD;
+                if (!payload.IsInline()) payloadHeapBytes += static_cast<double>(payload.HeapBytes()) + HEAP_BLOCK_OVERHEAD;
+            }
+            const double avgSize = payloadBytes / static_cast<double>(sampleCount);
+
+            BenchmarkResult vectorCopy = Measure("payload_copy", "std_vector_packet_mix", 200000, avgSize, [&](std::size_t k) {
+                std::vector<std::uint8_t> copy = vectors[k % sampleCount];
+                s_sink += copy.size();
+            });
+            vectorCopy.bytesPerItem = static_cast<double>(sizeof(std::vector<std::uint8_t>)) + vectorHeapBytes / static_cast<double>(sampleCount);
+            results.push_back(vectorCopy);
+
+            BenchmarkResult payloadCopy = Measure("payload_copy", "packet_payload_packet_mix", 200000, avgSize, [&](std::size_t k) {
+                PacketPayload copy = log[k % sampleCount].data;
+                s_sink += copy.size();
+            });
+            payloadCopy.bytesPerItem = static_cast<double>(sizeof(PacketPayload)) + payloadHeapBytes / static_cast<double>(sampleCount);
+            results.push_back(payloadCopy);
+        }
+
+        // --- FormatBytesToHex ---
+        {
+            std::vector<std::uint8_t> small(24, 0x5A);
+            std::vector<std::uint8_t> large(1400, 0x5A);
+            results.push_back(Measure("FormatBytesToHex", "24b_truncate_32", 200000, 24.0, [&](std::size_t) {
+                s_sink += Utils::FormatBytesToHex(small, 32).size();
+            }));
+            results.push_back(Measure("FormatBytesToHex", "1400b_truncate_32", 200000, 32.0, [&](std::size_t) {
+                s_sink += Utils::FormatBytesToHex(large, 32).size();
+            }));
+            results.push_back(Measure("FormatBytesToHex", "1400b_full", 20000, 1400.0, [&](std::size_t) {
+                s_sink += Utils::FormatBytesToHex(large, -1).size();
+            }));
+        }
+
+        // --- FormatDisplayLogEntryString ---
+        {
+            results.push_back(Measure("FormatDisplayLogEntryString", "packet_mix", 200000, 0.0, [&](std::size_t k) {
+                s_sink += Utils::FormatDisplayLogEntryString(log[k % log.size()]).size();
+            }));
+        }
+
+        // --- PatternScanner (worst case: pattern at the very end of a module-sized range) ---
+        {
+            constexpr std::size_t SCAN_SIZE = 8 * 1024 * 1024;
+            std::mt19937 rng(SYNTHETIC_SEED);
+            std::vector<std::uint8_t> image(SCAN_SIZE);
+            for (auto& b : image) b = static_cast<std::uint8_t>(rng());
+            std::vector<int> patternBytes;
+            PatternScanner::PatternToBytes(std::string(MSG_SEND_PATTERN), patternBytes);
+            std::size_t plantAt = image.size() - patternBytes.size();
+            for (std::size_t k = 0; k < patternBytes.size(); ++k) {
+                image[plantAt + k] = patternBytes[k] == -1 ? 0x00 : static_cast<std::uint8_t>(patternBytes[k]);
+            }
+
+            const std::string pattern(MSG_SEND_PATTERN);
+            results.push_back(Measure("PatternScanner::FindPattern", "8mb_match_at_end", 5, static_cast<double>(SCAN_SIZE), [&](std::size_t) {
+                auto found = PatternScanner::FindPatternInRange(pattern, reinterpret_cast<uintptr_t>(image.data()), image.size());
+                s_sink += found.has_value() ? 1 : 0;
+            }));
+        }
+
+        return results;
+    }
+
+
+    bool StartAsync() {
+        bool expected = false;
+        if (!s_isRunning.compare_exchange_strong(expected, true)) {
+            return false;
+        }
+
+        Filtering::FilterSnapshot filters = Filtering::CaptureFilterSnapshot();
+        const bool started = Quiescence::StartBackgroundThread("benchmark", [filters = std::move(filters)]() {
+            try {
+                std::cout << "[Benchmark] Running benchmark suite..." << std::endl;
+                std::vector<BenchmarkResult> results = RunAll(filters);
+                WriteResultsJson(results, RESULTS_JSON_FILE);
+                WriteResultsCsv(results, RESULTS_CSV_FILE);
+                {
+                    std::lock_guard<std::mutex> lock(s_resultsMutex);
+                    s_lastResults = std::move(results);
+                }
+                std::cout << "[Benchmark] Done. Results written to " << RESULTS_JSON_FILE << " and " << RESULTS_CSV_FILE << std::endl;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[Benchmark] Exception: " << e.what() << std::endl;
+            }
+            catch (...) {
+                std::cerr << "[Benchmark] Unknown exception." << std::endl;
+            }
+            s_isRunning = false;
+        });
+        if (!started) {
+            s_isRunning = false;
+        }
+        return started;
+    }
+
+    bool IsRunning() {
+        return s_isRunning.load();
+    }
+
+    std::vector<BenchmarkResult> GetLastResults() {
+        std::lock_guard<std::mutex> lock(s_resultsMutex);
+        return s_lastResults;
+    }
+
+    bool WriteResultsJson(const std::vector<BenchmarkResult>& results, const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[Benchmark] Failed to open " << path << " for writing." << std::endl;
+            return false;
+        }
+
+        out << "{\n";
+        out << "  \"version\": \"" << APP_VERSION << "\",\n";
+        out << "  \"timestamp\": \"" << CurrentTimestampIso() << "\",\n";
+        out << "  \"results\": [\n";
+        out << std::fixed << std::setprecision(3);
+        for (std::size_t k = 0; k < results.size(); ++k) {
+            const auto& r = results[k];
+            out << "    { \"name\": \"" << EscapeJson(r.name) << "\""
+                << ", \"distribution\": \"" << EscapeJson(r.distribution) << "\""
+                << ", \"iterations\": " << r.iterations
+                << ", \"total_ms\": " << r.totalMs
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"mb_per_sec\": " << r.mbPerSec
+                << ", \"bytes_per_item\": " << r.bytesPerItem
+                << " }" << (k + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+        return static_cast<bool>(out);
+    }
+
+    bool WriteResultsCsv(const std::vector<BenchmarkResult>& results, const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[Benchmark] Failed to open " << path << " for writing." << std::endl;
+            return false;
+        }
+
+        out << "version,name,distribution,iterations,total_ms,ns_per_op,mb_per_sec,bytes_per_item\n";
+        out << std::fixed << std::setprecision(3);
+        for (const auto& r : results) {
+            out << APP_VERSION << "," << r.name << "," << r.distribution << ","
+                << r.iterations << "," << r.totalMs << "," << r.nsPerOp << "," << r.mbPerSec << "," << r.bytesPerItem << "\n";
+        }
+        return static_cast<bool>(out);
+    }
+
+} // namespace kx::Benchmark
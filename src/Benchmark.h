@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * @file Benchmark.h
+ * @brief Micro-benchmark suite for the packet inspector's hot paths.
+ * @details Runs crypto, naming, filtering, formatting and pattern scanning code
+ *          over synthetic data shaped like real game traffic and writes the results
+ *          as JSON and CSV so regressions can be tracked across releases.
+ */
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include "PacketData.h" // For PacketInfo
+#include "FilterUtils.h" // For FilterSnapshot
+
+namespace kx::Benchmark {
+
+    /**
+     * @brief Result of a single benchmark case.
+     */
+    struct BenchmarkResult {
+        std::string name;          // Function under test (e.g. "rc4_process_inplace")
+        std::string distribution;  // Input distribution description (e.g. "cmsg_mix")
+        std::size_t iterations = 0;
+        double totalMs = 0.0;      // Wall time for all iterations
+        double nsPerOp = 0.0;      // Mean time per iteration
+        double mbPerSec = 0.0;     // Payload throughput, 0 if not meaningful for the case
+        double bytesPerItem = 0.0; // Memory footprint per item, 0 if not measured by the case
+    };
+
+    /**
+     * @brief Runs every benchmark case synchronously on the calling thread.
+     * @param filters Filter configuration for the filter benchmarks.
+     * @return The results in execution order.
+     */
+    std::vector<BenchmarkResult> RunAll(const Filtering::FilterSnapshot& filters);
+
+    /**
+     * @brief Starts RunAll() on a background thread (see Quiescence::StartBackgroundThread)
+     *        and writes the result files when done. Unload waits for the run to finish.
+     * @details Call on the UI thread: the filter benchmarks use a snapshot of the filters
+     *          taken here.
+     * @return False if a run is already in progress or the thread could not be started.
+     */
+    bool StartAsync();
+
+    /**
+     * @brief Checks whether a background run is in progress.
+     */
+    bool IsRunning();
+
+    /**
+     * @brief Returns a copy of the results of the last completed run.
+     */
+    std::vector<BenchmarkResult> GetLastResults();
+
+    /**
+     * @brief Builds a log the way the processor would from generator traffic.
+     * @details Received packets are RC4-encrypted on the wire and stored with their
+     *          decrypted payload. The same seed is used on every call.
+     */
+    std::deque<PacketInfo> MakeSyntheticLog(std::size_t count);
+
+    /**
+     * @brief Current UTC time as ISO 8601, used to stamp result files.
+     */
+    std::string CurrentTimestampIso();
+
+    /**
+     * @brief Writes results as a JSON document (includes app version and timestamp).
+     * @return True if the file was written successfully.
+     */
+    bool WriteResultsJson(const std::vector<BenchmarkResult>& results, const std::string& path);
+
+    /**
+     * @brief Writes results as CSV with a header row.
+     * @return True if the file was written successfully.
+     */
+    bool WriteResultsCsv(const std::vector<BenchmarkResult>& results, const std::string& path);
+
+    // Default output file names (written to the game's working directory).
+    constexpr const char* RESULTS_JSON_FILE = "kx_benchmark_results.json";
+    constexpr const char* RESULTS_CSV_FILE = "kx_benchmark_results.csv";
+
+} // namespace kx::Benchmark
@@ -0,0 +1,127 @@
+#include "CaptureControl.h"
+#include "HookQuiescence.h" // For StartBackgroundThread
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kx::Capture {
+
+    ControlWord g_captureControl;
+
+    namespace {
+
+        std::atomic<bool> s_toggleTestRunning{ false };
+        std::mutex s_toggleResultMutex;
+        std::optional<ToggleTestResult> s_lastToggleResult;
+
+    } // anonymous namespace
+
+
+    ToggleTestResult RunToggleTest(unsigned readerThreads, int durationMs) {
+        ControlWord control;
+        std::atomic<bool> stop{ false };
+        std::atomic<std::uint64_t> toggles{ 0 };
+        std::atomic<std::uint64_t> reads{ 0 };
+        std::atomic<std::uint64_t> lostUpdates{ 0 };
+        std::atomic<std::uint64_t> violations{ 0 };
+
+        ToggleTestResult result;
+        result.readerThreads = std::max(1u, readerThreads);
+
+        // Synthetic detours: read the word per "packet". Once shutting-down has been
+        // observed it must stay set, since nothing clears it.
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < result.readerThreads; ++t) {
+            threads.emplace_back([&]() {
+                std::uint64_t localReads = 0;
+                bool sawShutdown = false;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const std::uint32_t bits = control.Load();
+                    ++localReads;
+                    if (bits & CONTROL_SHUTTING_DOWN) {
+                        sawShutdown = true;
+                    }
+                    else if (sawShutdown) {
+                        violations.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                reads.fetch_add(localReads, std::memory_order_relaxed);
+            });
+        }
+
+        // UI-like writers, each owning one bit. With a load/store update instead of an
+        // atomic RMW, one writer would regularly undo the other's change.
+        auto writer = [&](std::uint32_t bit) {
+            std::uint64_t localToggles = 0;
+            bool enabled = false;
+            while (!stop.load(std::memory_order_relaxed)) {
+                enabled = !enabled;
+                control.Set(bit, enabled);
+                if (control.IsSet(bit) != enabled) {
+                    lostUpdates.fetch_add(1, std::memory_order_relaxed);
+                }
+                ++localToggles;
+            }
+            toggles.fetch_add(localToggles, std::memory_order_relaxed);
+        };
+        threads.emplace_back(writer, CONTROL_PAUSED);
+        threads.emplace_back(writer, CONTROL_SAMPLING);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(durationMs / 2));
+        control.Set(CONTROL_SHUTTING_DOWN, true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(durationMs - durationMs / 2));
+
+        stop = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        result.toggles = toggles.load();
+        result.reads = reads.load();
+        result.lostUpdates = lostUpdates.load();
+        result.invariantViolations = violations.load();
+        return result;
+    }
+
+    bool StartToggleTestAsync(unsigned readerThreads, int durationMs) {
+        bool expected = false;
+        if (!s_toggleTestRunning.compare_exchange_strong(expected, true)) {
+            return false;
+        }
+
+        const bool started = Quiescence::StartBackgroundThread("toggle-test", [readerThreads, durationMs]() {
+            try {
+                ToggleTestResult result = RunToggleTest(readerThreads, durationMs);
+                std::cout << "[CaptureControl] Toggle test: " << result.toggles << " toggles, " << result.reads << " reads, "
+                    << result.lostUpdates << " lost updates, " << result.invariantViolations << " violations." << std::endl;
+                std::lock_guard<std::mutex> lock(s_toggleResultMutex);
+                s_lastToggleResult = result;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[CaptureControl] Exception: " << e.what() << std::endl;
+            }
+            catch (...) {
+                std::cerr << "[CaptureControl] Unknown exception." << std::endl;
+            }
+            s_toggleTestRunning = false;
+        });
+        if (!started) {
+            s_toggleTestRunning = false;
+        }
+        return started;
+    }
+
+    bool IsToggleTestRunning() {
+        return s_toggleTestRunning.load();
+    }
+
+    std::optional<ToggleTestResult> GetLastToggleTestResult() {
+        std::lock_guard<std::mutex> lock(s_toggleResultMutex);
+        return s_lastToggleResult;
+    }
+
+} // namespace kx::Capture
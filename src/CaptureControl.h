@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @file CaptureControl.h
+ * @brief Single atomic control word read by the detours on every packet.
+ * @details Paused, shutting-down, sampling and decrypt-on-demand state share one 32-bit
+ *          word on its own cache line, so the hot path does one acquire load (a plain MOV on
+ *          x86) and a mask test instead of reading several flags, some of them non-atomic. Writers
+ *          (UI thread, shutdown) are rare and use read-modify-write operations so that
+ *          concurrent toggles of different bits never lose an update.
+ *
+ *          The shutting-down bit only lets detours skip work early; unload safety comes
+ *          from disabling the hooks and waiting on the in-flight counters (see
+ *          HookQuiescence.h), so the detours do not need sequentially consistent loads.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace kx::Capture {
+
+    enum ControlBits : std::uint32_t {
+        CONTROL_PAUSED          = 1u << 0, // User paused capture
+        CONTROL_SHUTTING_DOWN   = 1u << 1, // Unload in progress; detours only forward
+        CONTROL_SAMPLING        = 1u << 2, // Capture a subset of packets only
+        CONTROL_LAZY_DECRYPTION = 1u << 3, // Keep received payloads encrypted (see LazyDecryption.h)
+
+        CONTROL_SKIP_MASK = CONTROL_PAUSED | CONTROL_SHUTTING_DOWN
+    };
+
+    class alignas(64) ControlWord {
+    public:
+        // Hot path: one acquire load of all bits.
+        std::uint32_t Load() const noexcept { return m_bits.load(std::memory_order_acquire); }
+
+        // True unless capture is paused or shutting down.
+        bool ShouldCapture() const noexcept { return (Load() & CONTROL_SKIP_MASK) == 0; }
+
+        bool IsSet(std::uint32_t bits) const noexcept { return (Load() & bits) != 0; }
+
+        void Set(std::uint32_t bits, bool enabled) noexcept {
+            if (enabled) {
+                m_bits.fetch_or(bits, std::memory_order_acq_rel);
+            }
+            else {
+                m_bits.fetch_and(~bits, std::memory_order_acq_rel);
+            }
+        }
+
+    private:
+        std::atomic<std::uint32_t> m_bits{ 0 };
+    };
+
+    static_assert(sizeof(ControlWord) == 64, "ControlWord must occupy exactly one cache line");
+
+    extern ControlWord g_captureControl;
+
+    // --- Concurrency check ---
+
+    /**
+     * @brief Result of a toggle run. `lostUpdates` and `invariantViolations` must be zero.
+     */
+    struct ToggleTestResult {
+        unsigned readerThreads = 0;
+        std::uint64_t toggles = 0;
+        std::uint64_t reads = 0;
+        std::uint64_t lostUpdates = 0;          // A writer's bit change overwritten by another writer
+        std::uint64_t invariantViolations = 0;  // Reader saw shutting-down cleared after it was set
+    };
+
+    /**
+     * @brief Toggles the bits of a private ControlWord from UI-like writer threads while
+     *        `readerThreads` synthetic detours read it.
+     * @details Uses only the standard library; tests/CMakeLists.txt builds it on its own
+     *          under ThreadSanitizer, where the run must also be report-free.
+     */
+    ToggleTestResult RunToggleTest(unsigned readerThreads, int durationMs);
+
+    /**
+     * @brief Runs RunToggleTest on a background thread (see Quiescence::StartBackgroundThread).
+     *        Returns false if one is already running or the thread could not be started.
+     */
+    bool StartToggleTestAsync(unsigned readerThreads, int durationMs);
+    bool IsToggleTestRunning();
+    std::optional<ToggleTestResult> GetLastToggleTestResult();
+
+} // namespace kx::Capture
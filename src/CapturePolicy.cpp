@@ -0,0 +1,130 @@
+#include "CapturePolicy.h"
+#include "CaptureControl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace kx::Capture {
+
+    namespace {
+
+        std::mutex s_policyMutex;  // Serializes writers; readers use the atomics below
+        CapturePolicy s_policy;
+
+        std::atomic<std::uint32_t> s_sampleEvery{ 1 };
+        std::atomic<std::uint32_t> s_maxPerSecond{ 0 };
+        std::atomic<std::uint32_t> s_headerOnlyBytes{ 0 };
+        std::atomic<bool> s_includedOnly{ false };
+        std::atomic<std::uint64_t> s_included[2][4] = {};
+
+        // Arrival counters for 1-in-N sampling, one cache line per direction.
+        struct alignas(64) SampleCounter {
+            std::atomic<std::uint64_t> arrivals{ 0 };
+        };
+        SampleCounter s_sampleCounters[2];
+
+        // Rate cap windows: (second << 32) | count for each (direction, opcode).
+        std::atomic<std::uint64_t> s_rateWindows[2][256] = {};
+
+        std::size_t DirectionIndex(PacketDirection direction) {
+            return direction == PacketDirection::Sent ? 0 : 1;
+        }
+
+        std::uint32_t CurrentSecond() {
+            return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        // Claims one slot in the current one-second window; false once `cap` are used.
+        bool TryTakeRateSlot(std::atomic<std::uint64_t>& window, std::uint32_t cap) {
+            const std::uint64_t second = CurrentSecond();
+            std::uint64_t current = window.load(std::memory_order_relaxed);
+            for (;;) {
+                std::uint64_t next;
+                if ((current >> 32) != second) {
+                    next = (second << 32) | 1u;
+                }
+                else if ((current & 0xFFFFFFFFu) >= cap) {
+                    return false;
+                }
+                else {
+                    next = current + 1;
+                }
+                if (window.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+    } // anonymous namespace
+
+
+    void SetCapturePolicy(const CapturePolicy& policy) {
+        std::lock_guard<std::mutex> lock(s_policyMutex);
+        s_policy = policy;
+        s_policy.sampleEvery = std::max<std::uint32_t>(1, policy.sampleEvery);
+
+        s_sampleEvery.store(s_policy.sampleEvery, std::memory_order_relaxed);
+        s_maxPerSecond.store(s_policy.maxPerSecondPerOpcode, std::memory_order_relaxed);
+        s_headerOnlyBytes.store(s_policy.headerOnlyBytes, std::memory_order_relaxed);
+        s_includedOnly.store(s_policy.includedOpcodesOnly, std::memory_order_relaxed);
+
+        // The acq_rel RMW on the control word publishes the fields above to the detours.
+        g_captureControl.Set(CONTROL_SAMPLING, !s_policy.CapturesEverything());
+    }
+
+    CapturePolicy GetCapturePolicy() {
+        std::lock_guard<std::mutex> lock(s_policyMutex);
+        return s_policy;
+    }
+
+    void SetIncludedOpcodes(const std::uint64_t (&included)[2][4]) {
+        for (int dir = 0; dir < 2; ++dir) {
+            for (int word = 0; word < 4; ++word) {
+                s_included[dir][word].store(included[dir][word], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Admission AdmitPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size, bool headerKnown) {
+        Admission admission;
+        admission.keepBytes = size;
+        if (!g_captureControl.IsSet(CONTROL_SAMPLING)) {
+            return admission;
+        }
+
+        const std::size_t dir = DirectionIndex(direction);
+
+        if (headerKnown && s_includedOnly.load(std::memory_order_relaxed)) {
+            const std::uint64_t word = s_included[dir][headerId >> 6].load(std::memory_order_relaxed);
+            if ((word & (1ull << (headerId & 63))) == 0) {
+                admission.capture = false;
+                return admission;
+            }
+        }
+
+        const std::uint32_t sampleEvery = s_sampleEvery.load(std::memory_order_relaxed);
+        if (sampleEvery > 1) {
+            const std::uint64_t arrival = s_sampleCounters[dir].arrivals.fetch_add(1, std::memory_order_relaxed);
+            if (arrival % sampleEvery != 0) {
+                admission.capture = false;
+                return admission;
+            }
+        }
+
+        const std::uint32_t maxPerSecond = s_maxPerSecond.load(std::memory_order_relaxed);
+        if (headerKnown && maxPerSecond != 0 && !TryTakeRateSlot(s_rateWindows[dir][headerId], maxPerSecond)) {
+            admission.capture = false;
+            return admission;
+        }
+
+        const std::uint32_t headerOnlyBytes = s_headerOnlyBytes.load(std::memory_order_relaxed);
+        if (headerOnlyBytes != 0) {
+            admission.keepBytes = std::min<std::size_t>(size, headerOnlyBytes);
+        }
+        return admission;
+    }
+
+} // namespace kx::Capture
@@ -0,0 +1,65 @@
+#pragma once
+
+/**
+ * @file CapturePolicy.h
+ * @brief Sampling and rate-limiting policies applied in the detours before a packet is copied.
+ * @details The packet processor asks AdmitPacket() as soon as the header byte is known (for
+ *          encrypted packets, after decrypting that one byte on a copy of the RC4 state) and
+ *          before the payload is copied, decrypted or logged. While the CONTROL_SAMPLING bit
+ *          of the capture control word is clear (the default), AdmitPacket returns after a
+ *          single load. Rejected packets cost a few relaxed atomics plus the statistics
+ *          update, so the per-opcode counts and rates keep describing the real traffic (see
+ *          Statistics::RecordSkippedPacket).
+ *
+ *          Policies are checked cheapest first: included opcodes (bit test), 1-in-N sampling
+ *          (one counter per direction), then the per-opcode rate cap (fixed one-second
+ *          windows). Header-only capture does not reject; it limits the bytes kept.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "PacketData.h" // For PacketDirection
+
+namespace kx::Capture {
+
+    struct CapturePolicy {
+        std::uint32_t sampleEvery = 1;          // Keep 1 in N packets per direction (1 = all)
+        std::uint32_t maxPerSecondPerOpcode = 0; // Per (direction, opcode) cap (0 = unlimited)
+        std::uint32_t headerOnlyBytes = 0;      // Keep only the first K payload bytes (0 = whole payload)
+        bool includedOpcodesOnly = false;       // Only opcodes the header filter shows (see SetIncludedOpcodes)
+
+        // True if the policy keeps every packet in full (sampling bit can stay clear).
+        bool CapturesEverything() const {
+            return sampleEvery <= 1 && maxPerSecondPerOpcode == 0 && headerOnlyBytes == 0 && !includedOpcodesOnly;
+        }
+    };
+
+    /**
+     * @brief Outcome of AdmitPacket.
+     */
+    struct Admission {
+        bool capture = true;
+        std::size_t keepBytes = 0; // Payload bytes to copy when captured (<= packet size)
+    };
+
+    /**
+     * @brief Installs a policy and sets or clears CONTROL_SAMPLING accordingly.
+     */
+    void SetCapturePolicy(const CapturePolicy& policy);
+    CapturePolicy GetCapturePolicy();
+
+    /**
+     * @brief Publishes the (direction, opcode) pairs kept by `includedOpcodesOnly`.
+     * @details Filtering::PublishCaptureOpcodes() keeps them in sync with the log filters.
+     * @param included One bit per opcode: bit (h & 63) of word [direction][h >> 6], direction 0 = sent.
+     */
+    void SetIncludedOpcodes(const std::uint64_t (&included)[2][4]);
+
+    /**
+     * @brief Decides whether to capture a packet. Thread-safe, lock-free.
+     * @param headerKnown False if the header could not be determined (e.g. no RC4 state);
+     *                    only sampling applies then.
+     */
+    Admission AdmitPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size, bool headerKnown);
+
+} // namespace kx::Capture
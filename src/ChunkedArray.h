@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file ChunkedArray.h
+ * @brief Append-only array stored in fixed-size chunks.
+ * @details Growing allocates one new chunk and never moves existing elements, so an append
+ *          costs the same at any size (a std::vector copies everything when it doubles).
+ *          Elements within one chunk are contiguous; Data()/ContiguousSize() expose those
+ *          runs to code that scans raw arrays.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace kx {
+
+    template <typename T, std::size_t ChunkSize = 4096>
+    class ChunkedArray {
+    public:
+        static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+        static constexpr std::size_t CHUNK_SIZE = ChunkSize;
+
+        void PushBack(const T& value) {
+            if (m_size == m_chunks.size() * CHUNK_SIZE) {
+                m_chunks.push_back(std::make_unique<T[]>(CHUNK_SIZE));
+            }
+            (*this)[m_size++] = value;
+        }
+
+        T& operator[](std::size_t i) { return m_chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+        const T& operator[](std::size_t i) const { return m_chunks[i / CHUNK_SIZE][i % CHUNK_SIZE]; }
+        T& Back() { return (*this)[m_size - 1]; }
+        std::size_t Size() const { return m_size; }
+        bool Empty() const { return m_size == 0; }
+
+        // Pointer to element i; the next ContiguousSize(i) elements follow it in memory.
+        const T* Data(std::size_t i) const { return &(*this)[i]; }
+        std::size_t ContiguousSize(std::size_t i) const { return std::min(m_size - i, CHUNK_SIZE - i % CHUNK_SIZE); }
+
+        std::size_t MemoryBytes() const {
+            return m_chunks.size() * CHUNK_SIZE * sizeof(T) + m_chunks.capacity() * sizeof(std::unique_ptr<T[]>);
+        }
+
+        // Reserves the chunk table only; chunks are still allocated as they fill.
+        void Reserve(std::size_t count) {
+            m_chunks.reserve((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        }
+
+        void Clear() {
+            std::vector<std::unique_ptr<T[]>>().swap(m_chunks);
+            m_size = 0;
+        }
+
+        // First index in [first, last) whose element is not less than `value` under `less`.
+        template <typename V, typename Less>
+        std::size_t LowerBound(std::size_t first, std::size_t last, const V& value, Less less) const {
+            while (first < last) {
+                const std::size_t middle = first + (last - first) / 2;
+                if (less((*this)[middle], value)) first = middle + 1;
+                else last = middle;
+            }
+            return first;
+        }
+
+    private:
+        std::vector<std::unique_ptr<T[]>> m_chunks;
+        std::size_t m_size = 0;
+    };
+
+} // namespace kx
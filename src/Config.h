@@ -2,6 +2,12 @@
 
 #include <string_view> // For std::string_view
 
+// Compile-time switch for the hook latency instrumentation (HookMetrics.h).
+// Define as 0 (e.g. in the project's preprocessor definitions) to remove it entirely.
+#ifndef KX_ENABLE_HOOK_METRICS
+#define KX_ENABLE_HOOK_METRICS 1
+#endif
+
 namespace kx {
     constexpr std::string_view APP_VERSION = "1.2";
 
@@ -0,0 +1,191 @@
+#include "ControlLoop.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kx::Control {
+
+    namespace {
+
+        struct Task {
+            std::string name;
+            std::uint64_t intervalTicks = 1;
+            std::uint64_t deadlineTick = 0; // Absolute tick the task is due at
+            bool periodic = true;
+            std::function<void()> fn;
+        };
+
+        std::mutex s_mutex;
+        std::condition_variable s_wake;
+        bool s_shutdownRequested = false;
+        bool s_scheduleChanged = false; // A task was added while Run() was waiting
+
+        const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+        std::uint64_t s_processedTick = 0; // Every slot up to and including this tick has been handled
+
+        std::unordered_map<TaskId, Task> s_tasks;
+        std::vector<std::vector<TaskId>> s_wheel(WHEEL_SLOTS);
+        TaskId s_nextId = 1;
+
+        std::uint64_t CurrentTick() {
+            return static_cast<std::uint64_t>((std::chrono::steady_clock::now() - s_epoch) / WHEEL_TICK);
+        }
+
+        std::chrono::steady_clock::time_point TimeOfTick(std::uint64_t tick) {
+            return s_epoch + WHEEL_TICK * tick;
+        }
+
+        void Insert(TaskId id, Task& task) {
+            s_wheel[task.deadlineTick % WHEEL_SLOTS].push_back(id);
+        }
+
+        std::uint64_t ToTicks(std::chrono::milliseconds interval) {
+            return std::max<std::uint64_t>(1, static_cast<std::uint64_t>((interval + WHEEL_TICK - std::chrono::milliseconds(1)) / WHEEL_TICK));
+        }
+
+        TaskId Schedule(const char* name, std::chrono::milliseconds interval, bool periodic, std::function<void()> task) {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            const TaskId id = s_nextId++;
+            Task& entry = s_tasks[id];
+            entry.name = name;
+            entry.intervalTicks = ToTicks(interval);
+            entry.deadlineTick = std::max(CurrentTick(), s_processedTick) + entry.intervalTicks;
+            entry.periodic = periodic;
+            entry.fn = std::move(task);
+            Insert(id, entry);
+            s_scheduleChanged = true;
+            s_wake.notify_all();
+            return id;
+        }
+
+        // Earliest tick within the next revolution that has a due task, or 0 if none.
+        // Requires s_mutex.
+        std::uint64_t NextDueTick() {
+            for (std::uint64_t tick = s_processedTick + 1; tick <= s_processedTick + WHEEL_SLOTS; ++tick) {
+                for (TaskId id : s_wheel[tick % WHEEL_SLOTS]) {
+                    auto found = s_tasks.find(id);
+                    if (found != s_tasks.end() && found->second.deadlineTick <= tick) {
+                        return tick;
+                    }
+                }
+            }
+            return 0;
+        }
+
+        // Removes the tasks due by `tick` from the slots passed since the last call.
+        // Requires s_mutex.
+        void CollectDue(std::uint64_t tick, std::vector<TaskId>& due) {
+            const std::uint64_t first = s_processedTick + 1;
+            const std::uint64_t last = std::min(tick, s_processedTick + WHEEL_SLOTS);
+            for (std::uint64_t t = first; t <= last; ++t) {
+                auto& slot = s_wheel[t % WHEEL_SLOTS];
+                for (std::size_t k = 0; k < slot.size();) {
+                    auto found = s_tasks.find(slot[k]);
+                    if (found == s_tasks.end()) {
+                        slot[k] = slot.back(); // Cancelled
+                        slot.pop_back();
+                    }
+                    else if (found->second.deadlineTick <= tick) {
+                        due.push_back(slot[k]);
+                        slot[k] = slot.back();
+                        slot.pop_back();
+                    }
+                    else {
+                        ++k; // Due on a later revolution
+                    }
+                }
+            }
+            s_processedTick = std::max(s_processedTick, tick);
+        }
+
+    } // anonymous namespace
+
+
+    TaskId SchedulePeriodic(const char* name, std::chrono::milliseconds interval, std::function<void()> task) {
+        return Schedule(name, interval, true, std::move(task));
+    }
+
+    TaskId ScheduleOnce(const char* name, std::chrono::milliseconds delay, std::function<void()> task) {
+        return Schedule(name, delay, false, std::move(task));
+    }
+
+    void Cancel(TaskId id) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_tasks.erase(id); // The stale slot entry is dropped lazily by CollectDue
+    }
+
+    void RequestShutdown() {
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            s_shutdownRequested = true;
+        }
+        s_wake.notify_all();
+    }
+
+    bool IsShutdownRequested() {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        return s_shutdownRequested;
+    }
+
+    void Run() {
+        std::vector<TaskId> due;
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_processedTick = std::max(s_processedTick, CurrentTick());
+
+        while (!s_shutdownRequested) {
+            s_scheduleChanged = false;
+            const std::uint64_t nextTick = NextDueTick();
+            auto wakeCondition = [] { return s_shutdownRequested || s_scheduleChanged; };
+            if (nextTick == 0 && s_tasks.empty()) {
+                s_wake.wait(lock, wakeCondition);
+            }
+            else {
+                // With nothing due this revolution, wake once per revolution to advance it.
+                const std::uint64_t wakeTick = nextTick != 0 ? nextTick : s_processedTick + WHEEL_SLOTS;
+                s_wake.wait_until(lock, TimeOfTick(wakeTick), wakeCondition);
+            }
+            if (s_shutdownRequested) {
+                break;
+            }
+
+            due.clear();
+            CollectDue(CurrentTick(), due);
+
+            for (TaskId id : due) {
+                auto found = s_tasks.find(id);
+                if (found == s_tasks.end()) continue;
+                std::function<void()> fn = found->second.fn;
+                std::string name = found->second.name;
+
+                lock.unlock();
+                try {
+                    fn();
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "[ControlLoop] Task '" << name << "' threw: " << e.what() << std::endl;
+                }
+                catch (...) {
+                    std::cerr << "[ControlLoop] Task '" << name << "' threw an unknown exception." << std::endl;
+                }
+                lock.lock();
+
+                // Fixed-interval from now: a late run is not followed by catch-up runs.
+                found = s_tasks.find(id);
+                if (found != s_tasks.end() && !found->second.periodic) {
+                    s_tasks.erase(found);
+                }
+                else if (found != s_tasks.end()) {
+                    found->second.deadlineTick = std::max(CurrentTick(), s_processedTick) + found->second.intervalTicks;
+                    Insert(id, found->second);
+                }
+            }
+        }
+    }
+
+} // namespace kx::Control
@@ -0,0 +1,57 @@
+#pragma once
+
+/**
+ * @file ControlLoop.h
+ * @brief Wait-based control loop for the DLL's main thread, with a timer wheel for
+ *        periodic maintenance tasks.
+ * @details Run() blocks on a condition variable until either RequestShutdown() is called
+ *          (by the UI when the window is closed, or by the unload hotkey handler) or the
+ *          next scheduled task is due, so the thread does not wake while idle and unload
+ *          starts immediately. Tasks live in a hashed timer wheel of WHEEL_SLOTS slots of
+ *          WHEEL_TICK each; a task sits in the slot of its deadline and only fires on the
+ *          revolution the deadline falls in. Tasks run on the loop thread, one at a time;
+ *          one-shot tasks are removed after their run.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace kx::Control {
+
+    using TaskId = std::uint32_t;
+
+    constexpr std::chrono::milliseconds WHEEL_TICK{ 10 };
+    constexpr std::size_t WHEEL_SLOTS = 512; // One revolution = 5.12 s
+
+    /**
+     * @brief Schedules `task` to run every `interval` (rounded up to WHEEL_TICK), first
+     *        one interval from now. Thread-safe.
+     * @param name Short label used in error messages.
+     */
+    TaskId SchedulePeriodic(const char* name, std::chrono::milliseconds interval, std::function<void()> task);
+
+    /**
+     * @brief Schedules `task` to run once, `delay` from now (rounded up to WHEEL_TICK).
+     *        Thread-safe; lets event sources wake the loop only when there is work.
+     */
+    TaskId ScheduleOnce(const char* name, std::chrono::milliseconds delay, std::function<void()> task);
+
+    /**
+     * @brief Removes a task. A run already in progress finishes. Thread-safe.
+     */
+    void Cancel(TaskId id);
+
+    /**
+     * @brief Wakes Run() and makes it return. Thread-safe, idempotent.
+     */
+    void RequestShutdown();
+
+    bool IsShutdownRequested();
+
+    /**
+     * @brief Runs due tasks until RequestShutdown() is called.
+     */
+    void Run();
+
+} // namespace kx::Control
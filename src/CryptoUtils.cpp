@@ -69,6 +69,18 @@ namespace kx::Crypto {
         rc4_prga_core(captured_state.i, captured_state.j, captured_state.S, data.data(), data.size());
     }
 
+    // Public function: Modifies a raw buffer in place
+    void rc4_process_inplace(
+        const kx::GameStructs::RC4State& captured_state,
+        std::uint8_t* data,
+        std::size_t length)
+    {
+        if (data == nullptr || length == 0) {
+            return; // Nothing to process
+        }
+        rc4_prga_core(captured_state.i, captured_state.j, captured_state.S, data, length);
+    }
+
     // Public function: Returns a new vector
     std::vector<std::uint8_t> rc4_process_copy(
         const kx::GameStructs::RC4State& captured_state,
@@ -85,5 +97,72 @@ namespace kx::Crypto {
         return processed_data;
     }
 
+    // Public function: Standard RC4 key schedule
+    kx::GameStructs::RC4State rc4_initialize_state(
+        const std::uint8_t* key,
+        std::size_t keyLength)
+    {
+        kx::GameStructs::RC4State state;
+        for (int k = 0; k < 256; ++k) {
+            state.S[k] = static_cast<std::uint8_t>(k);
+        }
+        if (key == nullptr || keyLength == 0) {
+            return state; // Identity permutation
+        }
+
+        std::uint8_t j = 0;
+        for (int k = 0; k < 256; ++k) {
+            j = static_cast<std::uint8_t>(j + state.S[k] + key[k % keyLength]);
+            std::uint8_t temp = state.S[k];
+            state.S[k] = state.S[j];
+            state.S[j] = temp;
+        }
+        state.i = 0;
+        state.j = 0;
+        return state;
+    }
+
+    // Public function: Processes data and keeps the state advancing across calls
+    void rc4_process_stream(
+        kx::GameStructs::RC4State& state,
+        std::uint8_t* data,
+        std::size_t length)
+    {
+        std::uint8_t i = static_cast<std::uint8_t>(state.i & 0xFF);
+        std::uint8_t j = static_cast<std::uint8_t>(state.j & 0xFF);
+        auto& S = state.S;
+
+        for (std::size_t k = 0; k < length; ++k) {
+            i = i + 1;
+            std::uint8_t a = S[i];
+            j = j + a;
+            S[i] = S[j];
+            S[j] = a;
+            data[k] ^= S[static_cast<std::uint8_t>(S[i] + a)];
+        }
+
+        state.i = i;
+        state.j = j;
+    }
+
+    void rc4_skip(
+        kx::GameStructs::RC4State& state,
+        std::size_t length)
+    {
+        std::uint8_t i = static_cast<std::uint8_t>(state.i & 0xFF);
+        std::uint8_t j = static_cast<std::uint8_t>(state.j & 0xFF);
+        auto& S = state.S;
+
+        for (std::size_t k = 0; k < length; ++k) {
+            i = i + 1;
+            std::uint8_t a = S[i];
+            j = j + a;
+            S[i] = S[j];
+            S[j] = a;
+        }
+
+        state.i = i;
+        state.j = j;
+    }
 
 } // namespace kx::Crypto
\ No newline at end of file
@@ -26,6 +26,15 @@ namespace kx::Crypto {
         std::vector<std::uint8_t>& data
     );
 
+    /**
+     * @brief Pointer/length overload of rc4_process_inplace for non-vector buffers.
+     */
+    void rc4_process_inplace(
+        const kx::GameStructs::RC4State& captured_state,
+        std::uint8_t* data,
+        std::size_t length
+    );
+
     /**
     * @brief Decrypts/Encrypts data using RC4 with a provided state snapshot (non-inplace).
     * @details Similar to rc4_process_inplace, but returns a new vector with the result.
@@ -38,5 +47,42 @@ namespace kx::Crypto {
         const std::vector<std::uint8_t>& input_data
     );
 
+    /**
+     * @brief Runs the RC4 key schedule (KSA) and returns a fresh state with i = j = 0.
+     * @details The game's key exchange is not reproduced here; this is used to create
+     *          realistic RC4 streams for synthetic traffic and benchmarks.
+     * @param key Pointer to the key bytes.
+     * @param keyLength Number of key bytes (must be > 0).
+     * @return The initialized RC4State.
+     */
+    kx::GameStructs::RC4State rc4_initialize_state(
+        const std::uint8_t* key,
+        std::size_t keyLength
+    );
+
+    /**
+     * @brief Encrypts/decrypts a buffer and advances the given state, like the game does.
+     * @details Unlike rc4_process_inplace, the state is updated so consecutive calls
+     *          continue the same keystream. After the call, `state` equals the snapshot
+     *          the game would expose before processing the next buffer.
+     * @param state The RC4 state to use and advance.
+     * @param data Pointer to the data to process in place.
+     * @param length Number of bytes to process.
+     */
+    void rc4_process_stream(
+        kx::GameStructs::RC4State& state,
+        std::uint8_t* data,
+        std::size_t length
+    );
+
+    /**
+     * @brief Advances the state by `length` keystream bytes without producing output.
+     * @details Equivalent to rc4_process_stream over a discarded buffer; used to rebuild
+     *          a later snapshot from an earlier one.
+     */
+    void rc4_skip(
+        kx::GameStructs::RC4State& state,
+        std::size_t length
+    );
 
 } // namespace kx::Crypto
\ No newline at end of file
@@ -1,7 +1,13 @@
 #include "D3DRenderHook.h"
 #include "HookManager.h"      // To create/remove the hook
 #include "ImGuiManager.h"     // To initialize and render ImGui
-#include "AppState.h"         // For UI visibility state (g_showInspectorWindow, g_isShuttingDown)
+#include "AppState.h"         // For UI visibility state (g_showInspectorWindow)
+#include "CaptureControl.h"   // For the shutting-down bit
+#include "ControlLoop.h"      // To request unload from the hotkey handler
+#include "HookQuiescence.h"   // For the in-flight guard waited on at unload
+#include "PacketStaging.h"    // To publish staged packets once per frame
+#include "UiBenchmark.h"      // To run a queued headless UI benchmark between frames
+#include "UiRefresh.h"        // For the capped UI rebuild rate
 #include <iostream>           // Replace with logging
 
 // Include ImGui backend headers for WndProc handler
@@ -50,11 +56,7 @@ namespace kx::Hooking {
 
     void D3DRenderHook::Shutdown() {
         // Restore original WndProc FIRST
-        if (m_hWindow && m_pOriginalWndProc) {
-            SetWindowLongPtr(m_hWindow, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(m_pOriginalWndProc));
-            m_pOriginalWndProc = nullptr;
-            std::cout << "[D3DRenderHook] Restored original WndProc." << std::endl;
-        }
+        RestoreWndProc();
 
         // Shutdown ImGui
         if (m_isInit) {
@@ -77,6 +79,14 @@ namespace kx::Hooking {
         kx::g_presentHookStatus = kx::HookStatus::Unknown; // Reset status
     }
 
+    void D3DRenderHook::RestoreWndProc() {
+        if (m_hWindow && m_pOriginalWndProc) {
+            SetWindowLongPtr(m_hWindow, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(m_pOriginalWndProc));
+            m_pOriginalWndProc = nullptr;
+            std::cout << "[D3DRenderHook] Restored original WndProc." << std::endl;
+        }
+    }
+
     bool D3DRenderHook::IsInitialized() {
         return m_isInit;
     }
@@ -141,7 +151,10 @@ namespace kx::Hooking {
 
 
     HRESULT __stdcall D3DRenderHook::DetourPresent(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags) {
-        if (g_isShuttingDown) { // Use AppState flag
+        // Counted until the detour returns, so unload can wait for it (see HookQuiescence.h).
+        Quiescence::InFlightScope inFlight(Quiescence::g_hookTracker);
+
+        if (Capture::g_captureControl.IsSet(Capture::CONTROL_SHUTTING_DOWN)) {
             // Ensure original is valid before calling
             return m_pOriginalPresent ? m_pOriginalPresent(pSwapChain, SyncInterval, Flags) : E_FAIL;
         }
@@ -209,14 +222,29 @@ namespace kx::Hooking {
         bool currentToggleKeyState = (GetAsyncKeyState(VK_INSERT) & 0x8000) != 0;
         if (currentToggleKeyState && !lastToggleKeyState) {
             g_showInspectorWindow = !g_showInspectorWindow; // Use AppState flag
+            UiRefresh::RequestRebuild(); // The cached frame is stale after the overlay was hidden
         }
         lastToggleKeyState = currentToggleKeyState;
 
+        // Unload hotkey (DELETE): wakes the main thread's control loop
+        if (GetAsyncKeyState(VK_DELETE) & 0x8000) {
+            Control::RequestShutdown();
+        }
+
+        // Publish the packets staged by the capture threads since the last frame
+        Staging::FlushAll();
+
         // Render ImGui overlay if initialized and visible
         if (m_isInit && g_showInspectorWindow) { // Use AppState flag
-            ImGuiManager::NewFrame();
-            ImGuiManager::RenderUI(); // Renders the specific UI windows
-            ImGuiManager::Render(m_pContext, m_pMainRenderTargetView); // Renders ImGui draw data
+            Benchmark::RunPendingUiBenchmark(); // Uses its own ImGui context, so only outside a frame
+            if (UiRefresh::BeginFrame()) {
+                ImGuiManager::NewFrame();
+                ImGuiManager::RenderUI(); // Renders the specific UI windows
+                ImGuiManager::Render(m_pContext, m_pMainRenderTargetView); // Renders ImGui draw data
+            }
+            else {
+                ImGuiManager::RenderCachedFrame(m_pContext, m_pMainRenderTargetView); // Replays the last built frame
+            }
         }
 
         // Call original Present function - ensure it's valid
@@ -233,6 +261,7 @@ namespace kx::Hooking {
             ImGui_ImplWin32_WndProcHandler(hWnd, uMsg, wParam, lParam);
 
             ImGuiIO& io = ImGui::GetIO();
+            UiRefresh::NotifyInput(uMsg, io.WantCaptureMouse);
 
             // If ImGui wants keyboard or mouse input, block it from reaching the game.
             if (io.WantCaptureKeyboard || io.WantCaptureMouse) {
@@ -32,6 +32,12 @@ namespace kx::Hooking {
          */
         static void Shutdown();
 
+        /**
+         * @brief Restores the original WndProc only, leaving ImGui and the D3D resources
+         *        alive (for shutdown while a frame may still be rendering).
+         */
+        static void RestoreWndProc();
+
         /**
          * @brief Checks if the hook and ImGui integration have been initialized.
          * @return True if initialized, false otherwise.
@@ -0,0 +1,895 @@
+#include "FilterExpression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace kx::Filtering {
+
+    namespace {
+
+        // --- Lexer ---
+
+        enum class TokenKind {
+            End,
+            Identifier,
+            Number,
+            String,
+            AndAnd,
+            OrOr,
+            Not,
+            Equal,
+            NotEqual,
+            Less,
+            LessEqual,
+            Greater,
+            GreaterEqual,
+            LParen,
+            RParen,
+            LBrace,
+            RBrace,
+            Comma,
+            At
+        };
+
+        struct Token {
+            TokenKind kind = TokenKind::End;
+            std::string text;        // Identifier name or string contents
+            std::int64_t number = 0;
+            char quote = 0;          // '"' or '\'' for strings
+            bool wide = false;       // u'...' string
+            std::size_t column = 0;  // 1-based
+        };
+
+        class ParseError : public std::runtime_error {
+        public:
+            ParseError(std::size_t column, const std::string& message)
+                : std::runtime_error("Column " + std::to_string(column) + ": " + message) {
+            }
+        };
+
+        std::vector<Token> Tokenize(const std::string& text) {
+            std::vector<Token> tokens;
+            std::size_t i = 0;
+            while (i < text.size()) {
+                const char c = text[i];
+                if (std::isspace(static_cast<unsigned char>(c))) {
+                    ++i;
+                    continue;
+                }
+
+                Token token;
+                token.column = i + 1;
+                auto two = [&](char next) { return i + 1 < text.size() && text[i + 1] == next; };
+
+                if (c == 'u' && i + 1 < text.size() && text[i + 1] == '\'') {
+                    token.wide = true;
+                    ++i;
+                }
+                const char quote = text[i];
+                if (quote == '"' || quote == '\'') {
+                    std::size_t close = text.find(quote, i + 1);
+                    if (close == std::string::npos) {
+                        throw ParseError(token.column, "Unterminated string.");
+                    }
+                    token.kind = TokenKind::String;
+                    token.quote = quote;
+                    token.text = text.substr(i + 1, close - i - 1);
+                    i = close + 1;
+                }
+                else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                    std::size_t start = i;
+                    while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) ++i;
+                    token.kind = TokenKind::Identifier;
+                    token.text = text.substr(start, i - start);
+                }
+                else if (std::isdigit(static_cast<unsigned char>(c)) || (c == '-' && i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1])))) {
+                    std::size_t start = i;
+                    if (c == '-') ++i;
+                    while (i < text.size() && std::isalnum(static_cast<unsigned char>(text[i]))) ++i;
+                    std::string literal = text.substr(start, i - start);
+                    try {
+                        std::size_t consumed = 0;
+                        token.number = std::stoll(literal, &consumed, 0);
+                        if (consumed != literal.size()) throw std::invalid_argument(literal);
+                    }
+                    catch (const std::exception&) {
+                        throw ParseError(token.column, "Invalid number '" + literal + "'.");
+                    }
+                    token.kind = TokenKind::Number;
+                }
+                else {
+                    switch (c) {
+                        case '&': if (!two('&')) throw ParseError(token.column, "Expected '&&'."); token.kind = TokenKind::AndAnd; i += 2; break;
+                        case '|': if (!two('|')) throw ParseError(token.column, "Expected '||'."); token.kind = TokenKind::OrOr; i += 2; break;
+                        case '=': if (!two('=')) throw ParseError(token.column, "Expected '=='."); token.kind = TokenKind::Equal; i += 2; break;
+                        case '!': if (two('=')) { token.kind = TokenKind::NotEqual; i += 2; } else { token.kind = TokenKind::Not; ++i; } break;
+                        case '<': if (two('=')) { token.kind = TokenKind::LessEqual; i += 2; } else { token.kind = TokenKind::Less; ++i; } break;
+                        case '>': if (two('=')) { token.kind = TokenKind::GreaterEqual; i += 2; } else { token.kind = TokenKind::Greater; ++i; } break;
+                        case '(': token.kind = TokenKind::LParen; ++i; break;
+                        case ')': token.kind = TokenKind::RParen; ++i; break;
+                        case '{': token.kind = TokenKind::LBrace; ++i; break;
+                        case '}': token.kind = TokenKind::RBrace; ++i; break;
+                        case ',': token.kind = TokenKind::Comma; ++i; break;
+                        case '@': token.kind = TokenKind::At; ++i; break;
+                        default: throw ParseError(token.column, std::string("Unexpected character '") + c + "'.");
+                    }
+                }
+                tokens.push_back(std::move(token));
+            }
+
+            Token end;
+            end.column = text.size() + 1;
+            tokens.push_back(end);
+            return tokens;
+        }
+
+        bool EqualsIgnoreCase(const std::string& a, const char* b) {
+            std::size_t n = 0;
+            for (; b[n] != '\0'; ++n) {
+                if (n >= a.size() || std::tolower(static_cast<unsigned char>(a[n])) != std::tolower(static_cast<unsigned char>(b[n]))) return false;
+            }
+            return n == a.size();
+        }
+
+        // --- AST ---
+
+        enum class NodeKind {
+            Const,
+            Compare,
+            InSet,
+            Contains,
+            Not,
+            And,
+            Or
+        };
+
+        struct Node {
+            NodeKind kind = NodeKind::Const;
+            bool constant = false;
+            FilterField field = FilterField::Direction;
+            std::uint16_t offset = 0;
+            CompareOp compare = CompareOp::Equal;
+            std::int64_t value = 0;
+            std::vector<std::int64_t> set;
+            Search::SearchPattern pattern;
+            std::vector<std::unique_ptr<Node>> children;
+        };
+
+        std::unique_ptr<Node> MakeConst(bool value) {
+            auto node = std::make_unique<Node>();
+            node->kind = NodeKind::Const;
+            node->constant = value;
+            return node;
+        }
+
+        bool ApplyCompare(std::int64_t lhs, CompareOp op, std::int64_t rhs) {
+            switch (op) {
+                case CompareOp::Equal:        return lhs == rhs;
+                case CompareOp::NotEqual:     return lhs != rhs;
+                case CompareOp::Less:         return lhs < rhs;
+                case CompareOp::LessEqual:    return lhs <= rhs;
+                case CompareOp::Greater:      return lhs > rhs;
+                case CompareOp::GreaterEqual: return lhs >= rhs;
+            }
+            return false;
+        }
+
+        // `5 < x` is rewritten as `x > 5`.
+        CompareOp Mirror(CompareOp op) {
+            switch (op) {
+                case CompareOp::Less:         return CompareOp::Greater;
+                case CompareOp::LessEqual:    return CompareOp::GreaterEqual;
+                case CompareOp::Greater:      return CompareOp::Less;
+                case CompareOp::GreaterEqual: return CompareOp::LessEqual;
+                default:                      return op;
+            }
+        }
+
+        // Value range of a field. Payload fields may also be absent (then comparisons are false).
+        void FieldDomain(FilterField field, std::int64_t& low, std::int64_t& high) {
+            switch (field) {
+                case FilterField::Direction: low = 0; high = 1; break;
+                case FilterField::Header:
+                case FilterField::U8:        low = 0; high = 0xFF; break;
+                case FilterField::U16:       low = 0; high = 0xFFFF; break;
+                case FilterField::U32:       low = 0; high = 0xFFFFFFFFll; break;
+                case FilterField::Length:    low = 0; high = std::numeric_limits<int>::max(); break;
+                case FilterField::BufferState:
+                default:                     low = std::numeric_limits<int>::min(); high = std::numeric_limits<int>::max(); break;
+            }
+        }
+
+        bool IsPayloadField(FilterField field) {
+            return field == FilterField::U8 || field == FilterField::U16 || field == FilterField::U32;
+        }
+
+        // --- Parser ---
+
+        struct Operand {
+            bool isField = false;
+            bool isBytes = false;
+            FilterField field = FilterField::Direction;
+            std::uint16_t offset = 0;
+            std::int64_t value = 0;
+            std::size_t column = 0;
+        };
+
+        class Parser {
+        public:
+            explicit Parser(std::vector<Token> tokens) : m_tokens(std::move(tokens)) {}
+
+            std::unique_ptr<Node> Parse() {
+                auto node = ParseOr();
+                if (Peek().kind != TokenKind::End) {
+                    throw ParseError(Peek().column, "Unexpected trailing input.");
+                }
+                return node;
+            }
+
+        private:
+            const Token& Peek() const { return m_tokens[m_position]; }
+            const Token& Advance() { return m_tokens[m_position < m_tokens.size() - 1 ? m_position++ : m_position]; }
+
+            bool Accept(TokenKind kind) {
+                if (Peek().kind != kind) return false;
+                Advance();
+                return true;
+            }
+
+            const Token& Expect(TokenKind kind, const char* what) {
+                if (Peek().kind != kind) {
+                    throw ParseError(Peek().column, std::string("Expected ") + what + ".");
+                }
+                return Advance();
+            }
+
+            bool AcceptKeyword(const char* keyword) {
+                if (Peek().kind == TokenKind::Identifier && EqualsIgnoreCase(Peek().text, keyword)) {
+                    Advance();
+                    return true;
+                }
+                return false;
+            }
+
+            std::unique_ptr<Node> ParseChain(NodeKind kind, TokenKind separator, std::unique_ptr<Node>(Parser::* parseOperand)()) {
+                auto first = (this->*parseOperand)();
+                if (Peek().kind != separator) {
+                    return first;
+                }
+                auto chain = std::make_unique<Node>();
+                chain->kind = kind;
+                chain->children.push_back(std::move(first));
+                while (Accept(separator)) {
+                    chain->children.push_back((this->*parseOperand)());
+                }
+                return chain;
+            }
+
+            std::unique_ptr<Node> ParseOr() { return ParseChain(NodeKind::Or, TokenKind::OrOr, &Parser::ParseAnd); }
+            std::unique_ptr<Node> ParseAnd() { return ParseChain(NodeKind::And, TokenKind::AndAnd, &Parser::ParseUnary); }
+
+            std::unique_ptr<Node> ParseUnary() {
+                if (Accept(TokenKind::Not)) {
+                    auto node = std::make_unique<Node>();
+                    node->kind = NodeKind::Not;
+                    node->children.push_back(ParseUnary());
+                    return node;
+                }
+                return ParsePrimary();
+            }
+
+            std::unique_ptr<Node> ParsePrimary() {
+                if (Accept(TokenKind::LParen)) {
+                    auto node = ParseOr();
+                    Expect(TokenKind::RParen, "')'");
+                    return node;
+                }
+                if (AcceptKeyword("true")) return MakeConst(true);
+                if (AcceptKeyword("false")) return MakeConst(false);
+
+                Operand lhs = ParseOperand();
+
+                if (lhs.isBytes) {
+                    if (!AcceptKeyword("contains")) {
+                        throw ParseError(Peek().column, "Expected 'contains' after 'bytes'.");
+                    }
+                    return ParseContains();
+                }
+
+                if (AcceptKeyword("in")) {
+                    return ParseInSet(lhs);
+                }
+
+                CompareOp op;
+                switch (Peek().kind) {
+                    case TokenKind::Equal:        op = CompareOp::Equal; break;
+                    case TokenKind::NotEqual:     op = CompareOp::NotEqual; break;
+                    case TokenKind::Less:         op = CompareOp::Less; break;
+                    case TokenKind::LessEqual:    op = CompareOp::LessEqual; break;
+                    case TokenKind::Greater:      op = CompareOp::Greater; break;
+                    case TokenKind::GreaterEqual: op = CompareOp::GreaterEqual; break;
+                    default: throw ParseError(Peek().column, "Expected a comparison operator, 'in' or 'contains'.");
+                }
+                Advance();
+
+                Operand rhs = ParseOperand();
+                if (rhs.isBytes) {
+                    throw ParseError(rhs.column, "'bytes' can only be used with 'contains'.");
+                }
+                if (lhs.isField && rhs.isField) {
+                    throw ParseError(rhs.column, "Comparisons need a constant on one side.");
+                }
+                if (!lhs.isField && !rhs.isField) {
+                    return MakeConst(ApplyCompare(lhs.value, op, rhs.value));
+                }
+                if (!lhs.isField) {
+                    std::swap(lhs, rhs);
+                    op = Mirror(op);
+                }
+
+                auto node = std::make_unique<Node>();
+                node->kind = NodeKind::Compare;
+                node->field = lhs.field;
+                node->offset = lhs.offset;
+                node->compare = op;
+                node->value = rhs.value;
+                return node;
+            }
+
+            Operand ParseOperand() {
+                Operand operand;
+                operand.column = Peek().column;
+
+                if (Peek().kind == TokenKind::Number) {
+                    operand.value = Advance().number;
+                    return operand;
+                }
+                if (Peek().kind != TokenKind::Identifier) {
+                    throw ParseError(operand.column, "Expected a field or a constant.");
+                }
+
+                const std::string name = Advance().text;
+                operand.isField = true;
+                if (EqualsIgnoreCase(name, "dir"))        operand.field = FilterField::Direction;
+                else if (EqualsIgnoreCase(name, "hdr"))   operand.field = FilterField::Header;
+                else if (EqualsIgnoreCase(name, "len"))   operand.field = FilterField::Length;
+                else if (EqualsIgnoreCase(name, "state")) operand.field = FilterField::BufferState;
+                else if (EqualsIgnoreCase(name, "bytes")) operand.isBytes = true;
+                else if (EqualsIgnoreCase(name, "u8") || EqualsIgnoreCase(name, "u16") || EqualsIgnoreCase(name, "u32")) {
+                    operand.field = EqualsIgnoreCase(name, "u8") ? FilterField::U8 : EqualsIgnoreCase(name, "u16") ? FilterField::U16 : FilterField::U32;
+                    Expect(TokenKind::At, "'@' and a byte offset");
+                    const Token& offset = Expect(TokenKind::Number, "a byte offset");
+                    if (offset.number < 0 || offset.number > 0xFFFF) {
+                        throw ParseError(offset.column, "Offset out of range.");
+                    }
+                    operand.offset = static_cast<std::uint16_t>(offset.number);
+                }
+                else {
+                    // Named constants for the direction field.
+                    operand.isField = false;
+                    if (EqualsIgnoreCase(name, "S") || EqualsIgnoreCase(name, "Sent"))                                            operand.value = 0;
+                    else if (EqualsIgnoreCase(name, "R") || EqualsIgnoreCase(name, "Recv") || EqualsIgnoreCase(name, "Received")) operand.value = 1;
+                    else throw ParseError(operand.column, "Unknown identifier '" + name + "'.");
+                }
+                return operand;
+            }
+
+            std::unique_ptr<Node> ParseInSet(const Operand& lhs) {
+                if (lhs.isBytes) {
+                    throw ParseError(lhs.column, "'bytes' can only be used with 'contains'.");
+                }
+                Expect(TokenKind::LBrace, "'{'");
+                std::vector<std::int64_t> values;
+                if (Peek().kind != TokenKind::RBrace) {
+                    do {
+                        Operand element = ParseOperand();
+                        if (element.isField) {
+                            throw ParseError(element.column, "Set elements must be constants.");
+                        }
+                        values.push_back(element.value);
+                    } while (Accept(TokenKind::Comma));
+                }
+                Expect(TokenKind::RBrace, "'}'");
+
+                if (!lhs.isField) {
+                    return MakeConst(std::find(values.begin(), values.end(), lhs.value) != values.end());
+                }
+                auto node = std::make_unique<Node>();
+                node->kind = NodeKind::InSet;
+                node->field = lhs.field;
+                node->offset = lhs.offset;
+                node->set = std::move(values);
+                return node;
+            }
+
+            std::unique_ptr<Node> ParseContains() {
+                const Token& literal = Expect(TokenKind::String, "a quoted pattern");
+                // "..." holds an IDA byte pattern; '...' and u'...' hold text.
+                std::string patternText = literal.quote == '"' ? literal.text
+                    : (literal.wide ? "u\"" : "\"") + literal.text + "\"";
+                auto node = std::make_unique<Node>();
+                node->kind = NodeKind::Contains;
+                std::string error;
+                if (!Search::ParseSearchPattern(patternText, node->pattern, error)) {
+                    throw ParseError(literal.column, error);
+                }
+                return node;
+            }
+
+            std::vector<Token> m_tokens;
+            std::size_t m_position = 0;
+        };
+
+        // --- Constant folding ---
+
+        std::unique_ptr<Node> Fold(std::unique_ptr<Node> node) {
+            switch (node->kind) {
+                case NodeKind::Not: {
+                    auto child = Fold(std::move(node->children[0]));
+                    if (child->kind == NodeKind::Const) return MakeConst(!child->constant);
+                    if (child->kind == NodeKind::Not) return std::move(child->children[0]);
+                    node->children[0] = std::move(child);
+                    return node;
+                }
+
+                case NodeKind::And:
+                case NodeKind::Or: {
+                    // Identity element is true for && and false for ||; the other value absorbs.
+                    const bool identity = node->kind == NodeKind::And;
+                    std::vector<std::unique_ptr<Node>> kept;
+                    for (auto& child : node->children) {
+                        auto folded = Fold(std::move(child));
+                        if (folded->kind == NodeKind::Const) {
+                            if (folded->constant != identity) return MakeConst(!identity);
+                            continue;
+                        }
+                        if (folded->kind == node->kind) {
+                            for (auto& grandchild : folded->children) kept.push_back(std::move(grandchild));
+                        }
+                        else {
+                            kept.push_back(std::move(folded));
+                        }
+                    }
+                    if (kept.empty()) return MakeConst(identity);
+                    if (kept.size() == 1) return std::move(kept[0]);
+                    node->children = std::move(kept);
+                    return node;
+                }
+
+                case NodeKind::InSet: {
+                    std::int64_t low, high;
+                    FieldDomain(node->field, low, high);
+                    auto& set = node->set;
+                    set.erase(std::remove_if(set.begin(), set.end(), [&](std::int64_t v) { return v < low || v > high; }), set.end());
+                    std::sort(set.begin(), set.end());
+                    set.erase(std::unique(set.begin(), set.end()), set.end());
+                    if (set.empty()) return MakeConst(false);
+                    if (set.size() == 1) {
+                        node->kind = NodeKind::Compare;
+                        node->compare = CompareOp::Equal;
+                        node->value = set[0];
+                    }
+                    return node;
+                }
+
+                case NodeKind::Compare: {
+                    // Fold comparisons that are decided by the field's value range alone.
+                    std::int64_t low, high;
+                    FieldDomain(node->field, low, high);
+                    const std::int64_t v = node->value;
+                    bool alwaysTrue = false, alwaysFalse = false;
+                    switch (node->compare) {
+                        case CompareOp::Equal:        alwaysFalse = v < low || v > high; break;
+                        case CompareOp::NotEqual:     alwaysTrue = v < low || v > high; break;
+                        case CompareOp::Less:         alwaysTrue = v > high; alwaysFalse = v <= low; break;
+                        case CompareOp::LessEqual:    alwaysTrue = v >= high; alwaysFalse = v < low; break;
+                        case CompareOp::Greater:      alwaysTrue = v < low; alwaysFalse = v >= high; break;
+                        case CompareOp::GreaterEqual: alwaysTrue = v <= low; alwaysFalse = v > high; break;
+                    }
+                    if (alwaysFalse) return MakeConst(false);
+                    if (alwaysTrue && !IsPayloadField(node->field)) return MakeConst(true);
+                    return node;
+                }
+
+                default:
+                    return node;
+            }
+        }
+
+        // --- Cost / selectivity ordering ---
+
+        struct Estimate {
+            double cost = 0.0;        // Rough relative evaluation cost
+            double selectivity = 1.0; // Estimated probability of evaluating to true
+        };
+
+        double EqualitySelectivity(FilterField field) {
+            switch (field) {
+                case FilterField::Direction:   return 0.5;
+                case FilterField::Header:      return 1.0 / 32.0;
+                case FilterField::Length:      return 0.02;
+                case FilterField::BufferState: return 0.3;
+                default:                       return 1.0 / 256.0;
+            }
+        }
+
+        Estimate EstimateNode(const Node& node) {
+            switch (node.kind) {
+                case NodeKind::Const:
+                    return { 0.0, node.constant ? 1.0 : 0.0 };
+
+                case NodeKind::Compare: {
+                    double cost = IsPayloadField(node.field) ? 2.0 : 1.0;
+                    double eq = EqualitySelectivity(node.field);
+                    switch (node.compare) {
+                        case CompareOp::Equal:    return { cost, eq };
+                        case CompareOp::NotEqual: return { cost, 1.0 - eq };
+                        default: {
+                            if (node.field == FilterField::Header || node.field == FilterField::U8) {
+                                double below = std::clamp(static_cast<double>(node.value) / 256.0, 0.0, 1.0);
+                                bool lessThan = node.compare == CompareOp::Less || node.compare == CompareOp::LessEqual;
+                                return { cost, lessThan ? below : 1.0 - below };
+                            }
+                            return { cost, 0.5 };
+                        }
+                    }
+                }
+
+                case NodeKind::InSet: {
+                    double cost = IsPayloadField(node.field) ? 2.5 : 1.5;
+                    return { cost, std::min(1.0, EqualitySelectivity(node.field) * static_cast<double>(node.set.size())) };
+                }
+
+                case NodeKind::Contains:
+                    return { 10.0 + static_cast<double>(node.pattern.bytes.size()), 0.05 };
+
+                case NodeKind::Not: {
+                    Estimate child = EstimateNode(*node.children[0]);
+                    return { child.cost + 0.1, 1.0 - child.selectivity };
+                }
+
+                case NodeKind::And:
+                case NodeKind::Or: {
+                    // Children are already in evaluation order.
+                    Estimate total{ 0.0, 1.0 };
+                    double reach = 1.0;
+                    double none = 1.0;
+                    for (const auto& child : node.children) {
+                        Estimate e = EstimateNode(*child);
+                        total.cost += reach * e.cost;
+                        if (node.kind == NodeKind::And) {
+                            reach *= e.selectivity;
+                        }
+                        else {
+                            reach *= 1.0 - e.selectivity;
+                            none *= 1.0 - e.selectivity;
+                        }
+                    }
+                    total.selectivity = node.kind == NodeKind::And ? reach : 1.0 - none;
+                    return total;
+                }
+            }
+            return {};
+        }
+
+        // Orders each && chain by cost / P(false) and each || chain by cost / P(true), the
+        // optimal order for independent side-effect-free predicates.
+        void OrderBySelectivity(Node& node) {
+            for (auto& child : node.children) {
+                OrderBySelectivity(*child);
+            }
+            if (node.kind != NodeKind::And && node.kind != NodeKind::Or) {
+                return;
+            }
+
+            const bool isAnd = node.kind == NodeKind::And;
+            std::vector<std::pair<double, std::unique_ptr<Node>>> ranked;
+            for (auto& child : node.children) {
+                Estimate e = EstimateNode(*child);
+                double decisive = isAnd ? 1.0 - e.selectivity : e.selectivity;
+                double rank = decisive > 0.0 ? e.cost / decisive : std::numeric_limits<double>::infinity();
+                ranked.emplace_back(rank, std::move(child));
+            }
+            std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (std::size_t k = 0; k < ranked.size(); ++k) {
+                node.children[k] = std::move(ranked[k].second);
+            }
+        }
+
+        // --- Field access ---
+
+        // Payload fields read the displayed (decrypted where available) data; it is only
+        // touched for those fields since it lives on a different cache line than the header.
+        bool LoadField(const PacketInfo& packet, FilterField field, std::uint16_t offset, std::int64_t& value) {
+            if (IsPayloadField(field)) {
+                if (packet.IsDecryptionDeferred()) return false; // Still ciphertext
+                const PacketPayload& payload = packet.GetDisplayData();
+                switch (field) {
+                    case FilterField::U8:
+                        if (static_cast<std::size_t>(offset) + 1 > payload.size()) return false;
+                        value = payload[offset];
+                        return true;
+                    case FilterField::U16:
+                        if (static_cast<std::size_t>(offset) + 2 > payload.size()) return false;
+                        value = payload[offset] | (payload[offset + 1] << 8);
+                        return true;
+                    default:
+                        if (static_cast<std::size_t>(offset) + 4 > payload.size()) return false;
+                        value = static_cast<std::int64_t>(static_cast<std::uint32_t>(payload[offset])
+                            | (static_cast<std::uint32_t>(payload[offset + 1]) << 8)
+                            | (static_cast<std::uint32_t>(payload[offset + 2]) << 16)
+                            | (static_cast<std::uint32_t>(payload[offset + 3]) << 24));
+                        return true;
+                }
+            }
+
+            switch (field) {
+                case FilterField::Direction:   value = packet.direction == PacketDirection::Sent ? 0 : 1; return true;
+                case FilterField::Header:      value = packet.rawHeaderId; return true;
+                case FilterField::Length:      value = packet.size; return true;
+                case FilterField::BufferState: value = packet.bufferState; return true;
+                default:                       return false;
+            }
+        }
+
+        const char* FieldName(FilterField field) {
+            switch (field) {
+                case FilterField::Direction:   return "dir";
+                case FilterField::Header:      return "hdr";
+                case FilterField::Length:      return "len";
+                case FilterField::BufferState: return "state";
+                case FilterField::U8:          return "u8";
+                case FilterField::U16:         return "u16";
+                case FilterField::U32:         return "u32";
+            }
+            return "?";
+        }
+
+        const char* CompareName(CompareOp op) {
+            switch (op) {
+                case CompareOp::Equal:        return "==";
+                case CompareOp::NotEqual:     return "!=";
+                case CompareOp::Less:         return "<";
+                case CompareOp::LessEqual:    return "<=";
+                case CompareOp::Greater:      return ">";
+                case CompareOp::GreaterEqual: return ">=";
+            }
+            return "?";
+        }
+
+        std::mutex s_activeFilterMutex;
+        std::shared_ptr<const CompiledFilter> s_activeFilter;
+
+    } // anonymous namespace
+
+
+    // --- FilterValueSet ---
+
+    bool FilterValueSet::Contains(std::int64_t value) const {
+        if (value >= 0 && value < 256) {
+            return (bits[value >> 6] >> (value & 63)) & 1u;
+        }
+        return std::binary_search(overflow.begin(), overflow.end(), value);
+    }
+
+
+    // --- CompiledFilter ---
+
+    bool CompiledFilter::Evaluate(const PacketInfo& packet) const {
+        const std::size_t count = m_code.size();
+        bool acc = true;
+        std::int64_t value = 0;
+
+        for (std::size_t pc = 0; pc < count;) {
+            const FilterInstruction& ins = m_code[pc++];
+            switch (ins.op) {
+                case FilterOpCode::LoadConst:
+                    acc = ins.value != 0;
+                    break;
+                case FilterOpCode::Compare:
+                    acc = LoadField(packet, ins.field, ins.offset, value) && ApplyCompare(value, ins.compare, ins.value);
+                    break;
+                case FilterOpCode::InSet:
+                    acc = LoadField(packet, ins.field, ins.offset, value) && m_sets[ins.operand].Contains(value);
+                    break;
+                case FilterOpCode::Contains: {
+                    if (packet.IsDecryptionDeferred()) {
+                        acc = false;
+                        break;
+                    }
+                    const PacketPayload& payload = packet.GetDisplayData();
+                    acc = Search::FindFirst(payload.data(), payload.size(), m_patterns[ins.operand]) != Search::NOT_FOUND;
+                    break;
+                }
+                case FilterOpCode::Not:
+                    acc = !acc;
+                    break;
+                case FilterOpCode::JumpIfFalse:
+                    if (!acc) pc = ins.operand;
+                    break;
+                case FilterOpCode::JumpIfTrue:
+                    if (acc) pc = ins.operand;
+                    break;
+            }
+        }
+        return acc;
+    }
+
+    bool CompiledFilter::ReadsPayload() const {
+        for (const FilterInstruction& ins : m_code) {
+            if (ins.op == FilterOpCode::Contains) return true;
+            if ((ins.op == FilterOpCode::Compare || ins.op == FilterOpCode::InSet) && IsPayloadField(ins.field)) return true;
+        }
+        return false;
+    }
+
+    std::string CompiledFilter::Disassemble() const {
+        std::stringstream ss;
+        for (std::size_t pc = 0; pc < m_code.size(); ++pc) {
+            const FilterInstruction& ins = m_code[pc];
+            ss << std::setw(3) << std::setfill('0') << pc << std::setfill(' ') << "  ";
+
+            auto operandName = [&]() {
+                std::string name = FieldName(ins.field);
+                if (IsPayloadField(ins.field)) name += "@" + std::to_string(ins.offset);
+                return name;
+            };
+
+            switch (ins.op) {
+                case FilterOpCode::LoadConst:   ss << "CONST " << (ins.value != 0 ? "true" : "false"); break;
+                case FilterOpCode::Compare:     ss << "CMP   " << operandName() << " " << CompareName(ins.compare) << " " << ins.value; break;
+                case FilterOpCode::InSet:
+                    ss << "IN    " << operandName() << " set#" << ins.operand;
+                    break;
+                case FilterOpCode::Contains:    ss << "FIND  pattern#" << ins.operand << " (" << m_patterns[ins.operand].bytes.size() << " bytes)"; break;
+                case FilterOpCode::Not:         ss << "NOT"; break;
+                case FilterOpCode::JumpIfFalse: ss << "JF    " << ins.operand; break;
+                case FilterOpCode::JumpIfTrue:  ss << "JT    " << ins.operand; break;
+            }
+            ss << "\n";
+        }
+        return ss.str();
+    }
+
+
+    // --- Compilation ---
+
+    namespace {
+
+        class CodeGenerator {
+        public:
+            CodeGenerator(std::vector<FilterInstruction>& code, std::vector<FilterValueSet>& sets, std::vector<Search::SearchPattern>& patterns)
+                : m_code(code), m_sets(sets), m_patterns(patterns) {
+            }
+
+            void Emit(const Node& node) {
+                FilterInstruction ins;
+                switch (node.kind) {
+                    case NodeKind::Const:
+                        ins.op = FilterOpCode::LoadConst;
+                        ins.value = node.constant ? 1 : 0;
+                        m_code.push_back(ins);
+                        break;
+
+                    case NodeKind::Compare:
+                        ins.op = FilterOpCode::Compare;
+                        ins.field = node.field;
+                        ins.offset = node.offset;
+                        ins.compare = node.compare;
+                        ins.value = node.value;
+                        m_code.push_back(ins);
+                        break;
+
+                    case NodeKind::InSet: {
+                        FilterValueSet set;
+                        for (std::int64_t v : node.set) {
+                            if (v >= 0 && v < 256) set.bits[v >> 6] |= 1ull << (v & 63);
+                            else set.overflow.push_back(v); // Already sorted by Fold
+                        }
+                        ins.op = FilterOpCode::InSet;
+                        ins.field = node.field;
+                        ins.offset = node.offset;
+                        ins.operand = static_cast<std::uint32_t>(m_sets.size());
+                        m_sets.push_back(std::move(set));
+                        m_code.push_back(ins);
+                        break;
+                    }
+
+                    case NodeKind::Contains:
+                        ins.op = FilterOpCode::Contains;
+                        ins.operand = static_cast<std::uint32_t>(m_patterns.size());
+                        m_patterns.push_back(node.pattern);
+                        m_code.push_back(ins);
+                        break;
+
+                    case NodeKind::Not:
+                        Emit(*node.children[0]);
+                        ins.op = FilterOpCode::Not;
+                        m_code.push_back(ins);
+                        break;
+
+                    case NodeKind::And:
+                    case NodeKind::Or: {
+                        // Every operand but the last short-circuits to the end of the chain,
+                        // leaving the deciding value in the accumulator.
+                        std::vector<std::size_t> jumps;
+                        for (std::size_t k = 0; k < node.children.size(); ++k) {
+                            Emit(*node.children[k]);
+                            if (k + 1 < node.children.size()) {
+                                ins.op = node.kind == NodeKind::And ? FilterOpCode::JumpIfFalse : FilterOpCode::JumpIfTrue;
+                                jumps.push_back(m_code.size());
+                                m_code.push_back(ins);
+                            }
+                        }
+                        for (std::size_t jump : jumps) {
+                            m_code[jump].operand = static_cast<std::uint32_t>(m_code.size());
+                        }
+                        break;
+                    }
+                }
+            }
+
+            // A jump that lands on a jump of the same kind can go straight to its target;
+            // one that lands on the opposite kind can skip it.
+            void ThreadJumps() {
+                for (auto& ins : m_code) {
+                    if (ins.op != FilterOpCode::JumpIfFalse && ins.op != FilterOpCode::JumpIfTrue) continue;
+                    while (ins.operand < m_code.size()) {
+                        const FilterInstruction& target = m_code[ins.operand];
+                        if (target.op == ins.op) {
+                            ins.operand = target.operand;
+                        }
+                        else if (target.op == FilterOpCode::JumpIfFalse || target.op == FilterOpCode::JumpIfTrue) {
+                            ins.operand += 1;
+                        }
+                        else {
+                            break;
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::vector<FilterInstruction>& m_code;
+            std::vector<FilterValueSet>& m_sets;
+            std::vector<Search::SearchPattern>& m_patterns;
+        };
+
+    } // anonymous namespace
+
+    std::shared_ptr<const CompiledFilter> CompileFilterExpression(const std::string& text, std::string& error) {
+        error.clear();
+        try {
+            Parser parser(Tokenize(text));
+            std::unique_ptr<Node> root = Fold(parser.Parse());
+            OrderBySelectivity(*root);
+
+            auto filter = std::make_shared<CompiledFilter>();
+            filter->m_source = text;
+            CodeGenerator generator(filter->m_code, filter->m_sets, filter->m_patterns);
+            generator.Emit(*root);
+            generator.ThreadJumps();
+            return filter;
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<const CompiledFilter> GetActiveFilterExpression() {
+        std::lock_guard<std::mutex> lock(s_activeFilterMutex);
+        return s_activeFilter;
+    }
+
+    void SetActiveFilterExpression(std::shared_ptr<const CompiledFilter> filter) {
+        std::lock_guard<std::mutex> lock(s_activeFilterMutex);
+        s_activeFilter = std::move(filter);
+    }
+
+} // namespace kx::Filtering
@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file FilterExpression.h
+ * @brief Textual packet filter language compiled to a small bytecode program.
+ * @details Example: `dir==S && hdr in {0x12,0x0B} && len>20 && u32@4 == 0x1234 && bytes contains "41 ?? 42"`
+ *
+ *          Operands:  dir (S/R), hdr (raw header byte), len (original size), state (buffer state),
+ *                     u8@N / u16@N / u32@N (little-endian read at byte offset N of the displayed payload),
+ *                     bytes (only with `contains`).
+ *          Operators: == != < <= > >=, `in {a, b, ...}`, `contains "<IDA pattern>"` or
+ *                     `contains 'text'` / `contains u'text'` (ASCII / UTF-16LE), && || ! and parentheses.
+ *
+ *          Compilation parses into an AST, folds constants, reorders the operands of every
+ *          && / || chain by estimated cost and selectivity, and emits a linear program for a
+ *          single-accumulator VM with short-circuit jumps. Comparisons against payload bytes
+ *          that lie past the end of the packet, or of a packet whose decryption is still
+ *          deferred (see LazyDecryption.h), evaluate to false.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "PacketData.h"    // For PacketInfo
+#include "PayloadSearch.h" // For SearchPattern
+
+namespace kx::Filtering {
+
+    enum class FilterField : std::uint8_t {
+        Direction,
+        Header,
+        Length,
+        BufferState,
+        U8,
+        U16,
+        U32
+    };
+
+    enum class CompareOp : std::uint8_t {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual
+    };
+
+    enum class FilterOpCode : std::uint8_t {
+        LoadConst,   // acc = value != 0
+        Compare,     // acc = field <cmp> value
+        InSet,       // acc = field in sets[operand]
+        Contains,    // acc = payload contains patterns[operand]
+        Not,         // acc = !acc
+        JumpIfFalse, // if (!acc) pc = operand
+        JumpIfTrue   // if (acc) pc = operand
+    };
+
+    struct FilterInstruction {
+        FilterOpCode op = FilterOpCode::LoadConst;
+        FilterField field = FilterField::Direction;
+        CompareOp compare = CompareOp::Equal;
+        std::uint16_t offset = 0;   // Payload offset for U8/U16/U32
+        std::uint32_t operand = 0;  // Jump target, set index or pattern index
+        std::int64_t value = 0;
+    };
+
+    /**
+     * @brief Set of integers for `in {...}`: a 256-bit bitmap for byte values plus a sorted overflow list.
+     */
+    struct FilterValueSet {
+        std::uint64_t bits[4] = {};
+        std::vector<std::int64_t> overflow;
+
+        bool Contains(std::int64_t value) const;
+    };
+
+    /**
+     * @brief An immutable compiled filter. Safe to evaluate from several threads.
+     */
+    class CompiledFilter {
+    public:
+        bool Evaluate(const PacketInfo& packet) const;
+
+        std::size_t InstructionCount() const { return m_code.size(); }
+
+        // True if the program reads payload bytes (u8/u16/u32 or contains).
+        bool ReadsPayload() const;
+
+        // Human-readable listing of the program, one instruction per line.
+        std::string Disassemble() const;
+
+        const std::string& SourceText() const { return m_source; }
+
+    private:
+        friend std::shared_ptr<const CompiledFilter> CompileFilterExpression(const std::string& text, std::string& error);
+
+        std::string m_source;
+        std::vector<FilterInstruction> m_code;
+        std::vector<FilterValueSet> m_sets;
+        std::vector<Search::SearchPattern> m_patterns;
+    };
+
+    /**
+     * @brief Compiles a filter expression.
+     * @param error Receives a message with the column of the problem on failure.
+     * @return The compiled filter, or nullptr on error.
+     */
+    std::shared_ptr<const CompiledFilter> CompileFilterExpression(const std::string& text, std::string& error);
+
+    /**
+     * @brief The expression applied by ShouldDisplayPacket in addition to the checkbox filters.
+     * @details nullptr means no expression filter. Access is synchronized.
+     */
+    std::shared_ptr<const CompiledFilter> GetActiveFilterExpression();
+    void SetActiveFilterExpression(std::shared_ptr<const CompiledFilter> filter);
+
+} // namespace kx::Filtering
@@ -0,0 +1,253 @@
+#include "FilterKernel.h"
+#include "PacketData.h" // For InternalPacketType
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h> // For __cpuid, __cpuidex, _xgetbv, _BitScanForward64, __popcnt64
+#else
+#include <cpuid.h>
+#endif
+
+// MSVC accepts any intrinsic regardless of /arch; GCC and Clang need the target enabled per function.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define KX_TARGET_SSSE3
+#define KX_TARGET_AVX2
+#else
+#define KX_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define KX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace kx::Filtering {
+
+    namespace {
+
+        // Packet types whose visibility is decided by the header bitmap rather than specialBits.
+        static_assert(static_cast<int>(InternalPacketType::NORMAL) == 0 && static_cast<int>(InternalPacketType::UNKNOWN_HEADER) == 2,
+            "HEADER_TYPE_MASK assumes the InternalPacketType values");
+        static_assert(static_cast<int>(InternalPacketType::PROCESSING_ERROR) < 8, "specialBits holds one bit per type");
+        constexpr std::uint8_t HEADER_TYPE_MASK = (1u << 0) | (1u << 2);
+
+        bool ScalarSelect(std::uint8_t direction, std::uint8_t header, std::uint8_t type, const SelectionLut& lut) {
+            const std::uint8_t dir = direction & 1;
+            const std::uint8_t typeBit = static_cast<std::uint8_t>(1u << (type & 7));
+            if (typeBit & HEADER_TYPE_MASK) {
+                return (lut.headerBits[dir][header >> 3] >> (header & 7)) & 1;
+            }
+            return (lut.specialBits[dir] & typeBit) != 0;
+        }
+
+        void SelectScalarRange(const std::uint8_t* directions, const std::uint8_t* headers, const std::uint8_t* types,
+            std::size_t begin, std::size_t end, const SelectionLut& lut, std::uint64_t* bitmap)
+        {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (ScalarSelect(directions[i], headers[i], types[i], lut)) {
+                    bitmap[i >> 6] |= 1ull << (i & 63);
+                }
+            }
+        }
+
+        // Bit i of the result byte is set for index i & 7.
+        const std::uint8_t BIT_FOR_INDEX[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+
+        KX_TARGET_SSSE3
+        void SelectSsse3(const std::uint8_t* directions, const std::uint8_t* headers, const std::uint8_t* types,
+            std::size_t count, const SelectionLut& lut, std::uint64_t* bitmap)
+        {
+            const __m128i sentLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[0]));
+            const __m128i sentHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[0] + 16));
+            const __m128i recvLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[1]));
+            const __m128i recvHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[1] + 16));
+            const __m128i bitTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BIT_FOR_INDEX));
+            const __m128i specialSent = _mm_set1_epi8(static_cast<char>(lut.specialBits[0]));
+            const __m128i specialRecv = _mm_set1_epi8(static_cast<char>(lut.specialBits[1]));
+            const __m128i headerTypes = _mm_set1_epi8(static_cast<char>(HEADER_TYPE_MASK));
+            const __m128i low3 = _mm_set1_epi8(0x07);
+            const __m128i low4 = _mm_set1_epi8(0x0F);
+            const __m128i high = _mm_set1_epi8(static_cast<char>(0x80));
+            const __m128i one = _mm_set1_epi8(1);
+            const __m128i zero = _mm_setzero_si128();
+
+            const std::size_t blocks = count / 16;
+            for (std::size_t block = 0; block < blocks; ++block) {
+                const std::size_t i = block * 16;
+                __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(headers + i));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(directions + i));
+                __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(types + i));
+
+                // PSHUFB yields 0 for index bytes with bit 7 set, which picks the bitmap half.
+                __m128i byteIndex = _mm_and_si128(_mm_srli_epi16(h, 3), low4);
+                __m128i upperHalf = _mm_and_si128(h, high);
+                __m128i loIndex = _mm_or_si128(byteIndex, upperHalf);
+                __m128i hiIndex = _mm_or_si128(byteIndex, _mm_xor_si128(upperHalf, high));
+                __m128i sentByte = _mm_or_si128(_mm_shuffle_epi8(sentLo, loIndex), _mm_shuffle_epi8(sentHi, hiIndex));
+                __m128i recvByte = _mm_or_si128(_mm_shuffle_epi8(recvLo, loIndex), _mm_shuffle_epi8(recvHi, hiIndex));
+
+                __m128i isRecv = _mm_cmpeq_epi8(_mm_and_si128(d, one), one);
+                __m128i headerByte = _mm_or_si128(_mm_andnot_si128(isRecv, sentByte), _mm_and_si128(isRecv, recvByte));
+                __m128i headerBit = _mm_shuffle_epi8(bitTable, _mm_and_si128(h, low3));
+                __m128i headerPass = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(headerByte, headerBit), zero), _mm_set1_epi8(-1));
+
+                __m128i typeBit = _mm_shuffle_epi8(bitTable, _mm_and_si128(t, low3));
+                __m128i specialByte = _mm_or_si128(_mm_andnot_si128(isRecv, specialSent), _mm_and_si128(isRecv, specialRecv));
+                __m128i specialFail = _mm_cmpeq_epi8(_mm_and_si128(specialByte, typeBit), zero);
+                __m128i isHeaderType = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(typeBit, headerTypes), zero), _mm_set1_epi8(-1));
+
+                __m128i pass = _mm_or_si128(_mm_and_si128(isHeaderType, headerPass), _mm_andnot_si128(_mm_or_si128(isHeaderType, specialFail), _mm_set1_epi8(-1)));
+                std::uint64_t mask = static_cast<std::uint32_t>(_mm_movemask_epi8(pass)) & 0xFFFFu;
+                bitmap[i >> 6] |= mask << (i & 63);
+            }
+            SelectScalarRange(directions, headers, types, blocks * 16, count, lut, bitmap);
+        }
+
+        KX_TARGET_AVX2
+        void SelectAvx2(const std::uint8_t* directions, const std::uint8_t* headers, const std::uint8_t* types,
+            std::size_t count, const SelectionLut& lut, std::uint64_t* bitmap)
+        {
+            // VPSHUFB shuffles within each 128-bit lane, so every table is duplicated per lane.
+            const __m256i sentLo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[0])));
+            const __m256i sentHi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[0] + 16)));
+            const __m256i recvLo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[1])));
+            const __m256i recvHi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lut.headerBits[1] + 16)));
+            const __m256i bitTable = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(BIT_FOR_INDEX)));
+            const __m256i specialSent = _mm256_set1_epi8(static_cast<char>(lut.specialBits[0]));
+            const __m256i specialRecv = _mm256_set1_epi8(static_cast<char>(lut.specialBits[1]));
+            const __m256i headerTypes = _mm256_set1_epi8(static_cast<char>(HEADER_TYPE_MASK));
+            const __m256i low3 = _mm256_set1_epi8(0x07);
+            const __m256i low4 = _mm256_set1_epi8(0x0F);
+            const __m256i high = _mm256_set1_epi8(static_cast<char>(0x80));
+            const __m256i one = _mm256_set1_epi8(1);
+            const __m256i zero = _mm256_setzero_si256();
+
+            const std::size_t blocks = count / 32;
+            for (std::size_t block = 0; block < blocks; ++block) {
+                const std::size_t i = block * 32;
+                __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(headers + i));
+                __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(directions + i));
+                __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(types + i));
+
+                __m256i byteIndex = _mm256_and_si256(_mm256_srli_epi16(h, 3), low4);
+                __m256i upperHalf = _mm256_and_si256(h, high);
+                __m256i loIndex = _mm256_or_si256(byteIndex, upperHalf);
+                __m256i hiIndex = _mm256_or_si256(byteIndex, _mm256_xor_si256(upperHalf, high));
+                __m256i sentByte = _mm256_or_si256(_mm256_shuffle_epi8(sentLo, loIndex), _mm256_shuffle_epi8(sentHi, hiIndex));
+                __m256i recvByte = _mm256_or_si256(_mm256_shuffle_epi8(recvLo, loIndex), _mm256_shuffle_epi8(recvHi, hiIndex));
+
+                __m256i isRecv = _mm256_cmpeq_epi8(_mm256_and_si256(d, one), one);
+                __m256i headerByte = _mm256_blendv_epi8(sentByte, recvByte, isRecv);
+                __m256i headerBit = _mm256_shuffle_epi8(bitTable, _mm256_and_si256(h, low3));
+                __m256i headerFail = _mm256_cmpeq_epi8(_mm256_and_si256(headerByte, headerBit), zero);
+
+                __m256i typeBit = _mm256_shuffle_epi8(bitTable, _mm256_and_si256(t, low3));
+                __m256i specialByte = _mm256_blendv_epi8(specialSent, specialRecv, isRecv);
+                __m256i specialFail = _mm256_cmpeq_epi8(_mm256_and_si256(specialByte, typeBit), zero);
+                __m256i isSpecialType = _mm256_cmpeq_epi8(_mm256_and_si256(typeBit, headerTypes), zero);
+
+                __m256i fail = _mm256_blendv_epi8(headerFail, specialFail, isSpecialType);
+                std::uint64_t mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(fail)) & 0xFFFFFFFFull;
+                bitmap[i >> 6] |= mask << (i & 63);
+            }
+            SelectScalarRange(directions, headers, types, blocks * 32, count, lut, bitmap);
+        }
+
+        bool CpuSupports(FilterKernel kernel) {
+            int info[4] = {};
+#if defined(_MSC_VER)
+            __cpuid(info, 1);
+#else
+            __cpuid(1, info[0], info[1], info[2], info[3]);
+#endif
+            const bool ssse3 = (info[2] & (1 << 9)) != 0;
+            if (kernel == FilterKernel::SSSE3) return ssse3;
+            if (kernel != FilterKernel::AVX2) return true;
+
+            // AVX2 also needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2).
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx) return false;
+#if defined(_MSC_VER)
+            unsigned long long xcr0 = _xgetbv(0);
+            __cpuidex(info, 7, 0);
+#else
+            unsigned int eax = 0, edx = 0;
+            __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+            __cpuid_count(7, 0, info[0], info[1], info[2], info[3]);
+#endif
+            return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+        }
+
+        unsigned LowestSetBit64(std::uint64_t value) {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanForward64(&index, value);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+        }
+
+        std::size_t PopCount64(std::uint64_t value) {
+#if defined(_MSC_VER)
+            return static_cast<std::size_t>(__popcnt64(value));
+#else
+            return static_cast<std::size_t>(__builtin_popcountll(value));
+#endif
+        }
+
+    } // anonymous namespace
+
+
+    FilterKernel DetectFilterKernel() {
+        static const FilterKernel s_kernel = CpuSupports(FilterKernel::AVX2) ? FilterKernel::AVX2
+            : CpuSupports(FilterKernel::SSSE3) ? FilterKernel::SSSE3 : FilterKernel::Scalar;
+        return s_kernel;
+    }
+
+    const char* GetFilterKernelName(FilterKernel kernel) {
+        switch (kernel) {
+            case FilterKernel::AVX2:  return "AVX2";
+            case FilterKernel::SSSE3: return "SSSE3";
+            case FilterKernel::Scalar:
+            default:                  return "Scalar";
+        }
+    }
+
+    bool LutSelects(const SelectionLut& lut, std::uint8_t direction, std::uint8_t header, std::uint8_t type) {
+        return ScalarSelect(direction, header, type, lut);
+    }
+
+    void BuildSelectionBitmap(const std::uint8_t* directions, const std::uint8_t* headers, const std::uint8_t* types,
+        std::size_t count, const SelectionLut& lut, std::vector<std::uint64_t>& bitmap, FilterKernel kernel)
+    {
+        bitmap.assign((count + 63) / 64, 0);
+        if (count == 0) {
+            return;
+        }
+
+        switch (kernel) {
+            case FilterKernel::AVX2:  SelectAvx2(directions, headers, types, count, lut, bitmap.data()); break;
+            case FilterKernel::SSSE3: SelectSsse3(directions, headers, types, count, lut, bitmap.data()); break;
+            case FilterKernel::Scalar:
+            default:                  SelectScalarRange(directions, headers, types, 0, count, lut, bitmap.data()); break;
+        }
+    }
+
+    void CompactSelection(const std::vector<std::uint64_t>& bitmap, std::vector<int>& indices) {
+        std::size_t total = 0;
+        for (std::uint64_t word : bitmap) {
+            total += PopCount64(word);
+        }
+
+        indices.resize(total);
+        int* out = indices.data();
+        for (std::size_t w = 0; w < bitmap.size(); ++w) {
+            std::uint64_t word = bitmap[w];
+            const int base = static_cast<int>(w * 64);
+            while (word != 0) {
+                *out++ = base + static_cast<int>(LowestSetBit64(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+} // namespace kx::Filtering
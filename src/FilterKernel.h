@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+ * @file FilterKernel.h
+ * @brief Vectorized evaluation of the direction and header/type filters over metadata columns.
+ * @details The checkbox filters reduce to a 256-bit "header allowed" bitmap per direction
+ *          plus an 8-bit "special type allowed" mask per direction. The SIMD kernels look
+ *          up 16 (SSSE3) or 32 (AVX2) packets per step with PSHUFB: the header's bits 3..6
+ *          select a byte of the bitmap half chosen by bit 7, and bits 0..2 select the bit.
+ *          The result is a selection bitmap (one bit per packet) that CompactSelection
+ *          turns into an index list, sized up front with popcount. The fastest kernel
+ *          supported by the CPU is picked once via CPUID; the scalar kernel is the fallback.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kx::Filtering {
+
+    enum class FilterKernel {
+        Scalar,
+        SSSE3,
+        AVX2
+    };
+
+    /**
+     * @brief Bit-packed form of the direction and header/type filters.
+     */
+    struct SelectionLut {
+        std::uint8_t headerBits[2][32] = {}; // [direction] bit (h & 7) of byte (h >> 3): header h passes
+        std::uint8_t specialBits[2] = {};    // [direction] bit t: packets of InternalPacketType t pass
+    };
+
+    /**
+     * @brief Returns the best kernel supported by this CPU and OS (detected once).
+     */
+    FilterKernel DetectFilterKernel();
+
+    const char* GetFilterKernelName(FilterKernel kernel);
+
+    /**
+     * @brief Evaluates the LUT for one packet (the scalar kernel's per-row test).
+     * @param direction 0 for sent, 1 for received, as stored in the metadata columns.
+     */
+    bool LutSelects(const SelectionLut& lut, std::uint8_t direction, std::uint8_t header, std::uint8_t type);
+
+    /**
+     * @brief Evaluates the LUT for `count` packets into a selection bitmap.
+     * @param bitmap Receives (count + 63) / 64 words; bits past `count` are zero.
+     * @param kernel Kernel to use; must be supported (see DetectFilterKernel).
+     */
+    void BuildSelectionBitmap(const std::uint8_t* directions, const std::uint8_t* headers, const std::uint8_t* types,
+        std::size_t count, const SelectionLut& lut, std::vector<std::uint64_t>& bitmap, FilterKernel kernel);
+
+    /**
+     * @brief Converts a selection bitmap into the list of set bit positions.
+     */
+    void CompactSelection(const std::vector<std::uint64_t>& bitmap, std::vector<int>& indices);
+
+} // namespace kx::Filtering
@@ -1,73 +1,200 @@
 #include "FilterUtils.h"
 #include "PacketHeaders.h" // For GetPacketName, GetSpecialPacketTypeName (needed indirectly for filter map keys)
+#include "FilterExpression.h"
+#include "CapturePolicy.h"  // For SetIncludedOpcodes
+
+#include <algorithm>
+#include <cstring>
 
 namespace kx::Filtering {
 
-    // Helper function (implementation of the check)
-    bool ShouldDisplayPacket(const kx::PacketInfo& packet) {
-        // 1. Apply direction filter
-        if (kx::g_packetDirectionFilterMode == kx::DirectionFilterMode::ShowSentOnly && packet.direction != kx::PacketDirection::Sent) {
-            return false;
-        }
-        if (kx::g_packetDirectionFilterMode == kx::DirectionFilterMode::ShowReceivedOnly && packet.direction != kx::PacketDirection::Received) {
-            return false;
-        }
+    // Flattens the direction and header/type filters into the bit-packed table used by
+    // the filter kernels and by PassesSelectionFilters.
+    static void BuildSelectionLut(SelectionLut& lut) {
+        constexpr int TYPE_COUNT = static_cast<int>(kx::InternalPacketType::PROCESSING_ERROR) + 1;
+        auto modeAllows = [](bool foundInFilters, bool isChecked) {
+            if (kx::g_packetFilterMode == kx::FilterMode::IncludeOnly) return foundInFilters && isChecked;
+            if (kx::g_packetFilterMode == kx::FilterMode::Exclude) return !(foundInFilters && isChecked);
+            return true;
+        };
 
-        // 2. Apply header/type include/exclude filter (only if mode is not ShowAll)
-        if (kx::g_packetFilterMode != kx::FilterMode::ShowAll) {
-            bool isChecked = false;
-            bool foundInFilters = false;
-
-            // Check against header filters if it's a normal/unknown header packet
-            if (packet.specialType == kx::InternalPacketType::NORMAL || packet.specialType == kx::InternalPacketType::UNKNOWN_HEADER) {
-                // Construct the key used in the global map
-                auto key = std::make_pair(packet.direction, packet.rawHeaderId);
-                auto it = kx::g_packetHeaderFilterSelection.find(key);
-                if (it != kx::g_packetHeaderFilterSelection.end()) {
-                    isChecked = it->second; // Get the boolean value (checked state)
-                    foundInFilters = true;
-                }
-            }
-            // Check against special type filters otherwise
-            else {
-                auto it = kx::g_specialPacketFilterSelection.find(packet.specialType);
-                if (it != kx::g_specialPacketFilterSelection.end()) {
-                    isChecked = it->second;
-                    foundInFilters = true;
-                }
-            }
+        lut = SelectionLut{};
+        for (int dir = 0; dir < 2; ++dir) {
+            const kx::PacketDirection direction = dir == 0 ? kx::PacketDirection::Sent : kx::PacketDirection::Received;
+            const bool directionAllowed = kx::g_packetDirectionFilterMode == kx::DirectionFilterMode::ShowAll
+                || (kx::g_packetDirectionFilterMode == kx::DirectionFilterMode::ShowSentOnly && dir == 0)
+                || (kx::g_packetDirectionFilterMode == kx::DirectionFilterMode::ShowReceivedOnly && dir == 1);
+            if (!directionAllowed) continue;
 
-            // Apply Include/Exclude logic
-            if (kx::g_packetFilterMode == kx::FilterMode::IncludeOnly) {
-                // Must be found in the filter list AND be checked to be included
-                if (!foundInFilters || !isChecked) {
-                    return false;
+            for (int header = 0; header < 256; ++header) {
+                bool allowed = true;
+                if (kx::g_packetFilterMode != kx::FilterMode::ShowAll) {
+                    auto it = kx::g_packetHeaderFilterSelection.find(std::make_pair(direction, static_cast<uint8_t>(header)));
+                    bool found = it != kx::g_packetHeaderFilterSelection.end();
+                    allowed = modeAllows(found, found && it->second);
                 }
+                if (allowed) lut.headerBits[dir][header >> 3] |= static_cast<std::uint8_t>(1u << (header & 7));
             }
-            else { // Exclude mode (kx::g_packetFilterMode == kx::FilterMode::Exclude)
-                // Must NOT be (found in the list AND checked) to be included (i.e., exclude if found and checked)
-                if (foundInFilters && isChecked) {
-                    return false;
+            for (int type = 0; type < TYPE_COUNT; ++type) {
+                bool allowed = true;
+                if (kx::g_packetFilterMode != kx::FilterMode::ShowAll) {
+                    auto it = kx::g_specialPacketFilterSelection.find(static_cast<kx::InternalPacketType>(type));
+                    bool found = it != kx::g_specialPacketFilterSelection.end();
+                    allowed = modeAllows(found, found && it->second);
                 }
+                if (allowed) lut.specialBits[dir] |= static_cast<std::uint8_t>(1u << type);
             }
         }
+    }
 
-        // If all checks passed, display the packet
-        return true;
+    // Direction and header/type checkbox filters, for one full record.
+    static bool PassesSelectionFilters(const kx::PacketInfo& packet, const SelectionLut& lut) {
+        return LutSelects(lut, packet.direction == kx::PacketDirection::Sent ? 0 : 1, packet.rawHeaderId,
+            static_cast<std::uint8_t>(packet.specialType));
     }
 
+    static bool IsShowAll(const FilterSnapshot& filters) {
+        return filters.mode == kx::FilterMode::ShowAll && filters.directionMode == kx::DirectionFilterMode::ShowAll;
+    }
 
-    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog) {
-        std::vector<int> filteredIndices;
-        // Reserve likely size? Maybe not necessary if filtering is aggressive.
-        // filteredIndices.reserve(fullLog.size() / 2); // Example guess
+    FilterSnapshot CaptureFilterSnapshot() {
+        FilterSnapshot filters;
+        filters.mode = kx::g_packetFilterMode;
+        filters.directionMode = kx::g_packetDirectionFilterMode;
+        BuildSelectionLut(filters.lut);
+        filters.expression = GetActiveFilterExpression();
+        return filters;
+    }
 
+    bool ShouldDisplayPacket(const kx::PacketInfo& packet, const FilterSnapshot& filters) {
+        if (!PassesSelectionFilters(packet, filters.lut)) {
+            return false;
+        }
+        return !filters.expression || filters.expression->Evaluate(packet);
+    }
+
+
+    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog, const FilterSnapshot& filters) {
+        std::vector<int> filteredIndices;
         for (int i = 0; i < fullLog.size(); ++i) {
-            if (ShouldDisplayPacket(fullLog[i])) {
+            if (ShouldDisplayPacket(fullLog[i], filters)) {
                 filteredIndices.push_back(i);
             }
         }
         return filteredIndices;
     }
 
-} // namespace kx::Filtering
\ No newline at end of file
+
+    // Runs the selection kernel over metadata rows [begin, end), one contiguous chunk at a
+    // time, and stores the offsets (from begin) of the selected rows in `selected`.
+    static void SelectRows(const kx::PacketMetadataStore& metadata, std::size_t begin, std::size_t end,
+        const SelectionLut& lut, FilterKernel kernel, std::vector<int>& selected)
+    {
+        selected.clear();
+        std::vector<std::uint64_t> bitmap;
+        std::vector<int> chunkSelected;
+        for (std::size_t position = begin; position < end;) {
+            const std::size_t rows = std::min(end - position, metadata.ContiguousRows(position));
+            BuildSelectionBitmap(metadata.Directions().Data(position), metadata.Headers().Data(position),
+                metadata.Types().Data(position), rows, lut, bitmap, kernel);
+            CompactSelection(bitmap, chunkSelected);
+            const int base = static_cast<int>(position - begin);
+            for (int offset : chunkSelected) selected.push_back(base + offset);
+            position += rows;
+        }
+    }
+
+    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog, const kx::PacketMetadataStore& metadata) {
+        return GetFilteredPacketIndices(fullLog, metadata, DetectFilterKernel(), CaptureFilterSnapshot());
+    }
+
+    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog, const kx::PacketMetadataStore& metadata,
+        FilterKernel kernel, const FilterSnapshot& filters)
+    {
+        std::vector<int> filteredIndices;
+        const std::size_t count = std::min(fullLog.size(), metadata.Size());
+
+        if (IsShowAll(filters)) {
+            filteredIndices.resize(count);
+            for (std::size_t i = 0; i < count; ++i) filteredIndices[i] = static_cast<int>(i);
+        }
+        else {
+            SelectRows(metadata, 0, count, filters.lut, kernel, filteredIndices);
+        }
+
+        // The expression filter needs the full record; evaluate it on survivors only.
+        if (const auto& expression = filters.expression) {
+            filteredIndices.erase(std::remove_if(filteredIndices.begin(), filteredIndices.end(),
+                [&](int index) { return !expression->Evaluate(fullLog[index]); }), filteredIndices.end());
+        }
+        return filteredIndices;
+    }
+
+    void AppendFilteredPacketSequences(const std::deque<kx::PacketInfo>& fullLog, const kx::PacketMetadataStore& metadata,
+        kx::PacketSequence firstSequence, std::size_t begin, std::size_t end, std::vector<kx::PacketSequence>& sequences)
+    {
+        end = std::min({ end, fullLog.size(), metadata.Size() });
+        if (begin >= end) {
+            return;
+        }
+
+        const std::size_t first = sequences.size();
+        if (kx::g_packetFilterMode == kx::FilterMode::ShowAll && kx::g_packetDirectionFilterMode == kx::DirectionFilterMode::ShowAll) {
+            sequences.resize(first + (end - begin));
+            for (std::size_t i = begin; i < end; ++i) sequences[first + (i - begin)] = firstSequence + i;
+        }
+        else {
+            SelectionLut lut;
+            BuildSelectionLut(lut);
+            std::vector<int> selected;
+            SelectRows(metadata, begin, end, lut, DetectFilterKernel(), selected);
+            sequences.reserve(first + selected.size());
+            for (int offset : selected) sequences.push_back(firstSequence + begin + static_cast<std::size_t>(offset));
+        }
+
+        if (auto expression = GetActiveFilterExpression()) {
+            sequences.erase(std::remove_if(sequences.begin() + first, sequences.end(),
+                [&](kx::PacketSequence sequence) { return !expression->Evaluate(fullLog[sequence - firstSequence]); }), sequences.end());
+        }
+    }
+
+    // Opcode bits last handed to the capture policy; UI thread only.
+    static std::uint64_t s_publishedOpcodes[2][4] = {};
+    static bool s_opcodesPublished = false;
+
+    void PublishCaptureOpcodes() {
+        SelectionLut lut;
+        BuildSelectionLut(lut);
+        std::uint64_t included[2][4] = {};
+        for (int dir = 0; dir < 2; ++dir) {
+            for (int header = 0; header < 256; ++header) {
+                if ((lut.headerBits[dir][header >> 3] >> (header & 7)) & 1u) {
+                    included[dir][header >> 6] |= 1ull << (header & 63);
+                }
+            }
+        }
+        if (s_opcodesPublished && std::memcmp(included, s_publishedOpcodes, sizeof(included)) == 0) {
+            return;
+        }
+        kx::Capture::SetIncludedOpcodes(included);
+        std::memcpy(s_publishedOpcodes, included, sizeof(included));
+        s_opcodesPublished = true;
+    }
+
+    std::uint64_t GetFilterSignature() {
+        SelectionLut lut;
+        BuildSelectionLut(lut);
+        std::uint64_t hash = 1469598103934665603ull;
+        auto mix = [&hash](std::uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+        for (const auto& direction : lut.headerBits) {
+            for (std::uint8_t bits : direction) mix(bits);
+        }
+        mix(lut.specialBits[0]);
+        mix(lut.specialBits[1]);
+        // Compiled expressions are immutable and a new one is compiled while the previous one
+        // is still active, so the instance identifies the expression.
+        mix(reinterpret_cast<std::uintptr_t>(GetActiveFilterExpression().get()));
+        return hash;
+    }
+
+} // namespace kx::Filtering
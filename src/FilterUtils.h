@@ -2,23 +2,90 @@
 
 #include "PacketData.h" // For PacketInfo, PacketDirection
 #include "AppState.h"   // For filter modes and selections
+#include "PacketMetadata.h" // For PacketMetadataStore
+#include "FilterKernel.h"   // For FilterKernel
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <deque>
 
 namespace kx::Filtering {
 
+    class CompiledFilter;
+
+    /**
+     * @brief A copy of the filter settings, for filtering off the UI thread.
+     * @details The filter globals belong to the UI thread, which edits them while it
+     *          renders; work on other threads filters against a snapshot taken there.
+     */
+    struct FilterSnapshot {
+        kx::FilterMode mode = kx::FilterMode::ShowAll;
+        kx::DirectionFilterMode directionMode = kx::DirectionFilterMode::ShowAll;
+        SelectionLut lut;                                  // Direction and header/type filters
+        std::shared_ptr<const CompiledFilter> expression;  // Null if no expression is active
+    };
+
     /**
-     * @brief Applies the current global filters to the packet log.
+     * @brief Captures the current filter settings. Call on the UI thread.
+     */
+    FilterSnapshot CaptureFilterSnapshot();
+
+    /**
+     * @brief Applies the snapshot's filters to the packet log, one record at a time.
      * @param fullLog A const reference to the complete packet log deque.
      * @return A vector containing the indices (relative to fullLog) of packets that pass the filters.
      */
-    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog);
+    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog, const FilterSnapshot& filters);
+
+    /**
+     * @brief Columnar variant of GetFilteredPacketIndices.
+     * @details The direction and header/type filters are evaluated on the packed metadata
+     *          columns by the fastest supported filter kernel (see FilterKernel.h); only
+     *          survivors are touched in fullLog, and only when a filter expression is active.
+     * @param fullLog The packet log the metadata describes (index-aligned).
+     * @param metadata Metadata columns for fullLog.
+     */
+    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog, const kx::PacketMetadataStore& metadata);
+
+    /**
+     * @brief As above with a filter snapshot and an explicit kernel (for benchmarks); the
+     *        kernel must be supported.
+     */
+    std::vector<int> GetFilteredPacketIndices(const std::deque<kx::PacketInfo>& fullLog, const kx::PacketMetadataStore& metadata,
+        FilterKernel kernel, const FilterSnapshot& filters);
+
+    /**
+     * @brief Appends the sequences of the packets at [begin, end) that pass the current
+     *        filters to `sequences`.
+     * @details Range form of the columnar GetFilteredPacketIndices, used to build the
+     *          filtered view a slice at a time (see FilteredView.h).
+     * @param firstSequence Sequence of fullLog[0].
+     */
+    void AppendFilteredPacketSequences(const std::deque<kx::PacketInfo>& fullLog, const kx::PacketMetadataStore& metadata,
+        kx::PacketSequence firstSequence, std::size_t begin, std::size_t end, std::vector<kx::PacketSequence>& sequences);
+
+    /**
+     * @brief Identifies the current filter settings.
+     * @details Two calls return the same value only if every packet gets the same filter
+     *          result, so a changed signature means a filtered view must be rebuilt.
+     */
+    std::uint64_t GetFilterSignature();
+
+    /**
+     * @brief Hands the opcodes the direction and header filters show to the capture policy
+     *        (Capture::SetIncludedOpcodes), if they changed since the last call.
+     * @details Uses the same mode logic as the log filter, so Include, Exclude and Show All
+     *          all apply. Call from the UI thread whenever the filters may have changed (once
+     *          per frame) and before enabling CapturePolicy::includedOpcodesOnly.
+     */
+    void PublishCaptureOpcodes();
 
     /**
-     * @brief Checks if a single packet passes the current global filters.
+     * @brief Checks if a single packet passes the snapshot's filters.
      * @param packet The packet to check.
      * @return True if the packet should be displayed, false otherwise.
      */
-    bool ShouldDisplayPacket(const kx::PacketInfo& packet);
+    bool ShouldDisplayPacket(const kx::PacketInfo& packet, const FilterSnapshot& filters);
 
 } // namespace kx::Filtering
\ No newline at end of file
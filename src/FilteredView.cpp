@@ -0,0 +1,122 @@
+#include "FilteredView.h"
+#include "FilterUtils.h"
+#include "FilterExpression.h"
+#include "FrameBudget.h"
+#include "LazyDecryption.h"
+#include "PacketData.h"      // For g_packetLog, g_packetLogMutex, g_packetLogFirstSequence
+#include "PacketMetadata.h"  // For g_packetMetadata
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+namespace kx::FilteredView {
+
+    namespace {
+
+        // The passing packets among log rows [0, end).
+        struct View {
+            std::vector<PacketSequence> sequences;
+            std::size_t end = 0;
+            PacketSequence firstSequence = 0; // Of the log the rows belong to
+            std::uint64_t signature = 0;
+
+            void Restart(std::uint64_t newSignature) {
+                sequences.clear();
+                end = 0;
+                firstSequence = g_packetLogFirstSequence;
+                signature = newSignature;
+            }
+        };
+
+        View s_view;             // What Update() returns
+        View s_rebuild;          // Replaces s_view once it has caught up with the log
+        bool s_hasView = false;
+        bool s_rebuilding = false;
+        std::size_t s_logSize = 0;
+
+        std::uint64_t CurrentSignature() {
+            std::uint64_t signature = Filtering::GetFilterSignature();
+            // Payload filters skip packets that are still encrypted, so finishing the
+            // background decryption changes the result.
+            auto expression = Filtering::GetActiveFilterExpression();
+            if (expression && expression->ReadsPayload() && Decryption::GetProgress().running) {
+                signature ^= 0x9E3779B97F4A7C15ull;
+            }
+            return signature;
+        }
+
+        // Requires g_packetLogMutex.
+        bool IsStale(const View& view, std::size_t count) {
+            return view.firstSequence != g_packetLogFirstSequence || view.end > count;
+        }
+
+        // Requires g_packetLogMutex. Filters further rows of the log into `view`, one slice
+        // at least and more while the frame budget lasts.
+        void Advance(View& view, std::size_t count) {
+            do {
+                const std::size_t to = std::min(view.end + FILTER_SLICE_ROWS, count);
+                Filtering::AppendFilteredPacketSequences(g_packetLog, g_packetMetadata, view.firstSequence, view.end, to, view.sequences);
+                view.end = to;
+            } while (view.end < count && FrameBudget::HasTimeLeft());
+
+            if (view.end < count) {
+                FrameBudget::MarkDeferred();
+            }
+        }
+
+    } // anonymous namespace
+
+
+    const std::vector<PacketSequence>& Update() {
+        const std::uint64_t signature = CurrentSignature();
+
+        std::lock_guard<std::mutex> lock(g_packetLogMutex);
+        const std::size_t count = std::min(g_packetLog.size(), g_packetMetadata.Size());
+        s_logSize = count;
+
+        if (!s_hasView || IsStale(s_view, count)) {
+            // Nothing worth keeping on screen: build the new view in place.
+            s_view.Restart(signature);
+            s_hasView = true;
+            s_rebuilding = false;
+        }
+        else if (signature == s_view.signature) {
+            s_rebuilding = false; // Filters changed back before a rebuild finished
+        }
+        else if (!s_rebuilding || signature != s_rebuild.signature || IsStale(s_rebuild, count)) {
+            s_rebuild.Restart(signature);
+            s_rebuilding = true;
+        }
+
+        if (s_rebuilding) {
+            Advance(s_rebuild, count);
+            if (s_rebuild.end == count) {
+                std::swap(s_view, s_rebuild);
+                s_rebuild.Restart(0);
+                s_rebuilding = false;
+            }
+        }
+        else if (s_view.end < count) {
+            Advance(s_view, count);
+        }
+        return s_view.sequences;
+    }
+
+    Progress GetProgress() {
+        Progress progress;
+        progress.rebuilding = s_rebuilding || (s_hasView && s_view.end < s_logSize);
+        progress.examinedPackets = s_rebuilding ? s_rebuild.end : s_view.end;
+        progress.totalPackets = s_logSize;
+        return progress;
+    }
+
+    void Reset() {
+        s_view = View();
+        s_rebuild = View();
+        s_hasView = false;
+        s_rebuilding = false;
+        s_logSize = 0;
+    }
+
+} // namespace kx::FilteredView
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file FilteredView.h
+ * @brief The sequences of the logged packets that pass the current filters, maintained incrementally.
+ * @details Instead of filtering the whole log every frame, the view remembers how much of
+ *          the log it has examined and only filters the new packets. When the filter
+ *          settings change (see Filtering::GetFilterSignature) the view is rebuilt from the
+ *          start. Both happen in slices of FILTER_SLICE_ROWS packets under the frame budget
+ *          (FrameBudget.h). The first slice always runs. A rebuild that does not fit in one
+ *          frame continues on the next one, and until it completes the previous view stays
+ *          on screen.
+ *
+ *          Clearing or swapping the log changes g_packetLogFirstSequence, which restarts
+ *          the view.
+ */
+
+#include <cstddef>
+#include <vector>
+#include "PacketData.h" // For PacketSequence
+
+namespace kx::FilteredView {
+
+    constexpr std::size_t FILTER_SLICE_ROWS = 16 * 1024;
+
+    /**
+     * @brief Advances the view by budgeted slices and returns it (sequences, ascending).
+     * @details Takes g_packetLogMutex; the caller must not hold it. The reference stays
+     *          valid until the next Update() or Reset() call.
+     */
+    const std::vector<PacketSequence>& Update();
+
+    struct Progress {
+        bool rebuilding = false;
+        std::size_t examinedPackets = 0; // Of the rebuild in progress
+        std::size_t totalPackets = 0;
+    };
+
+    Progress GetProgress();
+
+    void Reset();
+
+} // namespace kx::FilteredView
@@ -6,6 +6,7 @@
 // Include PacketData.h again here for the implementation details of PacketInfo if needed,
 // although it's already included via the header. Best practice includes what you use.
 #include "PacketData.h" // Provides PacketInfo definition, PacketDirection
+#include "LazyDecryption.h" // For on-demand plaintext of deferred packets
 
 namespace kx::Utils {
 
@@ -25,11 +26,16 @@ namespace kx::Utils {
     }
 
     std::string FormatBytesToHex(const std::vector<uint8_t>& data, int maxBytes) {
+        return FormatBytesToHex(data.data(), data.size(), maxBytes);
+    }
+
+    std::string FormatBytesToHex(const uint8_t* data, size_t size, int maxBytes) {
         std::stringstream ss;
         int count = 0;
         bool truncated = false; // Flag to check if truncation happened
 
-        for (const auto& byte : data) {
+        for (size_t i = 0; i < size; ++i) {
+            const uint8_t byte = data[i];
             // Apply maxBytes limit (only if positive)
             if (maxBytes > 0 && count >= maxBytes) {
                 ss << "...";
@@ -44,15 +50,15 @@ namespace kx::Utils {
         }
 
         // Handle edge cases for display string
-        if (data.empty()) {
+        if (size == 0) {
             return "(empty)";
         }
         // If maxBytes forced truncation and no bytes were printed (e.g., maxBytes=0)
-        if (count == 0 && maxBytes == 0 && !data.empty()) {
+        if (count == 0 && maxBytes == 0 && size != 0) {
             return "...";
         }
         // If data exists, but limit was 0 or negative, and nothing printed (shouldn't happen with loop fix)
-        if (ss.str().empty() && !data.empty() && !truncated) {
+        if (ss.str().empty() && size != 0 && !truncated) {
             // This case might indicate an issue, but return something sensible.
             // If maxBytes <= 0, it should have printed everything.
             return "(Error Formatting Hex?)"; // Or return empty string ""
@@ -65,11 +71,11 @@ namespace kx::Utils {
     std::string FormatDisplayLogEntryString(const PacketInfo& packet, int maxHexBytes) {
         std::string timestampStr = FormatTimestamp(packet.timestamp);
         const char* directionStr = (packet.direction == PacketDirection::Sent) ? "[S]" : "[R]";
-        const auto& dataToDisplay = packet.GetDisplayData(); // Use helper for potentially decrypted data
+        const auto& dataToDisplay = Decryption::GetPlaintext(packet); // Decrypted (on demand if deferred)
         int displaySize = dataToDisplay.size();
 
         // *** Use the maxHexBytes parameter for display ***
-        std::string dataHexStr = FormatBytesToHex(dataToDisplay, maxHexBytes);
+        std::string dataHexStr = FormatBytesToHex(dataToDisplay.data(), dataToDisplay.size(), maxHexBytes);
 
         std::stringstream ss;
         ss << timestampStr << " " << directionStr << " "
@@ -82,11 +88,11 @@ namespace kx::Utils {
     std::string FormatFullLogEntryString(const PacketInfo& packet) {
         std::string timestampStr = FormatTimestamp(packet.timestamp);
         const char* directionStr = (packet.direction == PacketDirection::Sent) ? "[S]" : "[R]";
-        const auto& dataToDisplay = packet.GetDisplayData();
+        const auto& dataToDisplay = Decryption::GetPlaintext(packet);
         int displaySize = dataToDisplay.size();
 
         // *** Call FormatBytesToHex with -1 (or 0) for no limit ***
-        std::string dataHexStr = FormatBytesToHex(dataToDisplay, -1); // Use -1 for unlimited
+        std::string dataHexStr = FormatBytesToHex(dataToDisplay.data(), dataToDisplay.size(), -1); // Use -1 for unlimited
 
         std::stringstream ss;
         ss << timestampStr << " " << directionStr << " "
@@ -26,8 +26,14 @@ namespace kx::Utils {
      */
     std::string FormatBytesToHex(const std::vector<uint8_t>& data, int maxBytes = 32);
 
+    /**
+     * @brief Pointer/length overload of FormatBytesToHex (e.g. for PacketPayload).
+     */
+    std::string FormatBytesToHex(const uint8_t* data, size_t size, int maxBytes = 32);
+
     /**
      * @brief Formats a PacketInfo for display (potentially truncated hex).
+     * @details Deferred payloads are decrypted on demand; the caller must hold g_packetLogMutex for log entries.
      * @param packet The PacketInfo object.
      * @param maxHexBytes Max hex bytes to display before adding "...".
      * @return A formatted string for the log display.
@@ -36,6 +42,7 @@ namespace kx::Utils {
 
     /**
      * @brief Formats a PacketInfo for copying (full, untruncated hex).
+     * @details Deferred payloads are decrypted on demand; the caller must hold g_packetLogMutex for log entries.
      * @param packet The PacketInfo object.
      * @return A formatted string with the complete hex data.
      */
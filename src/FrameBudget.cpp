@@ -0,0 +1,73 @@
+#include "FrameBudget.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace kx::FrameBudget {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        double s_budgetMs = DEFAULT_BUDGET_MS;
+        Clock::time_point s_frameStart;
+        Clock::time_point s_deadline;
+        bool s_inFrame = false;
+        bool s_deferredThisFrame = false;
+        Stats s_stats;
+
+    } // anonymous namespace
+
+
+    void SetBudgetMs(double budgetMs) {
+        s_budgetMs = std::max(0.05, budgetMs);
+    }
+
+    double GetBudgetMs() {
+        return s_budgetMs;
+    }
+
+    void BeginFrame() {
+        s_frameStart = Clock::now();
+        s_deadline = s_frameStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(s_budgetMs));
+        s_inFrame = true;
+        s_deferredThisFrame = false;
+    }
+
+    void EndFrame() {
+        if (!s_inFrame) {
+            return;
+        }
+        s_inFrame = false;
+
+        const double frameMs = std::chrono::duration<double, std::milli>(Clock::now() - s_frameStart).count();
+        ++s_stats.frames;
+        s_stats.lastFrameMs = frameMs;
+        s_stats.maxFrameMs = std::max(s_stats.maxFrameMs, frameMs);
+        if (frameMs > s_budgetMs) {
+            ++s_stats.overrunFrames;
+            s_stats.lastOverrunMs = frameMs - s_budgetMs;
+        }
+        if (s_deferredThisFrame) {
+            ++s_stats.deferredFrames;
+        }
+    }
+
+    bool HasTimeLeft() {
+        // Outside a frame (e.g. benchmarks driving the UI code directly) there is no budget.
+        return !s_inFrame || Clock::now() < s_deadline;
+    }
+
+    void MarkDeferred() {
+        s_deferredThisFrame = true;
+    }
+
+    Stats GetStats() {
+        return s_stats;
+    }
+
+    void ResetStats() {
+        s_stats = Stats();
+    }
+
+} // namespace kx::FrameBudget
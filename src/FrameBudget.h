@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ * @file FrameBudget.h
+ * @brief Per-frame time budget for the inspector's work inside the game's Present call.
+ * @details The overlay is built on the game's render thread, so any time it spends shows up
+ *          as a longer game frame. Work whose size depends on the log (filtering new or all
+ *          packets, formatting rows) is split into steps that ask HasTimeLeft() between
+ *          steps and continue on the next frame once the budget is used up. Each call site
+ *          still makes a minimum amount of progress per frame so work cannot starve.
+ *
+ *          The budget covers the whole inspector UI build (ImGuiManager::RenderUI), timed
+ *          from BeginFrame() to EndFrame(); frames that end past the budget count as
+ *          overruns and are shown in the Status section. Render-thread only.
+ */
+
+#include <cstdint>
+
+namespace kx::FrameBudget {
+
+    constexpr double DEFAULT_BUDGET_MS = 0.5;
+
+    void SetBudgetMs(double budgetMs);
+    double GetBudgetMs();
+
+    /**
+     * @brief Starts timing the current frame.
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Stops timing the current frame and updates the statistics.
+     */
+    void EndFrame();
+
+    /**
+     * @brief True while the current frame has used less than the budget.
+     */
+    bool HasTimeLeft();
+
+    /**
+     * @brief Records that work was left for a later frame.
+     */
+    void MarkDeferred();
+
+    struct Stats {
+        std::uint64_t frames = 0;
+        std::uint64_t overrunFrames = 0;   // Frames that took longer than the budget
+        std::uint64_t deferredFrames = 0;  // Frames that left work for a later frame
+        double lastFrameMs = 0.0;
+        double maxFrameMs = 0.0;
+        double lastOverrunMs = 0.0;        // Time past the budget of the latest overrun
+    };
+
+    Stats GetStats();
+    void ResetStats();
+
+} // namespace kx::FrameBudget
@@ -0,0 +1,227 @@
+#include "HexDumpView.h"
+#include "../ImGui/imgui.h"
+#include "PacketData.h"      // For g_packetLog, g_packetLogMutex, FindLogPosition
+#include "PacketMetadata.h"  // For g_packetMetadata
+#include "LazyDecryption.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace kx::HexView {
+
+    namespace {
+
+        // Character columns of a dump line:
+        // "00000000  00 11 22 33 44 55 66 77  88 99 AA BB CC DD EE FF |0123456789ABCDEF|"
+        constexpr int HEX_COLUMN = 10;
+        constexpr int ASCII_COLUMN = HEX_COLUMN + BYTES_PER_LINE * 3 + 2;
+        constexpr int LINE_LENGTH = ASCII_COLUMN + BYTES_PER_LINE + 1;
+
+        // The loaded packet, copied out of the log.
+        struct PaneState {
+            PacketSequence sequence = INVALID_PACKET_SEQUENCE;
+            bool originalRequested = false; // s_showOriginal when loaded
+            bool hasOriginal = false;       // Packet was encrypted, so both views exist
+            std::string title;
+            std::vector<std::uint8_t> bytes;
+            PacketSequence previous = INVALID_PACKET_SEQUENCE; // Previous packet with the same direction and opcode
+            std::vector<std::uint8_t> previousBytes;
+        };
+
+        PaneState s_pane;
+        bool s_showOriginal = false;
+
+        int HexColumn(int byte) {
+            return HEX_COLUMN + byte * 3 + (byte >= BYTES_PER_LINE / 2 ? 1 : 0);
+        }
+
+        // Requires g_packetLogMutex. Copies the bytes of the requested view.
+        std::vector<std::uint8_t> CopyBytes(const PacketInfo& packet, bool original) {
+            const PacketPayload& payload = original ? packet.data : Decryption::GetPlaintext(packet);
+            return std::vector<std::uint8_t>(payload.data(), payload.data() + payload.size());
+        }
+
+        // Requires g_packetLogMutex. Returns the log position of the previous packet with
+        // the same direction and opcode as the one at `position`, or false.
+        bool FindPreviousSameOpcode(std::size_t position, std::size_t& previous) {
+            const std::size_t count = std::min(g_packetMetadata.Size(), g_packetLog.size());
+            if (position >= count) return false;
+            const auto& directions = g_packetMetadata.Directions();
+            const auto& headers = g_packetMetadata.Headers();
+            const auto& types = g_packetMetadata.Types();
+            for (std::size_t i = position; i-- > 0;) {
+                if (headers[i] == headers[position] && directions[i] == directions[position] && types[i] == types[position]) {
+                    previous = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Reloads the pane if the selection or the view mode changed.
+        // Returns false if the packet is no longer in the log.
+        bool LoadPacket(PacketSequence sequence) {
+            std::lock_guard<std::mutex> lock(g_packetLogMutex);
+            std::size_t position = 0;
+            if (!FindLogPosition(sequence, position)) {
+                s_pane = PaneState();
+                return false;
+            }
+
+            const PacketInfo& packet = g_packetLog[position];
+            if (s_pane.sequence == sequence && s_pane.originalRequested == s_showOriginal) {
+                return true;
+            }
+
+            s_pane = PaneState();
+            s_pane.sequence = sequence;
+            s_pane.originalRequested = s_showOriginal;
+            s_pane.hasOriginal = packet.decryptedData.has_value() || packet.IsDecryptionDeferred();
+            const bool original = s_showOriginal && s_pane.hasOriginal;
+            s_pane.bytes = CopyBytes(packet, original);
+
+            std::size_t previous = 0;
+            if (FindPreviousSameOpcode(position, previous)) {
+                s_pane.previous = g_packetLogFirstSequence + previous;
+                s_pane.previousBytes = CopyBytes(g_packetLog[previous], original);
+            }
+
+            char title[160];
+            snprintf(title, sizeof(title), "#%llu %s %s (0x%02X), %zu bytes", static_cast<unsigned long long>(sequence),
+                packet.direction == PacketDirection::Sent ? "[S]" : "[R]", packet.name.c_str(),
+                packet.rawHeaderId, s_pane.bytes.size());
+            s_pane.title = title;
+            return true;
+        }
+
+        bool DiffersFromPrevious(std::size_t offset) {
+            return s_pane.previous != INVALID_PACKET_SEQUENCE
+                && (offset >= s_pane.previousBytes.size() || s_pane.bytes[offset] != s_pane.previousBytes[offset]);
+        }
+
+        // Formats line `line` of the loaded packet into `out` (LINE_LENGTH + 1 chars).
+        void FormatLine(std::size_t line, char* out) {
+            static const char HEX_DIGITS[] = "0123456789ABCDEF";
+            std::fill(out, out + LINE_LENGTH, ' ');
+            out[LINE_LENGTH] = '\0';
+
+            const std::size_t start = line * BYTES_PER_LINE;
+            snprintf(out, HEX_COLUMN, "%08zX", start);
+            out[8] = ' ';
+            out[ASCII_COLUMN - 1] = '|';
+
+            const std::size_t end = std::min(start + BYTES_PER_LINE, s_pane.bytes.size());
+            for (std::size_t offset = start; offset < end; ++offset) {
+                const int byte = static_cast<int>(offset - start);
+                const std::uint8_t value = s_pane.bytes[offset];
+                out[HexColumn(byte)] = HEX_DIGITS[value >> 4];
+                out[HexColumn(byte) + 1] = HEX_DIGITS[value & 0x0F];
+                out[ASCII_COLUMN + byte] = (value >= 0x20 && value < 0x7F) ? static_cast<char>(value) : '.';
+            }
+            out[ASCII_COLUMN + static_cast<int>(end - start)] = '|';
+        }
+
+        void CopyDumpToClipboard() {
+            std::string text;
+            const std::size_t lines = (s_pane.bytes.size() + BYTES_PER_LINE - 1) / BYTES_PER_LINE;
+            text.reserve(lines * (LINE_LENGTH + 1));
+            char line[LINE_LENGTH + 1];
+            for (std::size_t n = 0; n < lines; ++n) {
+                FormatLine(n, line);
+                text += line;
+                text += '\n';
+            }
+            ImGui::SetClipboardText(text.c_str());
+        }
+
+    } // anonymous namespace
+
+
+    void RenderPane(PacketSequence sequence) {
+        if (!LoadPacket(sequence)) {
+            ImGui::TextDisabled("Select a packet to show its bytes.");
+            return;
+        }
+
+        ImGui::TextUnformatted(s_pane.title.c_str());
+        ImGui::SameLine();
+        if (!s_pane.hasOriginal) ImGui::BeginDisabled();
+        ImGui::Checkbox("Original bytes", &s_showOriginal);
+        if (!s_pane.hasOriginal) ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip(s_pane.hasOriginal ? "Show the encrypted bytes as captured instead of the plaintext."
+                                                 : "Packet was not encrypted.");
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Copy Dump")) {
+            CopyDumpToClipboard();
+        }
+        ImGui::SameLine();
+        if (s_pane.previous != INVALID_PACKET_SEQUENCE) {
+            ImGui::TextDisabled("(highlighted: differs from #%llu)", static_cast<unsigned long long>(s_pane.previous));
+        }
+        else {
+            ImGui::TextDisabled("(no earlier packet with this opcode)");
+        }
+
+        ImGui::BeginChild("##HexLines", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]); // Default font is monospace
+
+        const float charWidth = ImGui::CalcTextSize("0").x;
+        const float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+        const float textOffsetY = ImGui::GetStyle().ItemSpacing.y * 0.5f;
+        const ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+        const ImU32 offsetColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+        const ImU32 diffColor = ImGui::GetColorU32(ImGuiCol_PlotHistogram, 0.45f);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+        const std::size_t lineCount = (s_pane.bytes.size() + BYTES_PER_LINE - 1) / BYTES_PER_LINE;
+        char line[LINE_LENGTH + 1];
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(lineCount), lineHeight);
+        while (clipper.Step()) {
+            const ImVec2 origin = ImGui::GetCursorScreenPos();
+            ImGui::Dummy(ImVec2(charWidth * LINE_LENGTH, lineHeight * static_cast<float>(clipper.DisplayEnd - clipper.DisplayStart)));
+
+            for (int n = clipper.DisplayStart; n < clipper.DisplayEnd; ++n) {
+                const std::size_t start = static_cast<std::size_t>(n) * BYTES_PER_LINE;
+                const std::size_t end = std::min(start + BYTES_PER_LINE, s_pane.bytes.size());
+                const float y = origin.y + lineHeight * static_cast<float>(n - clipper.DisplayStart);
+
+                // One highlight per run of differing bytes, in both the hex and ASCII columns.
+                for (std::size_t offset = start; offset < end;) {
+                    if (!DiffersFromPrevious(offset)) {
+                        ++offset;
+                        continue;
+                    }
+                    const int first = static_cast<int>(offset - start);
+                    while (offset < end && DiffersFromPrevious(offset)) ++offset;
+                    const int last = static_cast<int>(offset - start) - 1;
+                    const float hexX0 = origin.x + charWidth * static_cast<float>(HexColumn(first));
+                    const float hexX1 = origin.x + charWidth * static_cast<float>(HexColumn(last) + 2);
+                    const float asciiX0 = origin.x + charWidth * static_cast<float>(ASCII_COLUMN + first);
+                    const float asciiX1 = origin.x + charWidth * static_cast<float>(ASCII_COLUMN + last + 1);
+                    drawList->AddRectFilled(ImVec2(hexX0, y), ImVec2(hexX1, y + lineHeight), diffColor);
+                    drawList->AddRectFilled(ImVec2(asciiX0, y), ImVec2(asciiX1, y + lineHeight), diffColor);
+                }
+
+                FormatLine(static_cast<std::size_t>(n), line);
+                drawList->AddText(ImVec2(origin.x, y + textOffsetY), offsetColor, line, line + 8);
+                drawList->AddText(ImVec2(origin.x + charWidth * 8.0f, y + textOffsetY), textColor, line + 8, line + LINE_LENGTH);
+            }
+        }
+        clipper.End();
+
+        ImGui::PopFont();
+        ImGui::EndChild();
+    }
+
+    void Reset() {
+        s_pane = PaneState();
+    }
+
+} // namespace kx::HexView
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * @file HexDumpView.h
+ * @brief Offset / hex / ASCII dump of one packet, drawn for the visible lines only.
+ * @details The pane shows 16 bytes per line in the default (monospace) font. Lines go
+ *          through ImGuiListClipper and are formatted into a stack buffer as they are
+ *          drawn, so a 16 KiB packet costs the same per frame as a 16-byte one.
+ *
+ *          For encrypted packets the pane can show either the plaintext or the original
+ *          bytes. Bytes that differ from the previous packet with the same direction and
+ *          opcode (or lie past its end) are highlighted; the previous packet is found by a
+ *          backwards scan of the metadata columns when the selection changes.
+ *
+ *          The bytes of the shown packet and of its predecessor are copied out of the log
+ *          when the selection or the view mode changes, so drawing does not hold
+ *          g_packetLogMutex.
+ */
+
+#include "PacketData.h" // For PacketSequence
+
+namespace kx::HexView {
+
+    constexpr int BYTES_PER_LINE = 16;
+
+    /**
+     * @brief Draws the dump of packet `sequence` into the current window.
+     * @details Takes g_packetLogMutex when (re)loading the packet; the caller must not hold it.
+     */
+    void RenderPane(PacketSequence sequence);
+
+    /**
+     * @brief Forgets the loaded packet (e.g. after Clear Log).
+     */
+    void Reset();
+
+} // namespace kx::HexView
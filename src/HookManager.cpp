@@ -3,6 +3,16 @@
 
 namespace kx::Hooking {
 
+    bool HookManager::DisableAllHooks() {
+        MH_STATUS status = MH_DisableHook(MH_ALL_HOOKS);
+        if (status != MH_OK) {
+            std::cerr << "[HookManager] Failed to disable all hooks: "
+                << MH_StatusToString(status) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     bool HookManager::Initialize() {
         MH_STATUS status = MH_Initialize();
         if (status != MH_OK) {
@@ -57,6 +57,12 @@ namespace kx::Hooking {
         */
         static bool DisableHook(LPVOID pTarget);
 
+        /**
+        * @brief Disables every created hook, so no new detour invocations start.
+        * @return True if successful, false otherwise.
+        */
+        static bool DisableAllHooks();
+
     private:
         // Prevent instantiation
         HookManager() = delete;
@@ -0,0 +1,171 @@
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h> // For QueryPerformanceCounter
+
+#include "HookMetrics.h"
+
+#if KX_ENABLE_HOOK_METRICS
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace kx::HookMetrics {
+
+    namespace {
+
+        constexpr std::size_t HOOK_COUNT = static_cast<std::size_t>(HookId::Count);
+
+        LatencyHistogram s_histograms[HOOK_COUNT];
+
+        // TSC/QPC reference pair for tick -> nanosecond conversion.
+        std::atomic<std::uint64_t> s_referenceTsc{ 0 };
+        std::atomic<std::int64_t> s_referenceQpc{ 0 };
+
+        // Rate sampling state (UI thread only, guarded for safety).
+        std::mutex s_rateMutex;
+        std::chrono::steady_clock::time_point s_lastRateSample;
+        std::uint64_t s_lastRateCounts[HOOK_COUNT] = {};
+        double s_callsPerSecond[HOOK_COUNT] = {};
+
+        int MostSignificantBit(std::uint64_t value) noexcept {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanReverse64(&index, value);
+            return static_cast<int>(index);
+#else
+            return 63 - __builtin_clzll(value);
+#endif
+        }
+
+        double NanosecondsPerTick() {
+            std::uint64_t tsc0 = s_referenceTsc.load(std::memory_order_relaxed);
+            std::int64_t qpc0 = s_referenceQpc.load(std::memory_order_relaxed);
+            LARGE_INTEGER qpcNow, qpcFrequency;
+            QueryPerformanceCounter(&qpcNow);
+            QueryPerformanceFrequency(&qpcFrequency);
+            std::uint64_t tscNow = __rdtsc();
+            if (tsc0 == 0 || tscNow <= tsc0 || qpcNow.QuadPart <= qpc0 || qpcFrequency.QuadPart <= 0) {
+                return 0.0;
+            }
+            double elapsedNs = static_cast<double>(qpcNow.QuadPart - qpc0) * 1.0e9 / static_cast<double>(qpcFrequency.QuadPart);
+            return elapsedNs / static_cast<double>(tscNow - tsc0);
+        }
+
+    } // anonymous namespace
+
+
+    // --- LatencyHistogram ---
+
+    std::size_t LatencyHistogram::IndexOf(std::uint64_t value) noexcept {
+        if (value < SUB_BUCKET_COUNT) {
+            return static_cast<std::size_t>(value);
+        }
+        int shift = MostSignificantBit(value) - SUB_BUCKET_BITS + 1;
+        std::uint64_t subBucket = value >> shift; // In [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+        return static_cast<std::size_t>(SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + (subBucket - SUB_BUCKET_HALF));
+    }
+
+    std::uint64_t LatencyHistogram::HighestValueAt(std::size_t index) noexcept {
+        if (index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+        std::size_t offset = index - SUB_BUCKET_COUNT;
+        int shift = static_cast<int>(offset / SUB_BUCKET_HALF) + 1;
+        std::uint64_t subBucket = offset % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    std::uint64_t LatencyHistogram::ValueAtQuantile(double quantile) const noexcept {
+        std::uint64_t total = 0;
+        for (const auto& count : m_counts) {
+            total += count.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+
+        std::uint64_t target = static_cast<std::uint64_t>(quantile * static_cast<double>(total));
+        if (target >= total) target = total - 1;
+
+        std::uint64_t seen = 0;
+        for (std::size_t index = 0; index < BUCKET_COUNT; ++index) {
+            seen += m_counts[index].load(std::memory_order_relaxed);
+            if (seen > target) {
+                return std::min(HighestValueAt(index), MaxValue());
+            }
+        }
+        return MaxValue();
+    }
+
+    void LatencyHistogram::Reset() noexcept {
+        for (auto& count : m_counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        m_total.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+
+    // --- Free Functions ---
+
+    void Record(HookId hook, std::uint64_t ticks) noexcept {
+        s_histograms[static_cast<std::size_t>(hook)].Record(ticks);
+    }
+
+    void Initialize() {
+        LARGE_INTEGER qpc;
+        QueryPerformanceCounter(&qpc);
+        s_referenceQpc.store(qpc.QuadPart, std::memory_order_relaxed);
+        s_referenceTsc.store(__rdtsc(), std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(s_rateMutex);
+        s_lastRateSample = std::chrono::steady_clock::now();
+    }
+
+    void UpdateRates() {
+        std::lock_guard<std::mutex> lock(s_rateMutex);
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - s_lastRateSample).count();
+        if (elapsed < 0.5) {
+            return;
+        }
+        for (std::size_t k = 0; k < HOOK_COUNT; ++k) {
+            std::uint64_t count = s_histograms[k].TotalCount();
+            std::uint64_t delta = count >= s_lastRateCounts[k] ? count - s_lastRateCounts[k] : count;
+            s_callsPerSecond[k] = static_cast<double>(delta) / elapsed;
+            s_lastRateCounts[k] = count;
+        }
+        s_lastRateSample = now;
+    }
+
+    HookStats GetStats(HookId hook) {
+        const auto& histogram = s_histograms[static_cast<std::size_t>(hook)];
+        double nsPerTick = NanosecondsPerTick();
+
+        HookStats stats;
+        stats.calls = histogram.TotalCount();
+        stats.p50Ns = static_cast<double>(histogram.ValueAtQuantile(0.50)) * nsPerTick;
+        stats.p99Ns = static_cast<double>(histogram.ValueAtQuantile(0.99)) * nsPerTick;
+        stats.maxNs = static_cast<double>(histogram.MaxValue()) * nsPerTick;
+        {
+            std::lock_guard<std::mutex> lock(s_rateMutex);
+            stats.callsPerSecond = s_callsPerSecond[static_cast<std::size_t>(hook)];
+        }
+        return stats;
+    }
+
+    void Reset() {
+        for (auto& histogram : s_histograms) {
+            histogram.Reset();
+        }
+        std::lock_guard<std::mutex> lock(s_rateMutex);
+        for (std::size_t k = 0; k < HOOK_COUNT; ++k) {
+            s_lastRateCounts[k] = 0;
+            s_callsPerSecond[k] = 0.0;
+        }
+    }
+
+} // namespace kx::HookMetrics
+
+#endif // KX_ENABLE_HOOK_METRICS
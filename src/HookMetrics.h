@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * @file HookMetrics.h
+ * @brief Low-overhead latency instrumentation for the MsgSend/MsgRecv detours.
+ * @details Each detour measures the TSC delta from its entry to the call of the
+ *          original function on the calling thread and records it into a lock-free,
+ *          log-linear (HDR-style) histogram. Recording is a couple of relaxed atomic
+ *          increments. Set KX_ENABLE_HOOK_METRICS to 0 in Config.h (or the project
+ *          settings) to compile the instrumentation out entirely.
+ */
+
+#include "Config.h" // For KX_ENABLE_HOOK_METRICS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if KX_ENABLE_HOOK_METRICS
+#include <intrin.h> // For __rdtsc
+#endif
+
+namespace kx::HookMetrics {
+
+    enum class HookId {
+        MsgSend,
+        MsgRecv,
+        Count
+    };
+
+    /**
+     * @brief Aggregated view of one hook's histogram, converted to nanoseconds.
+     */
+    struct HookStats {
+        std::uint64_t calls = 0;
+        double p50Ns = 0.0;
+        double p99Ns = 0.0;
+        double maxNs = 0.0;
+        double callsPerSecond = 0.0; // Measured over the last UpdateRates() interval
+    };
+
+#if KX_ENABLE_HOOK_METRICS
+
+    /**
+     * @brief Lock-free log-linear histogram of 64-bit values.
+     * @details Values below SUB_BUCKET_COUNT are stored exactly; above that every
+     *          power of two is split into SUB_BUCKET_COUNT / 2 linear buckets, giving
+     *          roughly 6% relative precision over the full 64-bit range.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 5;
+        static constexpr std::uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+        static constexpr std::uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+        static constexpr std::size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+        void Record(std::uint64_t value) noexcept {
+            m_counts[IndexOf(value)].fetch_add(1, std::memory_order_relaxed);
+            m_total.fetch_add(1, std::memory_order_relaxed);
+            std::uint64_t currentMax = m_max.load(std::memory_order_relaxed);
+            while (value > currentMax && !m_max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        /**
+         * @brief Returns the upper bound of the bucket containing the given quantile.
+         * @param quantile Value in [0, 1].
+         */
+        std::uint64_t ValueAtQuantile(double quantile) const noexcept;
+
+        std::uint64_t TotalCount() const noexcept { return m_total.load(std::memory_order_relaxed); }
+        std::uint64_t MaxValue() const noexcept { return m_max.load(std::memory_order_relaxed); }
+
+        void Reset() noexcept;
+
+        static std::size_t IndexOf(std::uint64_t value) noexcept;
+        static std::uint64_t HighestValueAt(std::size_t index) noexcept;
+
+    private:
+        std::atomic<std::uint64_t> m_counts[BUCKET_COUNT] = {};
+        std::atomic<std::uint64_t> m_total{ 0 };
+        std::atomic<std::uint64_t> m_max{ 0 };
+    };
+
+    /**
+     * @brief Records a TSC delta for the given hook.
+     */
+    void Record(HookId hook, std::uint64_t ticks) noexcept;
+
+    /**
+     * @brief Captures the TSC reference point used to convert ticks to nanoseconds.
+     * @details Call once during hook initialization. Conversion accuracy improves as
+     *          more wall time elapses after this call.
+     */
+    void Initialize();
+
+    /**
+     * @brief Refreshes the calls-per-second figures. Run once per second by the control
+     *        loop; calls less than half a second apart are ignored.
+     */
+    void UpdateRates();
+
+    HookStats GetStats(HookId hook);
+
+    /**
+     * @brief Clears all histograms.
+     */
+    void Reset();
+
+    /**
+     * @brief Measures detour overhead from construction until Stop() (or destruction).
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(HookId hook) noexcept : m_hook(hook), m_start(__rdtsc()) {}
+        ~ScopedTimer() { Stop(); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        /**
+         * @brief Records the elapsed ticks once. Call right before the original function.
+         */
+        void Stop() noexcept {
+            if (!m_stopped) {
+                m_stopped = true;
+                Record(m_hook, __rdtsc() - m_start);
+            }
+        }
+
+    private:
+        HookId m_hook;
+        std::uint64_t m_start;
+        bool m_stopped = false;
+    };
+
+#else // KX_ENABLE_HOOK_METRICS
+
+    inline void Initialize() {}
+    inline void UpdateRates() {}
+    inline HookStats GetStats(HookId) { return {}; }
+    inline void Reset() {}
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(HookId) noexcept {}
+        void Stop() noexcept {}
+    };
+
+#endif // KX_ENABLE_HOOK_METRICS
+
+} // namespace kx::HookMetrics
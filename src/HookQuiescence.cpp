@@ -0,0 +1,244 @@
+#include "HookQuiescence.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kx::Quiescence {
+
+    InFlightTracker g_hookTracker;
+
+    namespace {
+
+        constexpr std::chrono::microseconds GRACE_PERIOD{ 1000 };
+        constexpr int SPIN_ITERATIONS = 1000;
+
+        std::mutex s_backgroundMutex;
+        std::condition_variable s_backgroundDone;
+        std::size_t s_backgroundThreads = 0;
+
+        std::atomic<bool> s_stressRunning{ false };
+        std::mutex s_stressResultMutex;
+        std::optional<StressTestResult> s_lastStressResult;
+
+        std::size_t ThreadSlot() {
+            static std::atomic<std::size_t> s_nextSlot{ 0 };
+            thread_local const std::size_t slot = s_nextSlot.fetch_add(1, std::memory_order_relaxed) % InFlightTracker::SLOT_COUNT;
+            return slot;
+        }
+
+        // Waits for the counters to read zero, spinning briefly before sleeping.
+        bool WaitForZero(const InFlightTracker& tracker, std::chrono::steady_clock::time_point deadline) {
+            for (int spins = 0; tracker.InFlight() != 0; ++spins) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+                if (spins < SPIN_ITERATIONS) {
+                    std::this_thread::yield();
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+            return true;
+        }
+
+    } // anonymous namespace
+
+
+    void InFlightTracker::Enter() noexcept {
+        m_slots[ThreadSlot()].count.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    void InFlightTracker::Exit() noexcept {
+        m_slots[ThreadSlot()].count.fetch_sub(1, std::memory_order_release);
+    }
+
+    std::int64_t InFlightTracker::InFlight() const noexcept {
+        std::int64_t total = 0;
+        for (const Slot& slot : m_slots) {
+            total += slot.count.load(std::memory_order_seq_cst);
+        }
+        return total;
+    }
+
+    bool InFlightTracker::WaitForQuiescence(std::chrono::milliseconds timeout) const {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        if (!WaitForZero(*this, deadline)) {
+            return false;
+        }
+        // Grace period for threads between the detour entry and the scope (or the scope
+        // and the return); they cannot start a new body since the hooks are disabled.
+        std::this_thread::sleep_for(GRACE_PERIOD);
+        return WaitForZero(*this, deadline);
+    }
+
+
+    bool StartBackgroundThread(const char* name, std::function<void()> body) {
+        {
+            std::lock_guard<std::mutex> lock(s_backgroundMutex);
+            ++s_backgroundThreads;
+        }
+        try {
+            std::thread([name, body = std::move(body)]() mutable {
+                try {
+                    body();
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "[HookQuiescence] Exception in background thread '" << name << "': " << e.what() << std::endl;
+                }
+                catch (...) {
+                    std::cerr << "[HookQuiescence] Unknown exception in background thread '" << name << "'." << std::endl;
+                }
+                body = nullptr; // Release the captures before the count drops
+
+                std::lock_guard<std::mutex> lock(s_backgroundMutex);
+                --s_backgroundThreads;
+                s_backgroundDone.notify_all();
+            }).detach();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[HookQuiescence] Could not start background thread '" << name << "': " << e.what() << std::endl;
+            std::lock_guard<std::mutex> lock(s_backgroundMutex);
+            --s_backgroundThreads;
+            s_backgroundDone.notify_all();
+            return false;
+        }
+        return true;
+    }
+
+    std::size_t BackgroundThreadCount() {
+        std::lock_guard<std::mutex> lock(s_backgroundMutex);
+        return s_backgroundThreads;
+    }
+
+    bool WaitForBackgroundThreads(std::chrono::milliseconds timeout) {
+        {
+            std::unique_lock<std::mutex> lock(s_backgroundMutex);
+            if (!s_backgroundDone.wait_for(lock, timeout, [] { return s_backgroundThreads == 0; })) {
+                return false;
+            }
+        }
+        // The threads are past their last use of shared state; this covers their return path.
+        std::this_thread::sleep_for(GRACE_PERIOD);
+        return true;
+    }
+
+
+    StressTestResult RunStressTest(const StressTestConfig& config) {
+        InFlightTracker tracker;
+        std::atomic<bool> hookEnabled{ false };  // Simulates the MinHook patch
+        std::atomic<bool> shuttingDown{ true };  // Simulates the shutting-down control bit
+        std::atomic<bool> stateFreed{ false };   // Simulates state torn down after quiescence
+        std::atomic<bool> stop{ false };
+        std::atomic<std::uint64_t> entries{ 0 };
+        std::atomic<std::uint64_t> violations{ 0 };
+
+        StressTestResult result;
+        result.producerThreads = std::max(1u, config.producerThreads);
+
+        std::vector<std::thread> producers;
+        for (unsigned t = 0; t < result.producerThreads; ++t) {
+            producers.emplace_back([&]() {
+                std::uint64_t localEntries = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    if (!hookEnabled.load(std::memory_order_relaxed)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    InFlightScope scope(tracker);
+                    if (!shuttingDown.load(std::memory_order_acquire)) {
+                        ++localEntries;
+                        // The body "uses" shared state twice, with some work in between.
+                        if (stateFreed.load(std::memory_order_relaxed)) violations.fetch_add(1, std::memory_order_relaxed);
+                        for (volatile int spin = 0; spin < 64; ++spin) {}
+                        if (stateFreed.load(std::memory_order_relaxed)) violations.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                entries.fetch_add(localEntries, std::memory_order_relaxed);
+            });
+        }
+
+        double totalDrainUs = 0.0;
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.durationMs);
+        while (std::chrono::steady_clock::now() < end) {
+            stateFreed = false;
+            shuttingDown = false;
+            hookEnabled = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            // The shutdown protocol under test.
+            const auto start = std::chrono::steady_clock::now();
+            shuttingDown.store(true, std::memory_order_seq_cst);
+            hookEnabled = false;
+            const bool quiescent = tracker.WaitForQuiescence(std::chrono::milliseconds(1000));
+            const double drainUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+            if (!quiescent) {
+                ++result.timeouts;
+                continue;
+            }
+            stateFreed = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(200)); // Any body still running now would be a bug
+
+            ++result.shutdownCycles;
+            totalDrainUs += drainUs;
+            result.maxDrainUs = std::max(result.maxDrainUs, drainUs);
+        }
+
+        stop = true;
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        result.bodyEntries = entries.load();
+        result.violations = violations.load();
+        if (result.shutdownCycles > 0) {
+            result.meanDrainUs = totalDrainUs / static_cast<double>(result.shutdownCycles);
+        }
+        return result;
+    }
+
+    bool StartStressTestAsync(const StressTestConfig& config) {
+        bool expected = false;
+        if (!s_stressRunning.compare_exchange_strong(expected, true)) {
+            return false;
+        }
+
+        const bool started = StartBackgroundThread("stress-test", [config]() {
+            try {
+                StressTestResult result = RunStressTest(config);
+                std::cout << "[HookQuiescence] Stress test: " << result.shutdownCycles << " cycles, "
+                    << result.violations << " violations, " << result.timeouts << " timeouts." << std::endl;
+                std::lock_guard<std::mutex> lock(s_stressResultMutex);
+                s_lastStressResult = result;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[HookQuiescence] Exception: " << e.what() << std::endl;
+            }
+            catch (...) {
+                std::cerr << "[HookQuiescence] Unknown exception." << std::endl;
+            }
+            s_stressRunning = false;
+        });
+        if (!started) {
+            s_stressRunning = false;
+        }
+        return started;
+    }
+
+    bool IsStressTestRunning() {
+        return s_stressRunning.load();
+    }
+
+    std::optional<StressTestResult> GetLastStressTestResult() {
+        std::lock_guard<std::mutex> lock(s_stressResultMutex);
+        return s_lastStressResult;
+    }
+
+} // namespace kx::Quiescence
@@ -0,0 +1,136 @@
+#pragma once
+
+/**
+ * @file HookQuiescence.h
+ * @brief In-flight tracking for the detours so unload can wait until they are quiescent.
+ * @details Every detour body runs inside an InFlightScope on g_hookTracker. Entering
+ *          increments a per-thread counter slot (slots are cache-line sized so the send,
+ *          receive and render threads do not contend), then the detour checks the capture
+ *          control word. Shutdown sets the shutting-down bit, disables the hooks, then calls
+ *          WaitForQuiescence(). A detour that misses the bit is still counted and waited for;
+ *          the bit only saves it the work. The few instructions before the scope opens and
+ *          after it closes are covered by a short grace period once the count reaches zero.
+ *
+ *          Threads the DLL starts itself (search workers, background decryption, benchmarks,
+ *          self-tests, freeing a cleared log) are started with StartBackgroundThread(). Shutdown asks their owners
+ *          to stop, then waits for them with WaitForBackgroundThreads() before ejecting.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace kx::Quiescence {
+
+    class InFlightTracker {
+    public:
+        static constexpr std::size_t SLOT_COUNT = 16;
+
+        void Enter() noexcept;
+        void Exit() noexcept;
+
+        /**
+         * @brief Number of threads currently inside a scope. Exact once no new scopes can open.
+         */
+        std::int64_t InFlight() const noexcept;
+
+        /**
+         * @brief Blocks until InFlight() stays zero for the grace period, or the timeout expires.
+         * @return True if quiescent.
+         */
+        bool WaitForQuiescence(std::chrono::milliseconds timeout) const;
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<std::int64_t> count{ 0 };
+        };
+        Slot m_slots[SLOT_COUNT];
+    };
+
+    /**
+     * @brief RAII guard for one detour invocation. Declare it first in the detour so it
+     *        closes last.
+     */
+    class InFlightScope {
+    public:
+        explicit InFlightScope(InFlightTracker& tracker) noexcept : m_tracker(tracker) { m_tracker.Enter(); }
+        ~InFlightScope() { m_tracker.Exit(); }
+
+        InFlightScope(const InFlightScope&) = delete;
+        InFlightScope& operator=(const InFlightScope&) = delete;
+
+    private:
+        InFlightTracker& m_tracker;
+    };
+
+    // Tracks the MsgSend, MsgRecv and Present detours.
+    extern InFlightTracker g_hookTracker;
+
+    constexpr std::chrono::milliseconds SHUTDOWN_QUIESCENCE_TIMEOUT{ 5000 };
+
+    // --- Background threads ---
+
+    // Long enough for a self-test or a benchmark suite that is not cancellable to finish.
+    constexpr std::chrono::milliseconds BACKGROUND_SHUTDOWN_TIMEOUT{ 30000 };
+
+    /**
+     * @brief Runs `body` on a detached thread that WaitForBackgroundThreads() accounts for.
+     *        Exceptions escaping `body` are logged. Thread-safe.
+     * @param name Short label used in error messages.
+     * @return False if the thread could not be started (logged); `body` has not run then.
+     */
+    bool StartBackgroundThread(const char* name, std::function<void()> body);
+
+    /**
+     * @brief Number of background threads whose body has not returned yet.
+     */
+    std::size_t BackgroundThreadCount();
+
+    /**
+     * @brief Blocks until every background thread has returned, or the timeout expires.
+     *        Ask their owners to stop first (CancelSearch(), RequestStop(), ...).
+     * @return True if none is left, after the same grace period as WaitForQuiescence().
+     */
+    bool WaitForBackgroundThreads(std::chrono::milliseconds timeout);
+
+    // --- Stress test ---
+
+    struct StressTestConfig {
+        unsigned producerThreads = 16;
+        int durationMs = 2000;
+    };
+
+    /**
+     * @brief Result of a stress run. `violations` must be zero.
+     */
+    struct StressTestResult {
+        unsigned producerThreads = 0;
+        std::uint64_t shutdownCycles = 0;  // Enable -> shut down -> wait -> "free" cycles completed
+        std::uint64_t bodyEntries = 0;     // Simulated detour bodies that did work
+        std::uint64_t violations = 0;      // Bodies that saw the shared state after it was "freed"
+        std::uint64_t timeouts = 0;        // Cycles where quiescence was not reached in time
+        double meanDrainUs = 0.0;          // Time from shutdown signal to quiescence
+        double maxDrainUs = 0.0;
+    };
+
+    /**
+     * @brief Runs the shutdown protocol repeatedly against many producer threads that
+     *        simulate detours, on a private tracker. Portable (std::thread only); also
+     *        built on its own under ThreadSanitizer by tests/CMakeLists.txt.
+     */
+    StressTestResult RunStressTest(const StressTestConfig& config);
+
+    /**
+     * @brief Starts RunStressTest on a background thread (see StartBackgroundThread()).
+     * @return False if a run is already in progress or the thread could not be started.
+     */
+    bool StartStressTestAsync(const StressTestConfig& config);
+
+    bool IsStressTestRunning();
+
+    std::optional<StressTestResult> GetLastStressTestResult();
+
+} // namespace kx::Quiescence
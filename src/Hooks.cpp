@@ -2,6 +2,7 @@
 #include "AppState.h"        // For setting status flags
 #include "Config.h"          // For patterns/process name
 #include "PatternScanner.h"  // For finding game functions
+#include "HookMetrics.h"     // For detour overhead instrumentation
 #include <iostream>          // Replace with logging
 
 namespace kx {
@@ -110,6 +111,7 @@ namespace kx {
         // Status g_presentHookStatus is set inside D3DRenderHook::Initialize
 
         // 3. Initialize Game-Specific Hooks (MsgSend, MsgRecv)
+        kx::HookMetrics::Initialize(); // Reference point for detour latency measurements
         // We consider these non-fatal for now if they fail (e.g., pattern not found)
         GameHooks::InitializeMsgSendHook();
         GameHooks::InitializeMsgRecvHook();
@@ -133,4 +135,11 @@ namespace kx {
         std::cout << "[Hooks] Cleanup finished." << std::endl;
     }
 
+    void DetachHooksInFlight() {
+        // The hooks were disabled before waiting. Uninitializing MinHook would free the
+        // trampolines the in-flight detours still call the originals through.
+        kx::Hooking::D3DRenderHook::RestoreWndProc();
+        std::cout << "[Hooks] Detours still in flight; left hooks disabled and overlay state alive." << std::endl;
+    }
+
 } // namespace kx
\ No newline at end of file
@@ -38,4 +38,12 @@ namespace kx {
      */
     void CleanupHooks();
 
+    /**
+     * @brief Shutdown path for when detours did not become quiescent. The hooks stay
+     *        disabled, but MinHook's trampolines, the original function pointers, ImGui and
+     *        the D3D resources are left alive for the detours still running; only the
+     *        WndProc subclass is undone.
+     */
+    void DetachHooksInFlight();
+
 } // namespace kx
\ No newline at end of file
@@ -3,12 +3,34 @@
 #include "../ImGui/imgui_impl_win32.h"
 #include "../ImGui/imgui_impl_dx11.h"
 #include "PacketData.h" // Include for PacketInfo, g_packetLog, g_packetLogMutex
+#include "PacketMetadata.h"
+#include "PacketStaging.h"
 #include "AppState.h"   // Include for UI state, filter state, hook status
+#include "CaptureControl.h"
+#include "CapturePolicy.h"
 #include "GuiStyle.h"  // Include for custom styling functions
 #include "FormattingUtils.h"
 #include "FilterUtils.h"
+#include "FilterExpression.h"
+#include "FilteredView.h"
+#include "FrameBudget.h"
 #include "PacketHeaders.h" // Need this for iterating known headers
 #include "Config.h"
+#include "Benchmark.h"
+#include "UiBenchmark.h"
+#include "UiRefresh.h"
+#include "TrafficGenerator.h"
+#include "HookMetrics.h"
+#include "PacketStatistics.h"
+#include "TrafficTimeSeries.h"
+#include "TrafficTimeline.h"
+#include "TimelineView.h"
+#include "PayloadSearch.h"
+#include "LazyDecryption.h"
+#include "PacketLogView.h"
+#include "HexDumpView.h"
+#include "ControlLoop.h"
+#include "HookQuiescence.h"
 
 #include <vector>
 #include <mutex>
@@ -48,6 +70,14 @@ void ImGuiManager::Render(ID3D11DeviceContext* context, ID3D11RenderTargetView*
     ImGui::Render();
     context->OMSetRenderTargets(1, &mainRenderTargetView, NULL);
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    kx::UiRefresh::StoreFrame(ImGui::GetDrawData());
+}
+
+void ImGuiManager::RenderCachedFrame(ID3D11DeviceContext* context, ID3D11RenderTargetView* mainRenderTargetView) {
+    if (ImDrawData* drawData = kx::UiRefresh::GetCachedFrame()) {
+        context->OMSetRenderTargets(1, &mainRenderTargetView, NULL);
+        ImGui_ImplDX11_RenderDrawData(drawData);
+    }
 }
 
 
@@ -128,15 +158,147 @@ void ImGuiManager::RenderStatusControlsSection() {
             ImGui::Text("MsgRecv Address: N/A"); // Placeholder display
         }
 
+#if KX_ENABLE_HOOK_METRICS
+        ImGui::Separator();
+
+        // Detour overhead (entry -> original call), see HookMetrics.h. Rates are rolled up
+        // once per second by the control loop.
+        const struct { const char* label; kx::HookMetrics::HookId id; } hooks[] = {
+            { "MsgSend", kx::HookMetrics::HookId::MsgSend },
+            { "MsgRecv", kx::HookMetrics::HookId::MsgRecv },
+        };
+        for (const auto& hook : hooks) {
+            kx::HookMetrics::HookStats stats = kx::HookMetrics::GetStats(hook.id);
+            ImGui::Text("%s Overhead: p50 %.0f ns | p99 %.0f ns | max %.0f ns | %.0f pkt/s",
+                hook.label, stats.p50Ns, stats.p99Ns, stats.maxNs, stats.callsPerSecond);
+        }
+        if (ImGui::SmallButton("Reset Hook Metrics")) {
+            kx::HookMetrics::Reset();
+        }
+#endif // KX_ENABLE_HOOK_METRICS
+
+        ImGui::Separator();
+
+        // Time spent building this window per frame, see FrameBudget.h.
+        float budgetMs = static_cast<float>(kx::FrameBudget::GetBudgetMs());
+        ImGui::SetNextItemWidth(160.0f);
+        if (ImGui::SliderFloat("UI Frame Budget", &budgetMs, 0.1f, 5.0f, "%.2f ms")) {
+            kx::FrameBudget::SetBudgetMs(budgetMs);
+        }
+        const kx::FrameBudget::Stats budgetStats = kx::FrameBudget::GetStats();
+        ImGui::Text("UI Frame: last %.3f ms | max %.3f ms | overruns %llu / %llu (last +%.3f ms) | deferred %llu",
+            budgetStats.lastFrameMs, budgetStats.maxFrameMs,
+            static_cast<unsigned long long>(budgetStats.overrunFrames), static_cast<unsigned long long>(budgetStats.frames),
+            budgetStats.lastOverrunMs, static_cast<unsigned long long>(budgetStats.deferredFrames));
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset Frame Stats")) {
+            kx::FrameBudget::ResetStats();
+            kx::UiRefresh::ResetStats();
+        }
+
+        // Rebuild the window at a capped rate and replay it in between, see UiRefresh.h.
+        bool capRebuildRate = kx::UiRefresh::GetRateCapHz() > 0;
+        if (ImGui::Checkbox("Cap UI Rebuild Rate", &capRebuildRate)) {
+            kx::UiRefresh::SetRateCapHz(capRebuildRate ? kx::UiRefresh::DEFAULT_RATE_HZ : 0);
+        }
+        if (capRebuildRate) {
+            ImGui::SameLine();
+            int rateHz = kx::UiRefresh::GetRateCapHz();
+            ImGui::SetNextItemWidth(120.0f);
+            if (ImGui::SliderInt("##RebuildRate", &rateHz, 5, 120, "%d Hz")) {
+                kx::UiRefresh::SetRateCapHz(rateHz);
+            }
+            const kx::UiRefresh::Stats refreshStats = kx::UiRefresh::GetStats();
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%llu rebuilt, %llu replayed)",
+                static_cast<unsigned long long>(refreshStats.rebuiltFrames), static_cast<unsigned long long>(refreshStats.replayedFrames));
+        }
+
         ImGui::Separator();
 
         // Controls content
+        // While a self-test runs on a private log (see IsolatedPacketLog), it owns the pause
+        // state and the log.
+        const bool logIsolated = kx::IsolatedPacketLog::IsActive();
+        if (logIsolated) {
+            ImGui::BeginDisabled();
+        }
         if (ImGui::Button("Clear Log")) {
             std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
-            kx::g_packetLog.clear();
+            kx::ClearPacketLog(); // Swaps the storage out; it is freed in the background
+            kx::Decryption::Reset();
+            kx::Statistics::Reset();
+            kx::Staging::ResetStats();
+            kx::TimeSeries::Reset();
+            kx::Timeline::Reset();
+            kx::TimelineView::Reset();
+            kx::Search::CancelSearch();
+            kx::LogView::ClearSelection();
+            kx::HexView::Reset();
+            kx::FilteredView::Reset();
+        }
+        ImGui::SameLine();
+        bool capturePaused = kx::Capture::g_captureControl.IsSet(kx::Capture::CONTROL_PAUSED);
+        if (ImGui::Checkbox("Pause Capture", &capturePaused)) {
+            kx::Capture::g_captureControl.Set(kx::Capture::CONTROL_PAUSED, capturePaused);
+        }
+        if (logIsolated) {
+            ImGui::EndDisabled();
+            if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+                ImGui::SetTooltip("A load test is logging into a private log; live capture resumes when it ends.");
+            }
+        }
+        ImGui::SameLine();
+        bool lazyDecryption = kx::Capture::g_captureControl.IsSet(kx::Capture::CONTROL_LAZY_DECRYPTION);
+        if (ImGui::Checkbox("Decrypt on Demand", &lazyDecryption)) {
+            kx::Capture::g_captureControl.Set(kx::Capture::CONTROL_LAZY_DECRYPTION, lazyDecryption);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Store received payloads encrypted and decrypt them when shown, searched or filtered.");
         }
         ImGui::SameLine();
-        ImGui::Checkbox("Pause Capture", &kx::g_capturePaused);
+        bool batching = kx::Staging::IsBatchingEnabled();
+        if (ImGui::Checkbox("Batch Publication", &batching)) {
+            kx::Staging::SetBatchingEnabled(batching);
+        }
+        if (ImGui::IsItemHovered()) {
+            const kx::Staging::Stats staging = kx::Staging::GetStats();
+            ImGui::SetTooltip("Stage packets per capture thread and add them to the log once per frame\n"
+                "(or %lld ms after the first staged packet while the overlay is not rendering).\n"
+                "%llu batches, %.1f packets per batch, %zu staging buffers.",
+                static_cast<long long>(kx::Staging::FLUSH_INTERVAL.count()),
+                static_cast<unsigned long long>(staging.batches),
+                staging.batches > 0 ? static_cast<double>(staging.packets) / static_cast<double>(staging.batches) : 0.0,
+                staging.threads);
+        }
+
+        // Capture policy (see CapturePolicy.h); evaluated in the detours before packets are copied.
+        if (ImGui::TreeNode("Capture Policy")) {
+            kx::Capture::CapturePolicy policy = kx::Capture::GetCapturePolicy();
+            int sampleEvery = static_cast<int>(policy.sampleEvery);
+            int maxPerSecond = static_cast<int>(policy.maxPerSecondPerOpcode);
+            int headerOnlyBytes = static_cast<int>(policy.headerOnlyBytes);
+            bool changed = false;
+            changed |= ImGui::SliderInt("Keep 1 in N", &sampleEvery, 1, 1000, "%d", ImGuiSliderFlags_Logarithmic);
+            changed |= ImGui::SliderInt("Max/s per Opcode (0 = off)", &maxPerSecond, 0, 1000);
+            changed |= ImGui::SliderInt("Header Bytes Only (0 = off)", &headerOnlyBytes, 0, 64);
+            changed |= ImGui::Checkbox("Only Opcodes Shown by Header Filter", &policy.includedOpcodesOnly);
+            if (changed) {
+                kx::Filtering::PublishCaptureOpcodes(); // Current before the detours use them
+                policy.sampleEvery = static_cast<std::uint32_t>(std::max(1, sampleEvery));
+                policy.maxPerSecondPerOpcode = static_cast<std::uint32_t>(std::max(0, maxPerSecond));
+                policy.headerOnlyBytes = static_cast<std::uint32_t>(std::max(0, headerOnlyBytes));
+                kx::Capture::SetCapturePolicy(policy);
+            }
+            if (ImGui::SmallButton("Capture Everything")) {
+                kx::Capture::SetCapturePolicy(kx::Capture::CapturePolicy{});
+            }
+            if (!policy.CapturesEverything()) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("Skipped packets are listed in the Statistics section.");
+            }
+            ImGui::TreePop();
+        }
         ImGui::Spacing();
     }
 }
@@ -216,66 +378,467 @@ void ImGuiManager::RenderFilteringSection() {
             ImGui::Unindent();
             ImGui::EndChild();
         }
+
+        // --- Expression Filter (applied on top of the checkboxes) ---
+        ImGui::Separator();
+        static char expressionBuffer[512] = "";
+        static std::string expressionError;
+        static bool showBytecode = false;
+
+        ImGui::Text("Expression:");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Fields: dir (S/R), hdr, len, state, u8@N, u16@N, u32@N, bytes\n"
+                "Operators: == != < <= > >=, in {a,b}, bytes contains \"41 ?? 42\" / 'text' / u'text'\n"
+                "Combine with && || ! and parentheses.\n"
+                "Example: dir==S && hdr in {0x12,0x0B} && len>20");
+        }
+        ImGui::SameLine();
+        ImGui::PushItemWidth(-120.0f);
+        bool applyExpression = ImGui::InputText("##FilterExpression", expressionBuffer, sizeof(expressionBuffer), ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::PopItemWidth();
+        ImGui::SameLine();
+        if (ImGui::Button("Apply##Expr") || applyExpression) {
+            if (expressionBuffer[0] == '\0') {
+                kx::Filtering::SetActiveFilterExpression(nullptr);
+                expressionError.clear();
+            }
+            else if (auto compiled = kx::Filtering::CompileFilterExpression(expressionBuffer, expressionError)) {
+                kx::Filtering::SetActiveFilterExpression(compiled);
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear##Expr")) {
+            expressionBuffer[0] = '\0';
+            expressionError.clear();
+            kx::Filtering::SetActiveFilterExpression(nullptr);
+        }
+
+        if (!expressionError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", expressionError.c_str());
+        }
+        if (auto active = kx::Filtering::GetActiveFilterExpression()) {
+            ImGui::TextDisabled("Active: %s (%zu instructions)", active->SourceText().c_str(), active->InstructionCount());
+            ImGui::SameLine();
+            ImGui::Checkbox("Show bytecode", &showBytecode);
+            if (showBytecode) {
+                ImGui::TextUnformatted(active->Disassemble().c_str());
+            }
+        }
         ImGui::Spacing();
     }
     ImGui::Spacing();
 }
 
-void ImGuiManager::RenderPacketLogSection() {
-    ImGui::Text("Packet Log:");
-    ImGui::Separator();
-    ImGui::BeginChild("PacketLogScrollingRegion", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+void ImGuiManager::RenderPayloadSearchSection() {
+    if (ImGui::CollapsingHeader("Payload Search")) {
+        static char patternBuffer[256] = "";
+        static std::string searchError;
 
-    // Get indices of packets that pass current filters.
-    std::vector<int> filtered_indices;
-    {
-        std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
-        filtered_indices = kx::Filtering::GetFilteredPacketIndices(kx::g_packetLog);
+        ImGui::TextDisabled("Bytes: 0A ? FF 12   ASCII: \"text\"   UTF-16LE: u\"text\"");
+        ImGui::PushItemWidth(-160.0f);
+        bool submitted = ImGui::InputText("##SearchPattern", patternBuffer, sizeof(patternBuffer), ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::PopItemWidth();
+        ImGui::SameLine();
+        if (ImGui::Button("Search") || submitted) {
+            if (kx::Search::StartSearch(patternBuffer, searchError)) {
+                kx::g_showSearchMatchesOnly = true;
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear##Search")) {
+            kx::Search::CancelSearch();
+            kx::g_showSearchMatchesOnly = false;
+            searchError.clear();
+        }
+
+        if (!searchError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", searchError.c_str());
+        }
+
+        kx::Search::SearchProgress progress = kx::Search::GetProgress();
+        if (progress.active) {
+            float fraction = progress.totalPackets > 0 ? static_cast<float>(progress.scannedPackets) / static_cast<float>(progress.totalPackets) : 1.0f;
+            char overlay[96];
+            snprintf(overlay, sizeof(overlay), "%zu / %zu packets", progress.scannedPackets, progress.totalPackets);
+            ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+            ImGui::Text("%s: %zu matches in %.1f ms", progress.running ? "Searching" : "Done", progress.matchCount, progress.elapsedMs);
+            ImGui::Checkbox("Show only matches in Packet Log", &kx::g_showSearchMatchesOnly);
+        }
+        ImGui::Spacing();
     }
+}
 
-    // Use clipper for efficient rendering of visible items.
-    ImGuiListClipper clipper;
-    clipper.Begin(filtered_indices.size());
-    while (clipper.Step()) {
-        std::lock_guard<std::mutex> lock(kx::g_packetLogMutex); // Lock for accessing packet data
+void ImGuiManager::RenderStatisticsSection() {
+    if (ImGui::CollapsingHeader("Statistics")) {
+        std::vector<kx::Statistics::OpcodeStats> rows = kx::Statistics::GetSnapshot(std::chrono::system_clock::now());
 
-        for (int display_index = clipper.DisplayStart; display_index < clipper.DisplayEnd; ++display_index) {
-            if (display_index < 0 || display_index >= filtered_indices.size()) continue;
-            int original_index = filtered_indices[display_index];
+        enum StatsColumn { Col_Dir, Col_Opcode, Col_Name, Col_Count, Col_Skipped, Col_Bytes, Col_Rate1s, Col_Rate10s, Col_Rate60s, Col_MinSize, Col_MeanSize, Col_MaxSize, Col_InterArrival, Col_Count_ };
+        const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg
+            | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit;
 
-            if (original_index < 0 || original_index >= kx::g_packetLog.size()) continue;
-            const auto& packet = kx::g_packetLog[original_index];
+        if (rows.empty()) {
+            ImGui::TextDisabled("No packets captured yet.");
+        }
+        else if (ImGui::BeginTable("OpcodeStatistics", Col_Count_, flags, ImVec2(0.0f, 220.0f))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Dir", ImGuiTableColumnFlags_None, 0.0f, Col_Dir);
+            ImGui::TableSetupColumn("Opcode", ImGuiTableColumnFlags_None, 0.0f, Col_Opcode);
+            ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_None, 0.0f, Col_Name);
+            ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Col_Count);
+            ImGui::TableSetupColumn("Skipped", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Col_Skipped);
+            ImGui::TableSetupColumn("Bytes", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Col_Bytes);
+            ImGui::TableSetupColumn("1s/s", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Col_Rate1s);
+            ImGui::TableSetupColumn("10s/s", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Col_Rate10s);
+            ImGui::TableSetupColumn("60s/s", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, Col_Rate60s);
+            ImGui::TableSetupColumn("Min", ImGuiTableColumnFlags_None, 0.0f, Col_MinSize);
+            ImGui::TableSetupColumn("Mean", ImGuiTableColumnFlags_None, 0.0f, Col_MeanSize);
+            ImGui::TableSetupColumn("Max", ImGuiTableColumnFlags_None, 0.0f, Col_MaxSize);
+            ImGui::TableSetupColumn("Mean dt (ms)", ImGuiTableColumnFlags_None, 0.0f, Col_InterArrival);
+            ImGui::TableHeadersRow();
+
+            // Sort the (small, <= 512 rows) snapshot by the current sort specs.
+            if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs()) {
+                auto compareBy = [](const kx::Statistics::OpcodeStats& a, const kx::Statistics::OpcodeStats& b, ImGuiID column) -> int {
+                    auto cmp = [](auto x, auto y) { return (x < y) ? -1 : (x > y) ? 1 : 0; };
+                    switch (column) {
+                        case Col_Dir:          return cmp(static_cast<int>(a.direction), static_cast<int>(b.direction));
+                        case Col_Opcode:       return cmp(a.headerId, b.headerId);
+                        case Col_Name:         return kx::GetPacketName(a.direction, a.headerId).compare(kx::GetPacketName(b.direction, b.headerId));
+                        case Col_Count:        return cmp(a.count, b.count);
+                        case Col_Skipped:      return cmp(a.skipped, b.skipped);
+                        case Col_Bytes:        return cmp(a.bytes, b.bytes);
+                        case Col_Rate1s:       return cmp(a.rate1s, b.rate1s);
+                        case Col_Rate10s:      return cmp(a.rate10s, b.rate10s);
+                        case Col_Rate60s:      return cmp(a.rate60s, b.rate60s);
+                        case Col_MinSize:      return cmp(a.minSize, b.minSize);
+                        case Col_MeanSize:     return cmp(a.meanSize, b.meanSize);
+                        case Col_MaxSize:      return cmp(a.maxSize, b.maxSize);
+                        case Col_InterArrival: return cmp(a.meanInterArrivalMs, b.meanInterArrivalMs);
+                        default:               return 0;
+                    }
+                };
+                std::stable_sort(rows.begin(), rows.end(), [&](const auto& a, const auto& b) {
+                    for (int n = 0; n < sortSpecs->SpecsCount; ++n) {
+                        const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[n];
+                        int delta = compareBy(a, b, spec.ColumnUserID);
+                        if (delta != 0) {
+                            return (spec.SortDirection == ImGuiSortDirection_Ascending) ? delta < 0 : delta > 0;
+                        }
+                    }
+                    return false;
+                });
+                sortSpecs->SpecsDirty = false;
+            }
 
-            // Generate display string (potentially truncated hex).
-            std::string displayLogEntry = kx::Utils::FormatDisplayLogEntryString(packet);
+            for (const auto& row : rows) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(row.direction == kx::PacketDirection::Sent ? "[S]" : "[R]");
+                ImGui::TableNextColumn(); ImGui::Text("0x%02X", row.headerId);
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(kx::GetPacketName(row.direction, row.headerId).c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(row.count));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(row.skipped));
+                ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(row.bytes));
+                ImGui::TableNextColumn(); ImGui::Text("%.0f", row.rate1s);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", row.rate10s);
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", row.rate60s);
+                ImGui::TableNextColumn(); ImGui::Text("%u", row.minSize);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", row.meanSize);
+                ImGui::TableNextColumn(); ImGui::Text("%u", row.maxSize);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", row.meanInterArrivalMs);
+            }
+            ImGui::EndTable();
+        }
+        ImGui::Spacing();
+    }
+}
+
+namespace {
+
+    // Draws one rate series with the latest and peak values as the overlay text.
+    void PlotRateSeries(const char* label, const std::vector<float>& values, const char* unit) {
+        float peak = values.empty() ? 0.0f : *std::max_element(values.begin(), values.end());
+        float latest = values.empty() ? 0.0f : values.back();
+        char overlay[96];
+        snprintf(overlay, sizeof(overlay), "%s: %.0f %s (peak %.0f)", label, latest, unit, peak);
+        ImGui::PushID(label);
+        ImGui::PlotLines("##Rate", values.data(), static_cast<int>(values.size()), 0, overlay, 0.0f, peak > 0.0f ? peak * 1.1f : 1.0f, ImVec2(-1.0f, 50.0f));
+        ImGui::PopID();
+    }
+
+} // anonymous namespace
+
+void ImGuiManager::RenderTrafficGraphsSection() {
+    if (ImGui::CollapsingHeader("Traffic Graphs")) {
+        static int resolution = 0; // 0 = 1 Hz / 1 h, 1 = 10 Hz / 5 min
+        ImGui::RadioButton("1 Hz (last hour)", &resolution, 0); ImGui::SameLine();
+        ImGui::RadioButton("10 Hz (last 5 min)", &resolution, 1);
+
+        const auto now = std::chrono::system_clock::now();
+        const auto seriesResolution = resolution == 0 ? kx::TimeSeries::Resolution::Coarse : kx::TimeSeries::Resolution::Fine;
+        const kx::PacketDirection directions[] = { kx::PacketDirection::Sent, kx::PacketDirection::Received };
+        for (kx::PacketDirection direction : directions) {
+            kx::TimeSeries::Series series = kx::TimeSeries::GetDirectionSeries(direction, seriesResolution, now);
+            const bool sent = direction == kx::PacketDirection::Sent;
+            PlotRateSeries(sent ? "Sent pkt/s" : "Recv pkt/s", series.packetsPerSecond, "pkt/s");
+            PlotRateSeries(sent ? "Sent B/s" : "Recv B/s", series.bytesPerSecond, "B/s");
+        }
 
-            ImGui::PushID(original_index);
+        // Per-opcode graph (1 Hz, last 5 minutes); the selector lists opcodes seen so far.
+        ImGui::SeparatorText("Per Opcode");
+        static kx::PacketDirection selectedDirection = kx::PacketDirection::Sent;
+        static int selectedHeader = -1;
+        std::vector<kx::Statistics::OpcodeStats> seen = kx::Statistics::GetSnapshot(now);
+
+        auto describe = [](kx::PacketDirection direction, int header) {
+            char text[96];
+            snprintf(text, sizeof(text), "[%s] 0x%02X %s", direction == kx::PacketDirection::Sent ? "S" : "R",
+                header, kx::GetPacketName(direction, static_cast<std::uint8_t>(header)).c_str());
+            return std::string(text);
+        };
+
+        std::string preview = selectedHeader < 0 ? std::string("Select opcode...") : describe(selectedDirection, selectedHeader);
+        if (ImGui::BeginCombo("Opcode", preview.c_str())) {
+            for (const auto& entry : seen) {
+                bool isSelected = entry.direction == selectedDirection && entry.headerId == selectedHeader;
+                if (ImGui::Selectable(describe(entry.direction, entry.headerId).c_str(), isSelected)) {
+                    selectedDirection = entry.direction;
+                    selectedHeader = entry.headerId;
+                }
+            }
+            ImGui::EndCombo();
+        }
 
-            // Display read-only text.
-            float buttonWidth = ImGui::CalcTextSize("Copy").x + ImGui::GetStyle().FramePadding.x * 2.0f + ImGui::GetStyle().ItemSpacing.x;
-            ImGui::PushItemWidth(-buttonWidth);
-            ImGui::InputText("##Pkt", (char*)displayLogEntry.c_str(), displayLogEntry.size() + 1, ImGuiInputTextFlags_ReadOnly);
-            ImGui::PopItemWidth();
+        if (selectedHeader >= 0) {
+            kx::TimeSeries::Series series = kx::TimeSeries::GetOpcodeSeries(selectedDirection, static_cast<std::uint8_t>(selectedHeader), now);
+            PlotRateSeries("Opcode pkt/s", series.packetsPerSecond, "pkt/s");
+            PlotRateSeries("Opcode B/s", series.bytesPerSecond, "B/s");
+        }
 
+        // Whole-session density per opcode, zoomable down to milliseconds.
+        ImGui::SeparatorText("Session Timeline");
+        kx::TimelineView::Render();
+        ImGui::Spacing();
+    }
+}
+
+void ImGuiManager::RenderDiagnosticsSection() {
+    if (ImGui::CollapsingHeader("Diagnostics")) {
+        ImGui::Text("Filter kernel: %s", kx::Filtering::GetFilterKernelName(kx::Filtering::DetectFilterKernel()));
+        {
+            std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
+            ImGui::Text("RC4 snapshots: %zu (%zu keyframes, %.1f KB)", kx::g_rc4Snapshots.Size(),
+                kx::g_rc4Snapshots.KeyframeCount(), static_cast<double>(kx::g_rc4Snapshots.MemoryBytes()) / 1024.0);
+            kx::Decryption::CacheStats cache = kx::Decryption::GetCacheStats();
+            ImGui::Text("Plaintext cache: %zu entries, %.1f KB (hits %llu, misses %llu)", cache.entries,
+                static_cast<double>(cache.bytes) / 1024.0, static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.misses));
+        }
+
+        // --- Micro-benchmarks ---
+        bool benchmarkRunning = kx::Benchmark::IsRunning();
+        if (benchmarkRunning) {
+            ImGui::BeginDisabled();
+        }
+        if (ImGui::Button("Run Benchmarks")) {
+            kx::Benchmark::StartAsync();
+        }
+        if (benchmarkRunning) {
+            ImGui::EndDisabled();
             ImGui::SameLine();
+            ImGui::TextDisabled("Running...");
+        }
+        else {
+            ImGui::SameLine();
+            ImGui::TextDisabled("Results: %s, %s", kx::Benchmark::RESULTS_JSON_FILE, kx::Benchmark::RESULTS_CSV_FILE);
+        }
+
+        std::vector<kx::Benchmark::BenchmarkResult> results = kx::Benchmark::GetLastResults();
+        if (!results.empty() && ImGui::BeginTable("BenchmarkResults", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Function");
+            ImGui::TableSetupColumn("Input");
+            ImGui::TableSetupColumn("ns/op");
+            ImGui::TableSetupColumn("MB/s");
+            ImGui::TableSetupColumn("B/item");
+            ImGui::TableHeadersRow();
+            for (const auto& r : results) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(r.name.c_str());
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(r.distribution.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", r.nsPerOp);
+                ImGui::TableNextColumn();
+                if (r.mbPerSec > 0.0) ImGui::Text("%.1f", r.mbPerSec); else ImGui::TextDisabled("-");
+                ImGui::TableNextColumn();
+                if (r.bytesPerItem > 0.0) ImGui::Text("%.1f", r.bytesPerItem); else ImGui::TextDisabled("-");
+            }
+            ImGui::EndTable();
+        }
+
+        // --- Headless UI benchmark (runs between two game frames, see UiBenchmark.h) ---
+        ImGui::Separator();
+        ImGui::Text("UI Benchmark (overlay rendered headlessly over a synthetic log):");
+        static int uiBenchmarkRows = 100000;
+        static int uiBenchmarkFrames = 240;
+        static int uiBenchmarkRebuildHz = 0;
+        ImGui::SliderInt("Rows", &uiBenchmarkRows, 1000, 1000000, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("Frames", &uiBenchmarkFrames, 10, 1000);
+        ImGui::SliderInt("Rebuild Rate (0 = every frame, 144 Hz game)", &uiBenchmarkRebuildHz, 0, 120, "%d Hz");
+        if (kx::Benchmark::IsUiBenchmarkPending()) {
+            ImGui::TextDisabled("Queued for the next frame...");
+        }
+        else if (ImGui::Button("Run UI Benchmark")) {
+            kx::Benchmark::UiBenchmarkConfig uiConfig;
+            uiConfig.rows = static_cast<std::size_t>(uiBenchmarkRows);
+            uiConfig.frames = uiBenchmarkFrames;
+            uiConfig.rebuildRateHz = uiBenchmarkRebuildHz;
+            kx::Benchmark::RequestUiBenchmark(uiConfig);
+        }
+        if (auto uiResult = kx::Benchmark::GetLastUiBenchmarkResult()) {
+            ImGui::Text("%zu rows: mean %.0f us | p50 %.0f us | p99 %.0f us | max %.0f us per frame",
+                uiResult->rows, uiResult->meanFrameUs, uiResult->p50FrameUs, uiResult->p99FrameUs, uiResult->maxFrameUs);
+            if (uiResult->rebuildRateHz > 0) {
+                ImGui::Text("Rebuilt %d of %d frames at %d Hz", uiResult->rebuiltFrames, uiResult->frames, uiResult->rebuildRateHz);
+            }
+            ImGui::Text("%.0f vertices, %.0f indices, %.0f draw commands, %.1f ImGui allocations (%.0f B) per frame",
+                uiResult->meanVertices, uiResult->meanIndices, uiResult->meanDrawCommands,
+                uiResult->allocationsPerFrame, uiResult->allocatedBytesPerFrame);
+            ImGui::TextDisabled("Results: %s", kx::Benchmark::UI_RESULTS_JSON_FILE);
+        }
 
-            // Copy button: generate and copy full log entry string on click.
-            if (ImGui::SmallButton("Copy")) {
-                std::string fullLogEntry = kx::Utils::FormatFullLogEntryString(packet);
-                ImGui::SetClipboardText(fullLogEntry.c_str());
+        // --- Synthetic load test ---
+        ImGui::Separator();
+        ImGui::Text("Load Test (synthetic traffic into a private log; live capture pauses meanwhile):");
+        static kx::LoadTest::TrafficConfig loadTestConfig;
+        static float packetsPerSecond = static_cast<float>(loadTestConfig.packetsPerSecond);
+        static float durationSeconds = static_cast<float>(loadTestConfig.durationSeconds);
+        static float receivedRatio = static_cast<float>(loadTestConfig.receivedRatio);
+        static int seed = static_cast<int>(loadTestConfig.seed);
+        static int producerThreads = loadTestConfig.producerThreads;
+        ImGui::SliderFloat("Packets/s", &packetsPerSecond, 100.0f, 200000.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Duration (s)", &durationSeconds, 1.0f, 120.0f, "%.0f");
+        ImGui::SliderFloat("Received Ratio", &receivedRatio, 0.0f, 1.0f, "%.2f");
+        ImGui::InputInt("Seed", &seed);
+        ImGui::SliderInt("Producer Threads##LoadTest", &producerThreads, 1, kx::LoadTest::MAX_PRODUCER_THREADS);
+
+        if (kx::LoadTest::IsRunning()) {
+            if (ImGui::Button("Stop Load Test")) {
+                kx::LoadTest::RequestStop();
             }
+            ImGui::SameLine();
+            ImGui::TextDisabled("Running...");
+        }
+        else if (ImGui::Button("Start Load Test")) {
+            loadTestConfig.packetsPerSecond = packetsPerSecond;
+            loadTestConfig.durationSeconds = durationSeconds;
+            loadTestConfig.receivedRatio = receivedRatio;
+            loadTestConfig.seed = static_cast<std::uint32_t>(seed);
+            loadTestConfig.producerThreads = producerThreads;
+            kx::LoadTest::StartAsync(loadTestConfig);
+        }
 
-            ImGui::PopID();
-        } // End for visible items
-    } // End while clipper
-    clipper.End();
+        if (auto result = kx::LoadTest::GetLastResult()) {
+            ImGui::Text("Processed: %zu (%.0f/s)  Behind schedule: %zu",
+                result->processed, result->throughputPerSecond, result->behindSchedule);
+            ImGui::Text("Logged: %zu  Skipped by policy: %zu  Lost: %zu",
+                result->logged, result->skipped, result->lost);
+            ImGui::Text("Latency p50: %.2f us  p99: %.2f us  max: %.2f us",
+                result->p50LatencyUs, result->p99LatencyUs, result->maxLatencyUs);
+        }
 
-    // Auto-scroll to bottom if scrollbar is already at the end.
-    if (!filtered_indices.empty() && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
-        ImGui::SetScrollHereY(1.0f);
+        // --- Shutdown quiescence stress test ---
+        ImGui::Separator();
+        ImGui::Text("Unload Stress Test (shutdown protocol vs. simulated detours):");
+        static int stressThreads = 16;
+        ImGui::SliderInt("Producer Threads", &stressThreads, 1, 128);
+        if (kx::Quiescence::IsStressTestRunning()) {
+            ImGui::TextDisabled("Running...");
+        }
+        else if (ImGui::Button("Run Unload Stress Test")) {
+            kx::Quiescence::StressTestConfig stressConfig;
+            stressConfig.producerThreads = static_cast<unsigned>(stressThreads);
+            kx::Quiescence::StartStressTestAsync(stressConfig);
+        }
+        if (auto result = kx::Quiescence::GetLastStressTestResult()) {
+            ImGui::Text("Cycles: %llu  Bodies: %llu  Violations: %llu  Timeouts: %llu",
+                static_cast<unsigned long long>(result->shutdownCycles), static_cast<unsigned long long>(result->bodyEntries),
+                static_cast<unsigned long long>(result->violations), static_cast<unsigned long long>(result->timeouts));
+            ImGui::Text("Drain time mean: %.0f us  max: %.0f us", result->meanDrainUs, result->maxDrainUs);
+        }
+
+        ImGui::Spacing();
+        ImGui::Text("Capture Control Toggle Test (UI writers vs. simulated detours):");
+        if (kx::Capture::IsToggleTestRunning()) {
+            ImGui::TextDisabled("Running...");
+        }
+        else if (ImGui::Button("Run Toggle Test")) {
+            kx::Capture::StartToggleTestAsync(static_cast<unsigned>(stressThreads), 1000);
+        }
+        if (auto result = kx::Capture::GetLastToggleTestResult()) {
+            ImGui::Text("Toggles: %llu  Reads: %llu  Lost updates: %llu  Violations: %llu",
+                static_cast<unsigned long long>(result->toggles), static_cast<unsigned long long>(result->reads),
+                static_cast<unsigned long long>(result->lostUpdates), static_cast<unsigned long long>(result->invariantViolations));
+        }
+        ImGui::Spacing();
+    }
+}
+
+void ImGuiManager::RenderPacketLogSection() {
+    ImGui::Text("Packet Log:");
+    ImGui::SameLine();
+    ImGui::Checkbox("Hex Dump", &kx::g_showHexDumpPane);
+    ImGui::SameLine();
+    if (kx::LogView::SelectedCount() > 0) {
+        ImGui::TextDisabled("(%zu selected, Ctrl+C to copy, right-click for options)", kx::LogView::SelectedCount());
+    }
+    else {
+        ImGui::TextDisabled("(click, Ctrl+click or Shift+click rows to select; click headers to sort)");
+    }
+
+    // Filters that read payload bytes need plaintext for deferred packets.
+    auto activeFilter = kx::Filtering::GetActiveFilterExpression();
+    const bool filterNeedsPlaintext = activeFilter && activeFilter->ReadsPayload();
+    if (filterNeedsPlaintext) {
+        kx::Decryption::MaterializeProgress progress = kx::Decryption::GetProgress();
+        if (progress.running) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(decrypting for filter: %zu / %zu)", progress.decryptedPackets, progress.totalPackets);
+        }
     }
 
-    ImGui::EndChild(); // End "PacketLogScrollingRegion"
+    if (filterNeedsPlaintext) {
+        std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
+        kx::Decryption::RequestPlaintext();
+    }
+
+    // Sequences of packets that pass current filters, updated incrementally under the frame budget.
+    const std::vector<kx::PacketSequence>& view = kx::FilteredView::Update();
+    const kx::FilteredView::Progress filterProgress = kx::FilteredView::GetProgress();
+    if (filterProgress.rebuilding) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(filtering: %zu / %zu)", filterProgress.examinedPackets, filterProgress.totalPackets);
+    }
+
+    ImGui::Separator();
+
+    std::vector<kx::PacketSequence> matches;
+    if (kx::g_showSearchMatchesOnly) {
+        matches = view;
+        kx::Search::FilterToMatches(matches);
+    }
+    const std::vector<kx::PacketSequence>& filtered = kx::g_showSearchMatchesOnly ? matches : view;
+
+    // Sortable table with selection and copy (see PacketLogView.h), with the hex dump of
+    // the last clicked packet below it.
+    const kx::PacketSequence focused = kx::LogView::FocusedSequence();
+    if (!kx::g_showHexDumpPane || focused == kx::INVALID_PACKET_SEQUENCE) {
+        kx::LogView::RenderRows(filtered);
+        return;
+    }
+
+    const float available = ImGui::GetContentRegionAvail().y;
+    const float paneHeight = std::max(160.0f, available * 0.4f);
+    kx::LogView::RenderRows(filtered, std::max(80.0f, available - paneHeight - ImGui::GetStyle().ItemSpacing.y));
+    ImGui::BeginChild("PacketHexDumpPane", ImVec2(0, 0), true);
+    kx::HexView::RenderPane(focused);
+    ImGui::EndChild();
 }
 
 
@@ -293,11 +856,18 @@ void ImGuiManager::RenderPacketInspectorWindow() {
     // Set minimum window size constraints before calling Begin
     ImGui::SetNextWindowSizeConstraints(ImVec2(350.0f, 200.0f), ImVec2(FLT_MAX, FLT_MAX));
     ImGui::Begin(windowTitle.c_str(), &kx::g_isInspectorWindowOpen);
+    if (!kx::g_isInspectorWindowOpen) {
+        kx::Control::RequestShutdown(); // Closing the window unloads the inspector
+    }
 
     RenderHints();
     RenderInfoSection();
     RenderStatusControlsSection();
     RenderFilteringSection();
+    RenderPayloadSearchSection();
+    RenderStatisticsSection();
+    RenderTrafficGraphsSection();
+    RenderDiagnosticsSection();
     RenderPacketLogSection();
 
     ImGui::End();
@@ -306,16 +876,24 @@ void ImGuiManager::RenderPacketInspectorWindow() {
 
 void ImGuiManager::RenderUI()
 {
+    kx::FrameBudget::BeginFrame();
+
     // Only render the inspector window if the visibility flag is set
     if (kx::g_showInspectorWindow) {
         RenderPacketInspectorWindow();
     }
 
+    // The capture policy's opcode list follows the filters whether or not its node is open.
+    kx::Filtering::PublishCaptureOpcodes();
+
+    kx::FrameBudget::EndFrame();
+
     // You can add other UI elements here if needed
     // ImGui::ShowDemoWindow(); // Keep demo window for reference if needed during dev
 }
 
 void ImGuiManager::Shutdown() {
+    kx::UiRefresh::Shutdown();
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
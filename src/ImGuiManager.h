@@ -8,6 +8,7 @@ public:
     static bool Initialize(ID3D11Device* device, ID3D11DeviceContext* context, HWND hwnd);
     static void NewFrame();
     static void Render(ID3D11DeviceContext* context, ID3D11RenderTargetView* mainRenderTargetView);
+    static void RenderCachedFrame(ID3D11DeviceContext* context, ID3D11RenderTargetView* mainRenderTargetView); // See UiRefresh.h
     static void RenderUI();
     static void Shutdown();
 private:
@@ -17,5 +18,9 @@ private:
     static void RenderInfoSection();
     static void RenderStatusControlsSection();
     static void RenderFilteringSection();
+    static void RenderPayloadSearchSection();
+    static void RenderStatisticsSection();
+    static void RenderTrafficGraphsSection();
+    static void RenderDiagnosticsSection();
     static void RenderPacketLogSection();
 };
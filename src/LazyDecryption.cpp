@@ -0,0 +1,250 @@
+#include "LazyDecryption.h"
+#include "CryptoUtils.h"
+#include "HookQuiescence.h" // For StartBackgroundThread
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kx::Decryption {
+
+    namespace {
+
+        // Backlogs up to this size are decrypted inline by RequestPlaintext() instead of
+        // spawning a thread, so steady capture never starts one thread per frame.
+        constexpr std::size_t INLINE_MATERIALIZE_PACKETS = 256;
+
+        struct CacheEntry {
+            RC4SnapshotId id;
+            PacketPayload plaintext;
+        };
+
+        // --- Guarded by g_packetLogMutex ---
+        std::list<CacheEntry> s_lru; // Most recently used first
+        std::unordered_map<RC4SnapshotId, std::list<CacheEntry>::iterator> s_cacheIndex;
+        std::size_t s_cacheBytes = 0;
+        std::uint64_t s_cacheHits = 0;
+        std::uint64_t s_cacheMisses = 0;
+        RC4Cursor s_cacheCursor;        // Rows render in log order, so misses mostly skip forward
+        std::chrono::steady_clock::time_point s_lastCacheUse;
+        std::uint64_t s_generation = 0; // Bumped by Reset() to retire a running background pass
+
+        // --- Readable without the lock ---
+        std::atomic<bool> s_materializing{ false };
+        std::atomic<std::size_t> s_watermark{ 0 }; // Every deferred packet below this index is decrypted
+        std::atomic<std::size_t> s_materializeTotal{ 0 };
+
+        bool DecryptStream(const PacketInfo& packet, std::uint8_t* out, RC4Cursor& cursor) {
+            if (!g_rc4Snapshots.Seek(packet.rc4Snapshot, cursor)) {
+                return false;
+            }
+            std::copy(packet.data.begin(), packet.data.end(), out);
+            Crypto::rc4_process_stream(cursor.state, out, packet.data.size());
+            cursor.offset += static_cast<std::uint32_t>(packet.data.size());
+            return true;
+        }
+
+        // Decrypts the deferred packets in g_packetLog[first, last) into the log. Requires the log lock.
+        void MaterializeRange(std::size_t first, std::size_t last, RC4Cursor& cursor) {
+            for (std::size_t i = first; i < last; ++i) {
+                PacketInfo& packet = g_packetLog[i];
+                if (!packet.IsDecryptionDeferred()) continue;
+                PacketPayload plaintext = packet.data;
+                if (DecryptStream(packet, plaintext.data(), cursor)) {
+                    packet.decryptedData = std::move(plaintext);
+                }
+            }
+            s_watermark.store(last, std::memory_order_relaxed);
+        }
+
+        // A deferred packet copied out of the log for decryption without the lock.
+        struct PendingPacket {
+            std::size_t position;   // In g_packetLog
+            std::uint32_t keyframe; // Located in g_rc4Snapshots
+            std::uint32_t offset;
+            PacketPayload payload;  // Ciphertext, decrypted in place
+        };
+
+        // Background pass. Each slice copies up to MATERIALIZE_SLICE_BYTES of ciphertext and
+        // the keyframes it needs under the log lock, decrypts them without it, and takes the
+        // lock again only to install the results, so capture and rendering never wait for
+        // the RC4 work.
+        void MaterializeLoop(std::uint64_t generation) {
+            RC4Cursor cursor;
+            std::vector<PendingPacket> pending;
+            std::vector<std::pair<std::uint32_t, GameStructs::RC4State>> keyframes; // Ascending index
+            try {
+                while (true) {
+                    std::size_t last = 0;
+                    pending.clear();
+                    keyframes.clear();
+                    {
+                        std::lock_guard<std::mutex> lock(g_packetLogMutex);
+                        if (s_generation != generation) {
+                            return; // Reset() already cleared s_materializing for us
+                        }
+                        const std::size_t first = s_watermark.load(std::memory_order_relaxed);
+                        const std::size_t end = std::min(first + MATERIALIZE_BATCH_PACKETS, g_packetLog.size());
+                        if (first >= end) {
+                            s_materializing = false;
+                            return;
+                        }
+                        std::size_t bytes = 0;
+                        for (last = first; last < end && bytes < MATERIALIZE_SLICE_BYTES; ++last) {
+                            const PacketInfo& packet = g_packetLog[last];
+                            std::uint32_t keyframe = 0;
+                            std::uint32_t offset = 0;
+                            if (!packet.IsDecryptionDeferred() || !g_rc4Snapshots.Locate(packet.rc4Snapshot, keyframe, offset)) continue;
+                            if (keyframes.empty() || keyframes.back().first != keyframe) {
+                                keyframes.emplace_back(keyframe, g_rc4Snapshots.KeyframeState(keyframe));
+                            }
+                            pending.push_back(PendingPacket{ last, keyframe, offset, packet.data });
+                            bytes += packet.data.size();
+                        }
+                    }
+
+                    std::size_t keyframeSlot = 0;
+                    for (PendingPacket& packet : pending) {
+                        while (keyframes[keyframeSlot].first != packet.keyframe) ++keyframeSlot;
+                        RC4SnapshotPool::SeekTo(packet.keyframe, packet.offset, keyframes[keyframeSlot].second, cursor);
+                        Crypto::rc4_process_stream(cursor.state, packet.payload.data(), packet.payload.size());
+                        cursor.offset += static_cast<std::uint32_t>(packet.payload.size());
+                    }
+
+                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
+                    if (s_generation != generation) {
+                        return; // The log was cleared or swapped; the positions are stale
+                    }
+                    for (PendingPacket& packet : pending) {
+                        PacketInfo& target = g_packetLog[packet.position];
+                        if (target.IsDecryptionDeferred()) { // Not decrypted inline meanwhile
+                            target.decryptedData = std::move(packet.payload);
+                        }
+                    }
+                    s_watermark.store(last, std::memory_order_relaxed);
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[LazyDecryption] Exception in background pass: " << e.what() << std::endl;
+            }
+            std::lock_guard<std::mutex> lock(g_packetLogMutex);
+            if (s_generation == generation) {
+                s_materializing = false;
+            }
+        }
+
+    } // anonymous namespace
+
+
+    const PacketPayload& GetPlaintext(const PacketInfo& packet) {
+        if (!packet.IsDecryptionDeferred()) {
+            return packet.GetDisplayData();
+        }
+
+        s_lastCacheUse = std::chrono::steady_clock::now();
+        auto found = s_cacheIndex.find(packet.rc4Snapshot);
+        if (found != s_cacheIndex.end()) {
+            ++s_cacheHits;
+            s_lru.splice(s_lru.begin(), s_lru, found->second);
+            return found->second->plaintext;
+        }
+
+        ++s_cacheMisses;
+        PacketPayload plaintext = packet.data;
+        if (!DecryptStream(packet, plaintext.data(), s_cacheCursor)) {
+            return packet.data; // Unknown snapshot: nothing better to show than the ciphertext
+        }
+
+        s_cacheBytes += plaintext.size();
+        s_lru.push_front(CacheEntry{ packet.rc4Snapshot, std::move(plaintext) });
+        s_cacheIndex[packet.rc4Snapshot] = s_lru.begin();
+
+        // Evict from the back, but never the entry that is about to be returned.
+        while (s_cacheBytes > CACHE_CAPACITY_BYTES && s_lru.size() > 1) {
+            const CacheEntry& victim = s_lru.back();
+            s_cacheBytes -= victim.plaintext.size();
+            s_cacheIndex.erase(victim.id);
+            s_lru.pop_back();
+        }
+        return s_lru.front().plaintext;
+    }
+
+    bool DecryptInto(const PacketInfo& packet, std::uint8_t* out, RC4Cursor& cursor) {
+        return DecryptStream(packet, out, cursor);
+    }
+
+    void RequestPlaintext() {
+        if (s_materializing.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const std::size_t first = s_watermark.load(std::memory_order_relaxed);
+        const std::size_t total = g_packetLog.size();
+        if (first >= total) {
+            return;
+        }
+        s_materializeTotal.store(total, std::memory_order_relaxed);
+
+        if (total - first <= INLINE_MATERIALIZE_PACKETS) {
+            RC4Cursor cursor;
+            MaterializeRange(first, total, cursor);
+            return;
+        }
+
+        s_materializing = true;
+        const std::uint64_t generation = s_generation;
+        if (!Quiescence::StartBackgroundThread("decryption", [generation]() { MaterializeLoop(generation); })) {
+            s_materializing = false; // Retried on the next request
+        }
+    }
+
+    MaterializeProgress GetProgress() {
+        MaterializeProgress progress;
+        progress.running = s_materializing.load(std::memory_order_relaxed);
+        progress.decryptedPackets = s_watermark.load(std::memory_order_relaxed);
+        progress.totalPackets = std::max(s_materializeTotal.load(std::memory_order_relaxed), progress.decryptedPackets);
+        return progress;
+    }
+
+    CacheStats GetCacheStats() {
+        CacheStats stats;
+        stats.entries = s_lru.size();
+        stats.bytes = s_cacheBytes;
+        stats.hits = s_cacheHits;
+        stats.misses = s_cacheMisses;
+        return stats;
+    }
+
+    void TrimCache() {
+        if (s_lru.empty() || std::chrono::steady_clock::now() - s_lastCacheUse < CACHE_IDLE_RELEASE) {
+            return;
+        }
+        s_lru.clear();
+        std::unordered_map<RC4SnapshotId, std::list<CacheEntry>::iterator>().swap(s_cacheIndex); // Release the buckets too
+        s_cacheBytes = 0;
+    }
+
+    void Shutdown() {
+        std::lock_guard<std::mutex> lock(g_packetLogMutex);
+        ++s_generation;
+        s_materializing = false;
+    }
+
+    void Reset() {
+        s_lru.clear();
+        s_cacheIndex.clear();
+        s_cacheBytes = 0;
+        s_cacheHits = 0;
+        s_cacheMisses = 0;
+        s_cacheCursor = RC4Cursor{};
+        ++s_generation;
+        s_materializing = false;
+        s_watermark = 0;
+        s_materializeTotal = 0;
+    }
+
+} // namespace kx::Decryption
@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * @file LazyDecryption.h
+ * @brief On-demand decryption of received payloads.
+ * @details With CONTROL_LAZY_DECRYPTION set the processor keeps only the ciphertext and the
+ *          pooled RC4 snapshot (plus the decrypted header byte) for each encrypted packet.
+ *          Plaintext is produced when something needs it:
+ *            - row rendering and copying go through GetPlaintext(), which keeps results in
+ *              a byte-bounded LRU cache keyed by snapshot id;
+ *            - the payload search decrypts each chunk in keystream order with DecryptInto();
+ *            - filter expressions that read payload bytes call RequestPlaintext(), which
+ *              decrypts the deferred packets into the log in slices on a background
+ *              thread, holding the log lock only to copy a slice out and to install it.
+ *              Until a packet is done, payload operands evaluate to false.
+ *          All functions except GetProgress() and Shutdown() require g_packetLogMutex to be held.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "PacketData.h"      // For PacketInfo, PacketPayload
+#include "RC4SnapshotPool.h" // For RC4Cursor
+
+namespace kx::Decryption {
+
+    constexpr std::size_t CACHE_CAPACITY_BYTES = 8 * 1024 * 1024;
+    constexpr std::size_t MATERIALIZE_BATCH_PACKETS = 4096;     // Packets per background slice, at most
+    constexpr std::size_t MATERIALIZE_SLICE_BYTES = 256 * 1024; // Ciphertext bytes per background slice
+    constexpr std::chrono::seconds CACHE_IDLE_RELEASE{ 30 };
+
+    /**
+     * @brief Returns the plaintext payload of a packet.
+     * @details Packets that are not deferred return GetDisplayData(). For deferred packets
+     *          the returned reference points into the cache and stays valid until the next
+     *          GetPlaintext() or Reset() call.
+     */
+    const PacketPayload& GetPlaintext(const PacketInfo& packet);
+
+    /**
+     * @brief Writes the plaintext of a deferred packet to `out` (packet.data.size() bytes).
+     * @details Bypasses the cache. Decrypting packets in log order with one cursor costs a
+     *          single pass over the keystream.
+     * @return False if the packet's snapshot is unknown.
+     */
+    bool DecryptInto(const PacketInfo& packet, std::uint8_t* out, RC4Cursor& cursor);
+
+    /**
+     * @brief Starts background decryption of every deferred packet in g_packetLog if one is
+     *        not already running. Cheap to call every frame.
+     */
+    void RequestPlaintext();
+
+    struct MaterializeProgress {
+        bool running = false;
+        std::size_t decryptedPackets = 0; // Log position the background pass has reached
+        std::size_t totalPackets = 0;     // Log size when the pass started
+    };
+
+    MaterializeProgress GetProgress();
+
+    struct CacheStats {
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    CacheStats GetCacheStats();
+
+    /**
+     * @brief Releases the cache if GetPlaintext() has not decrypted anything for
+     *        CACHE_IDLE_RELEASE. Meant to run periodically from the control loop.
+     */
+    void TrimCache();
+
+    /**
+     * @brief Stops the background pass for unload; it returns after its current batch and
+     *        Quiescence::WaitForBackgroundThreads() waits for it. Takes g_packetLogMutex.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Drops cached plaintext and stops the background pass. Call when the log and
+     *        g_rc4Snapshots are cleared.
+     */
+    void Reset();
+
+} // namespace kx::Decryption
@@ -1,9 +1,22 @@
 #include <iostream>
 #include <cstdio> // Required for fclose
+#include <chrono>
+#include <mutex>
 #include <windows.h>
 #include "Console.h"
 #include "Hooks.h"
-#include "AppState.h"   // Include for g_isInspectorWindowOpen, g_isShuttingDown
+#include "AppState.h"   // Include for g_isInspectorWindowOpen
+#include "CaptureControl.h" // For the shutting-down bit
+#include "ControlLoop.h"
+#include "D3DRenderHook.h" // For IsInitialized (unload hotkey fallback)
+#include "HookManager.h"
+#include "HookMetrics.h"
+#include "HookQuiescence.h"
+#include "LazyDecryption.h"
+#include "PacketData.h"    // For g_packetLogMutex
+#include "PacketLogView.h" // To wait for a running sort
+#include "PayloadSearch.h"
+#include "TrafficGenerator.h" // To stop a running load test
 
 HINSTANCE dll_handle;
 
@@ -46,6 +59,28 @@ void InitializeFilters() {
     std::cout << "[Main] Filter selections initialized." << std::endl;
 }
 
+// Periodic maintenance, run by the control loop on the main thread.
+void ScheduleMaintenanceTasks() {
+#if KX_ENABLE_HOOK_METRICS
+    kx::Control::SchedulePeriodic("hook-metrics-rollup", std::chrono::seconds(1), []() {
+        kx::HookMetrics::UpdateRates();
+    });
+#endif // KX_ENABLE_HOOK_METRICS
+
+    kx::Control::SchedulePeriodic("plaintext-cache-trim", std::chrono::seconds(5), []() {
+        std::lock_guard<std::mutex> lock(kx::g_packetLogMutex);
+        kx::Decryption::TrimCache();
+    });
+
+    // The unload hotkey is normally handled by the Present hook. Until the overlay is up
+    // (or if the game stops presenting) poll it here so the DLL can still be unloaded.
+    kx::Control::SchedulePeriodic("unload-hotkey-fallback", std::chrono::milliseconds(250), []() {
+        if (!kx::Hooking::D3DRenderHook::IsInitialized() && (GetAsyncKeyState(VK_DELETE) & 0x8000)) {
+            kx::Control::RequestShutdown();
+        }
+    });
+}
+
 // Main function that runs in a separate thread
 DWORD WINAPI MainThread(LPVOID lpParameter) {
 #ifdef _DEBUG
@@ -60,18 +95,46 @@ DWORD WINAPI MainThread(LPVOID lpParameter) {
         return 1;
     }
 
-    // Main loop to keep the hook alive
-    while (kx::g_isInspectorWindowOpen && !(GetAsyncKeyState(VK_DELETE) & 0x8000)) {
-        Sleep(100); // Sleep to avoid busy-waiting
+    // Block until the UI or the unload hotkey requests shutdown, running maintenance meanwhile
+    ScheduleMaintenanceTasks();
+    kx::Control::Run();
+
+    // Signal hooks to stop processing, stop new detour invocations, then wait until the
+    // ones already running (including a frame being rendered) have returned.
+    kx::Capture::g_captureControl.Set(kx::Capture::CONTROL_SHUTTING_DOWN, true);
+    kx::Hooking::HookManager::DisableAllHooks();
+    kx::LoadTest::RequestStop(); // Its processor calls are counted by the tracker too
+    const bool quiescent = kx::Quiescence::g_hookTracker.WaitForQuiescence(kx::Quiescence::SHUTDOWN_QUIESCENCE_TIMEOUT);
+
+    // With no frame being rendered nothing starts new background work; stop what runs.
+    kx::Search::CancelSearch();
+    kx::Decryption::Shutdown();
+
+    // Cleanup hooks and ImGui, unless a detour (possibly a frame being rendered) still uses them
+    if (quiescent) {
+        kx::LogView::Shutdown();
+        kx::CleanupHooks();
+    }
+    else {
+        kx::DetachHooksInFlight();
     }
 
-    // Signal hooks to stop processing before actual cleanup
-    kx::g_isShuttingDown = true;
-    // Add a small delay to allow the render thread to potentially finish its current frame
-    Sleep(100); // Adjust delay if needed, or consider more robust synchronization
+    // Threads started from the UI (search workers, background decryption, benchmarks,
+    // load test, freeing a cleared log) run DLL code too.
+    const bool backgroundDone = kx::Quiescence::WaitForBackgroundThreads(kx::Quiescence::BACKGROUND_SHUTDOWN_TIMEOUT);
 
-    // Cleanup hooks and ImGui
-    kx::CleanupHooks();
+    if (!quiescent) {
+        // A game thread is still inside a detour (e.g. blocked in the original function).
+        // The hooks are disabled, but unloading now would pull the code out from under it.
+        std::cerr << "[Main] Hooks did not become quiescent; staying loaded." << std::endl;
+        OutputDebugStringA("kx-packet-inspector: detours still in flight at shutdown, DLL left loaded.\n");
+        return 0;
+    }
+    if (!backgroundDone) {
+        std::cerr << "[Main] " << kx::Quiescence::BackgroundThreadCount() << " background thread(s) still running; staying loaded." << std::endl;
+        OutputDebugStringA("kx-packet-inspector: background threads still running at shutdown, DLL left loaded.\n");
+        return 0;
+    }
 
     // Eject the DLL and exit the thread
     CreateThread(0, 0, EjectThread, 0, 0, 0);
@@ -1,9 +1,11 @@
 #include "MsgRecvHook.h"
 #include "PacketProcessor.h" // Include the new processor header
-#include "AppState.h"        // For g_capturePaused, g_isShuttingDown
+#include "CaptureControl.h"  // For the capture control word
 #include "GameStructs.h"     // For offsets, RC4State, size mask
 #include "Config.h"          // Potentially useful defines (currently none used here)
 #include "HookManager.h"
+#include "HookMetrics.h"     // For detour overhead instrumentation
+#include "HookQuiescence.h"  // For the in-flight guard waited on at unload
 
 #include <vector>
 #include <chrono>
@@ -52,6 +54,12 @@ void* __fastcall hookMsgRecv(
     int param_5,
     void* param_6)
 {
+    // Counted until the detour returns, so unload can wait for it (see HookQuiescence.h).
+    kx::Quiescence::InFlightScope inFlight(kx::Quiescence::g_hookTracker);
+
+    // Measures our overhead up to the original call (no-op if metrics are compiled out).
+    kx::HookMetrics::ScopedTimer overheadTimer(kx::HookMetrics::HookId::MsgRecv);
+
     void* returnValue = nullptr; // MUST capture and return the original's return value
     std::optional<kx::GameStructs::RC4State> capturedRc4State = std::nullopt;
     int currentBufferState = -1; // Default: Unknown state (e.g., context null)
@@ -60,7 +68,7 @@ void* __fastcall hookMsgRecv(
 
     // Check if packet capture is active. This check should occur before potentially
     // expensive state capture or processing delegation.
-    bool shouldProcessPacket = !kx::g_capturePaused && !kx::g_isShuttingDown.load();
+    bool shouldProcessPacket = kx::Capture::g_captureControl.ShouldCapture();
 
     if (shouldProcessPacket) {
         // --- Capture State (only if context is valid) ---
@@ -144,6 +152,8 @@ void* __fastcall hookMsgRecv(
     } // end if(shouldProcessPacket)
 
 
+    overheadTimer.Stop();
+
     // CRITICAL: Always call the original function to allow the game to process the packet.
     if (originalMsgRecv) {
         returnValue = originalMsgRecv(param_1, param_2, param_3, param_4, param_5, param_6);
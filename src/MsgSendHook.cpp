@@ -1,8 +1,10 @@
 #include "MsgSendHook.h"
 #include "PacketProcessor.h" // Include the new processor header
-#include "AppState.h"        // For g_capturePaused, g_isShuttingDown
+#include "CaptureControl.h"  // For the capture control word
 #include "GameStructs.h"     // For MsgSendContext definition
 #include "HookManager.h"
+#include "HookMetrics.h"     // For detour overhead instrumentation
+#include "HookQuiescence.h"  // For the in-flight guard waited on at unload
 
 #include <iostream> // For temporary error logging (replace with Log.h later)
 
@@ -14,10 +16,15 @@ static uintptr_t hookedMsgSendAddress = 0;
 // Detour function for the game's internal message sending logic.
 // This function now primarily captures the context and delegates processing.
 void __fastcall hookMsgSend(void* param_1) {
+    // Counted until the detour returns, so unload can wait for it (see HookQuiescence.h).
+    kx::Quiescence::InFlightScope inFlight(kx::Quiescence::g_hookTracker);
 
-    // Check if packet capture is active before processing.
+    // Measures our overhead up to the original call (no-op if metrics are compiled out).
+    kx::HookMetrics::ScopedTimer overheadTimer(kx::HookMetrics::HookId::MsgSend);
+
+    // Check if packet capture is active before processing (one acquire load of the control word).
     // This check happens *before* calling the original function.
-    if (!kx::g_capturePaused && !kx::g_isShuttingDown.load()) {
+    if (kx::Capture::g_captureControl.ShouldCapture()) {
         if (param_1 != nullptr) {
             try {
                 // Cast the context pointer.
@@ -42,6 +49,8 @@ void __fastcall hookMsgSend(void* param_1) {
         }
     }
 
+    overheadTimer.Stop();
+
     // CRITICAL: Always call the original function, regardless of capture state or errors.
     if (originalMsgSend) {
         originalMsgSend(param_1);
@@ -1,7 +1,79 @@
 #include "PacketData.h"
+#include "CaptureControl.h"  // For CONTROL_PAUSED
+#include "HookQuiescence.h"  // For StartBackgroundThread
+#include "LazyDecryption.h"  // For Decryption::Reset
+#include "PacketMetadata.h"  // For g_packetMetadata
+#include "PacketStaging.h"   // For FlushAll
+#include "RC4SnapshotPool.h" // For g_rc4Snapshots
+
+#include <atomic>
+#include <memory>
+#include <utility>
 
 namespace kx {
 
 std::deque<PacketInfo> g_packetLog;
 std::mutex g_packetLogMutex;
-}
\ No newline at end of file
+PacketSequence g_packetLogFirstSequence = 0;
+
+// A log with everything indexed by position in it.
+struct PacketLogStorage {
+    std::deque<PacketInfo> log;
+    PacketMetadataStore metadata;
+    RC4SnapshotPool snapshots;
+};
+
+namespace {
+
+    std::atomic<bool> s_isolated{ false };
+
+} // anonymous namespace
+
+void ClearPacketLog() {
+    auto released = std::make_shared<PacketLogStorage>();
+    std::swap(released->log, g_packetLog);
+    std::swap(released->metadata, g_packetMetadata);
+    std::swap(released->snapshots, g_rc4Snapshots);
+    g_packetLogFirstSequence += released->log.size();
+
+    // Unload waits for background threads, so the storage is freed before the DLL goes.
+    // If no thread can be started, the storage is freed here when the body is discarded.
+    Quiescence::StartBackgroundThread("log-release", [released = std::move(released)]() mutable {
+        released.reset();
+    });
+}
+
+IsolatedPacketLog::IsolatedPacketLog(PacketSequence firstSequence, std::deque<PacketInfo> log)
+    : m_storage(std::make_unique<PacketLogStorage>()), m_firstSequence(firstSequence)
+{
+    m_storage->metadata = BuildPacketMetadata(log);
+    m_storage->log = std::move(log);
+
+    m_wasPaused = Capture::g_captureControl.IsSet(Capture::CONTROL_PAUSED);
+    s_isolated = true;
+    Capture::g_captureControl.Set(Capture::CONTROL_PAUSED, true);
+    Staging::FlushAll(); // Packets staged before the pause belong to the live log
+    Swap();
+}
+
+IsolatedPacketLog::~IsolatedPacketLog() {
+    Staging::FlushAll(); // Packets staged since belong to the private log
+    Swap();
+    Capture::g_captureControl.Set(Capture::CONTROL_PAUSED, m_wasPaused);
+    s_isolated = false;
+}
+
+bool IsolatedPacketLog::IsActive() {
+    return s_isolated.load();
+}
+
+void IsolatedPacketLog::Swap() {
+    std::lock_guard<std::mutex> lock(g_packetLogMutex);
+    std::swap(g_packetLog, m_storage->log);
+    std::swap(g_packetMetadata, m_storage->metadata);
+    std::swap(g_rc4Snapshots, m_storage->snapshots);
+    std::swap(g_packetLogFirstSequence, m_firstSequence);
+    Decryption::Reset(); // The plaintext cache and materialization refer to the other log
+}
+
+}
@@ -7,7 +7,10 @@
 #include <chrono>
 #include <cstdint>
 #include <optional>
+#include <memory>
 #include "GameStructs.h"
+#include "PacketPayload.h"
+#include "RC4SnapshotPool.h"
 
 namespace kx {
 
@@ -29,24 +32,40 @@ namespace kx {
     // Forward declare the InternalPacketType enum
     enum class InternalPacketType;
 
+    // The fields of a packet the traffic aggregates (statistics, rate graphs, timeline)
+    // record, for logged packets and for packets the capture policy skipped alike.
+    struct TrafficSample {
+        std::chrono::system_clock::time_point timestamp;
+        std::uint32_t size = 0;            // Original packet size
+        PacketDirection direction = PacketDirection::Sent;
+        std::uint8_t headerId = 0;
+        bool skipped = false;              // Rejected by the capture policy, not logged
+    };
+
     // Structure to hold information about a captured packet
     struct PacketInfo {
         std::chrono::system_clock::time_point timestamp;
         int size = 0;                      // Size of original data
-        std::vector<uint8_t> data;         // Original (potentially encrypted) byte data
+        PacketPayload data;                // Original (potentially encrypted) byte data
         PacketDirection direction;
         uint8_t rawHeaderId = 0;           // Raw header byte (from decrypted data if applicable)
         std::string name = "Unprocessed";  // String name (resolved using direction + rawHeaderId or special type)
         int bufferState = -1;              // State read from MsgConn (-1: null ctx, -2: read err, >=0: actual state)
         InternalPacketType specialType = InternalPacketType::NORMAL; // Assume normal unless set otherwise
 
-        std::optional<kx::GameStructs::RC4State> rc4State;
-        std::optional<std::vector<uint8_t>> decryptedData;
+        RC4SnapshotId rc4Snapshot = INVALID_RC4_SNAPSHOT; // Pre-decryption RC4 state in g_rc4Snapshots
+        std::optional<PacketPayload> decryptedData;
 
         // Helper to get displayable data (prioritizes decrypted)
-        const std::vector<uint8_t>& GetDisplayData() const {
+        const PacketPayload& GetDisplayData() const {
             return decryptedData.has_value() ? decryptedData.value() : data;
         }
+
+        // True when the payload is still ciphertext awaiting on-demand decryption
+        // (see LazyDecryption.h). GetDisplayData() then returns the ciphertext.
+        bool IsDecryptionDeferred() const {
+            return rc4Snapshot != INVALID_RC4_SNAPSHOT && !decryptedData.has_value() && !data.empty();
+        }
     };
 
     // Global container for storing captured packet info
@@ -55,4 +74,66 @@ namespace kx {
     // Mutex to protect access to the global packet log
     extern std::mutex g_packetLogMutex;
 
+    // Capture-order number of a packet. Packets are numbered consecutively for the whole
+    // session and numbers are never reused, so a sequence identifies a packet across log
+    // clears, unlike its position in g_packetLog.
+    using PacketSequence = std::uint64_t;
+    constexpr PacketSequence INVALID_PACKET_SEQUENCE = ~PacketSequence(0);
+
+    // Sequence of g_packetLog[0]; g_packetLog[i] is packet g_packetLogFirstSequence + i.
+    // Guarded by g_packetLogMutex.
+    extern PacketSequence g_packetLogFirstSequence;
+
+    /**
+     * @brief Finds the position of packet `sequence` in g_packetLog. Requires g_packetLogMutex.
+     * @return False if the packet has been cleared or not captured yet.
+     */
+    inline bool FindLogPosition(PacketSequence sequence, std::size_t& position) {
+        if (sequence < g_packetLogFirstSequence || sequence - g_packetLogFirstSequence >= g_packetLog.size()) {
+            return false;
+        }
+        position = static_cast<std::size_t>(sequence - g_packetLogFirstSequence);
+        return true;
+    }
+
+    /**
+     * @brief Empties g_packetLog, g_packetMetadata and g_rc4Snapshots. Requires g_packetLogMutex.
+     * @details The storage is swapped out in constant time and destroyed on a background
+     *          thread (see Quiescence::StartBackgroundThread), so the caller holds the lock
+     *          only briefly however large the log was. Sequences continue after the cleared
+     *          packets.
+     */
+    void ClearPacketLog();
+
+    struct PacketLogStorage;
+
+    /**
+     * @brief Replaces the packet log with a private one while it lives, so self-tests do
+     *        not mix with live packets.
+     * @details Pauses capture and publishes the packets staged so far, then swaps
+     *          g_packetLog, g_packetMetadata, g_rc4Snapshots and the sequence numbering with
+     *          private storage holding `log`, numbered from `firstSequence` so no view
+     *          mistakes its rows for live ones. The destructor publishes the packets staged
+     *          meanwhile into the private log, swaps the live log back and restores the pause
+     *          state. The UI keeps Pause Capture and Clear Log disabled while IsActive().
+     *          Only one may exist at a time. Must not be created with g_packetLogMutex held.
+     */
+    class IsolatedPacketLog {
+    public:
+        explicit IsolatedPacketLog(PacketSequence firstSequence, std::deque<PacketInfo> log = {});
+        ~IsolatedPacketLog();
+
+        IsolatedPacketLog(const IsolatedPacketLog&) = delete;
+        IsolatedPacketLog& operator=(const IsolatedPacketLog&) = delete;
+
+        static bool IsActive();
+
+    private:
+        void Swap();
+
+        std::unique_ptr<PacketLogStorage> m_storage; // The log not currently in the globals
+        PacketSequence m_firstSequence;
+        bool m_wasPaused = false;
+    };
+
 } // namespace kx
@@ -0,0 +1,440 @@
+#include "PacketLogView.h"
+#include "../ImGui/imgui.h"
+#include "PacketData.h"      // For g_packetLog, g_packetLogMutex, g_packetLogFirstSequence
+#include "PacketMetadata.h"  // For g_packetMetadata
+#include "PacketSort.h"
+#include "FormattingUtils.h"
+#include "FrameBudget.h"
+#include "LazyDecryption.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <iterator>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace kx::LogView {
+
+    namespace {
+
+        using Sorting::SortColumn;
+
+        constexpr int PREVIEW_BYTES = 16;
+        constexpr auto RESORT_INTERVAL = std::chrono::milliseconds(250);
+        constexpr std::size_t SORT_CHUNK_ROWS = 32 * 1024; // Rows keyed per hold of the log lock
+        constexpr int MIN_ROWS_FORMATTED_PER_FRAME = 8; // Formatted even when the frame budget is spent
+        constexpr std::size_t SOURCE_SAMPLES = 64;
+
+        enum TableColumn { Col_Sequence, Col_Time, Col_Delta, Col_Dir, Col_Opcode, Col_Name, Col_Size, Col_State, Col_Preview, Col_Count_ };
+
+        // Cells that are costly to format, kept while the row is on screen.
+        struct CachedRow {
+            std::string time;
+            std::string preview;
+            std::uint64_t lastFrame = 0;
+        };
+
+        std::unordered_map<PacketSequence, CachedRow> s_rowCache;
+        std::uint64_t s_frame = 0;
+        int s_rowsFormattedThisFrame = 0;
+        PacketSequence s_logFirstSequence = 0; // Changes when the log is cleared or swapped
+
+        std::vector<std::uint64_t> s_selected; // One bit per packet from s_logFirstSequence on
+        std::size_t s_selectedCount = 0;
+        PacketSequence s_anchor = INVALID_PACKET_SEQUENCE; // Last plain/Ctrl-clicked packet
+
+        // Sorted view of the filtered indices. Rebuilt on a worker thread when the sort specs
+        // change, and at most every RESORT_INTERVAL when the filtered rows change (new
+        // packets, filters); the previous view stays on screen meanwhile.
+        std::vector<Sorting::SortSpec> s_sortSpecs;
+        std::vector<PacketSequence> s_sortedView;
+        bool s_sortDirty = true;
+        std::uint64_t s_sortedSource = 0;  // SampleSequences() of the rows s_sortedView was built from
+        std::future<std::vector<PacketSequence>> s_sortJob;
+        std::uint64_t s_sortJobSource = 0;
+        std::chrono::steady_clock::time_point s_lastSortTime;
+
+        bool IsSelected(PacketSequence sequence) {
+            if (sequence < s_logFirstSequence) return false;
+            const std::uint64_t offset = sequence - s_logFirstSequence;
+            return (offset >> 6) < s_selected.size() && (s_selected[offset >> 6] >> (offset & 63)) & 1u;
+        }
+
+        void SetSelected(PacketSequence sequence, bool selected) {
+            if (sequence < s_logFirstSequence) return;
+            const std::uint64_t offset = sequence - s_logFirstSequence;
+            const std::size_t word = static_cast<std::size_t>(offset >> 6);
+            if (word >= s_selected.size()) {
+                if (!selected) return;
+                s_selected.resize(word + 1, 0);
+            }
+            const std::uint64_t bit = 1ull << (offset & 63);
+            if (((s_selected[word] & bit) != 0) == selected) return;
+            s_selected[word] ^= bit;
+            if (selected) ++s_selectedCount; else --s_selectedCount;
+        }
+
+        // Requires g_packetLogMutex. Returns null if the row still needs formatting and the
+        // frame budget is spent; it is formatted on a later frame.
+        const CachedRow* GetRow(PacketSequence sequence, const PacketInfo& packet) {
+            auto cached = s_rowCache.find(sequence);
+            const bool upToDate = cached != s_rowCache.end() && !cached->second.time.empty();
+            if (!upToDate && s_rowsFormattedThisFrame >= MIN_ROWS_FORMATTED_PER_FRAME && !FrameBudget::HasTimeLeft()) {
+                FrameBudget::MarkDeferred();
+                return nullptr;
+            }
+
+            CachedRow& row = s_rowCache[sequence];
+            if (!upToDate) {
+                ++s_rowsFormattedThisFrame;
+                const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(packet.timestamp.time_since_epoch()).count() % 1000;
+                char millis[8];
+                snprintf(millis, sizeof(millis), ".%03lld", ms);
+                row.time = Utils::FormatTimestamp(packet.timestamp) + millis;
+                const PacketPayload& data = Decryption::GetPlaintext(packet); // Decrypted (on demand if deferred)
+                row.preview = Utils::FormatBytesToHex(data.data(), data.size(), PREVIEW_BYTES);
+            }
+            row.lastFrame = s_frame;
+            return &row;
+        }
+
+        // Cheap change detector for the filtered rows: the size plus evenly spaced samples.
+        // Hashing every sequence would cost more than the frame budget on large logs.
+        std::uint64_t SampleSequences(const std::vector<PacketSequence>& sequences) {
+            std::uint64_t hash = 1469598103934665603ull ^ sequences.size();
+            if (!sequences.empty()) {
+                const std::size_t step = std::max<std::size_t>(1, sequences.size() / SOURCE_SAMPLES);
+                for (std::size_t i = 0; i < sequences.size(); i += step) {
+                    hash = (hash ^ sequences[i]) * 1099511628211ull;
+                }
+                hash = (hash ^ sequences.back()) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        // Builds the sort keys in chunks of SORT_CHUNK_ROWS rows, taking the log lock once
+        // per chunk so that capture and rendering are not held up by a large sort; the radix
+        // sort then runs on the copied keys without the lock. Returns an empty view if the
+        // log is cleared or swapped meanwhile (RenderRows() then requests a new sort).
+        std::vector<PacketSequence> SortView(const std::vector<PacketSequence>& view, std::vector<Sorting::SortSpec> specs) {
+            std::vector<PacketSequence> live;
+            try {
+                std::vector<std::vector<std::uint64_t>> keys(specs.size());
+                for (auto& column : keys) {
+                    column.reserve(view.size());
+                }
+                live.reserve(view.size());
+
+                std::vector<PacketSequence> chunk;
+                PacketSequence first = 0;
+                for (std::size_t begin = 0; begin < view.size(); begin += SORT_CHUNK_ROWS) {
+                    const std::size_t end = std::min(view.size(), begin + SORT_CHUNK_ROWS);
+                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
+                    if (begin == 0) {
+                        first = g_packetLogFirstSequence;
+                    }
+                    else if (g_packetLogFirstSequence != first) {
+                        return {};
+                    }
+                    const std::size_t size = g_packetMetadata.Size();
+                    chunk.clear();
+                    std::copy_if(view.begin() + begin, view.begin() + end, std::back_inserter(chunk), [first, size](PacketSequence sequence) {
+                        return sequence >= first && sequence - first < size; // Cleared since the view was taken
+                    });
+                    for (std::size_t k = 0; k < specs.size(); ++k) {
+                        const std::vector<std::uint64_t> chunkKeys = Sorting::BuildSortKeys(g_packetMetadata, chunk, first, specs[k]);
+                        keys[k].insert(keys[k].end(), chunkKeys.begin(), chunkKeys.end());
+                    }
+                    live.insert(live.end(), chunk.begin(), chunk.end());
+                }
+                Sorting::SortIndicesByKeys(live, keys);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[LogView] Sort failed: " << e.what() << std::endl;
+            }
+            return live;
+        }
+
+        bool IsCaptureOrder(const std::vector<Sorting::SortSpec>& specs) {
+            return specs.empty() || (specs[0].column == SortColumn::Sequence && !specs[0].descending);
+        }
+
+        // Returns the filtered packets in display order.
+        const std::vector<PacketSequence>& GetDisplayOrder(const std::vector<PacketSequence>& filtered) {
+            if (IsCaptureOrder(s_sortSpecs)) {
+                return filtered; // The filtered view is already in capture order
+            }
+
+            if (s_sortJob.valid() && s_sortJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                s_sortedView = s_sortJob.get();
+                s_sortedSource = s_sortJobSource;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (!s_sortJob.valid()) {
+                const std::uint64_t source = SampleSequences(filtered);
+                if (s_sortDirty || (source != s_sortedSource && now - s_lastSortTime >= RESORT_INTERVAL)) {
+                    // Key extraction (under the log lock, chunk by chunk) and the radix sort run on a worker.
+                    s_sortJob = std::async(std::launch::async, SortView, filtered, s_sortSpecs);
+                    s_sortJobSource = source;
+                    s_lastSortTime = now;
+                    s_sortDirty = false;
+                }
+            }
+
+            if (s_sortedView.empty() && s_sortJob.valid()) {
+                return filtered; // First sort still running
+            }
+            return s_sortedView;
+        }
+
+        void ReadSortSpecs() {
+            ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+            if (!sortSpecs || !sortSpecs->SpecsDirty) {
+                return;
+            }
+            s_sortSpecs.clear();
+            for (int n = 0; n < sortSpecs->SpecsCount; ++n) {
+                const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[n];
+                s_sortSpecs.push_back({ static_cast<SortColumn>(spec.ColumnUserID), spec.SortDirection == ImGuiSortDirection_Descending });
+            }
+            sortSpecs->SpecsDirty = false;
+            s_sortDirty = true;
+        }
+
+        void CopySelection(const std::vector<PacketSequence>& displayOrder) {
+            std::string text;
+            {
+                std::lock_guard<std::mutex> lock(g_packetLogMutex);
+                for (PacketSequence sequence : displayOrder) {
+                    std::size_t position = 0;
+                    if (!IsSelected(sequence) || !FindLogPosition(sequence, position)) continue;
+                    text += Utils::FormatFullLogEntryString(g_packetLog[position]);
+                    text += '\n';
+                }
+            }
+            if (!text.empty()) {
+                ImGui::SetClipboardText(text.c_str());
+            }
+        }
+
+        void SelectAll(const std::vector<PacketSequence>& displayOrder) {
+            for (PacketSequence sequence : displayOrder) {
+                SetSelected(sequence, true);
+            }
+        }
+
+        // Applies a click on display row `row` with the current modifier keys.
+        void HandleClick(const std::vector<PacketSequence>& displayOrder, int row) {
+            const ImGuiIO& io = ImGui::GetIO();
+            const PacketSequence sequence = displayOrder[row];
+            if (io.KeyShift && s_anchor != INVALID_PACKET_SEQUENCE) {
+                auto anchor = std::find(displayOrder.begin(), displayOrder.end(), s_anchor);
+                if (anchor != displayOrder.end()) {
+                    if (!io.KeyCtrl) ClearSelection();
+                    const int anchorRow = static_cast<int>(anchor - displayOrder.begin());
+                    for (int r = std::min(row, anchorRow); r <= std::max(row, anchorRow); ++r) {
+                        SetSelected(displayOrder[r], true);
+                    }
+                    return;
+                }
+            }
+            if (io.KeyCtrl) {
+                SetSelected(sequence, !IsSelected(sequence));
+            }
+            else {
+                ClearSelection();
+                SetSelected(sequence, true);
+            }
+            s_anchor = sequence;
+        }
+
+        // Requires g_packetLogMutex. `position` is the packet's position in g_packetLog.
+        void RenderCells(std::size_t position, const PacketInfo& packet, const CachedRow* cached) {
+            ImGui::TableSetColumnIndex(Col_Time);
+            if (cached) ImGui::TextUnformatted(cached->time.c_str()); else ImGui::TextDisabled("...");
+            ImGui::TableNextColumn();
+            if (position > 0 && position < g_packetMetadata.Size()) {
+                const auto& ticks = g_packetMetadata.Ticks();
+                // Clamped: timestamps only decrease in the log if the clock was set back.
+                const std::chrono::system_clock::duration delta(std::max<std::int64_t>(0, ticks[position] - ticks[position - 1]));
+                ImGui::Text("%.3f", std::chrono::duration<double, std::milli>(delta).count());
+            }
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(packet.direction == PacketDirection::Sent ? "[S]" : "[R]");
+            ImGui::TableNextColumn(); ImGui::Text("0x%02X", packet.rawHeaderId);
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(packet.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%d", packet.size);
+            ImGui::TableNextColumn(); ImGui::Text("%d", packet.bufferState);
+            ImGui::TableNextColumn();
+            if (cached) ImGui::TextUnformatted(cached->preview.c_str()); else ImGui::TextDisabled("...");
+        }
+
+    } // anonymous namespace
+
+
+    void Shutdown() {
+        if (s_sortJob.valid()) {
+            s_sortJob.wait();
+            s_sortJob = {};
+        }
+    }
+
+    void RenderRows(const std::vector<PacketSequence>& filtered, float height) {
+        ++s_frame;
+        s_rowsFormattedThisFrame = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_packetLogMutex);
+            if (g_packetLogFirstSequence != s_logFirstSequence) {
+                s_logFirstSequence = g_packetLogFirstSequence;
+                ClearSelection();
+                s_rowCache.clear();
+                s_sortedView.clear();
+                s_sortDirty = true;
+            }
+        }
+
+        const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV
+            | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable
+            | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable | ImGuiTableFlags_SizingFixedFit;
+        if (!ImGui::BeginTable("PacketLogTable", Col_Count_, flags, ImVec2(0.0f, height))) {
+            return;
+        }
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_DefaultSort, 0.0f, static_cast<ImGuiID>(SortColumn::Sequence));
+        ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_None, 0.0f, static_cast<ImGuiID>(SortColumn::Time));
+        ImGui::TableSetupColumn("Delta (ms)", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, static_cast<ImGuiID>(SortColumn::DeltaTime));
+        ImGui::TableSetupColumn("Dir", ImGuiTableColumnFlags_None, 0.0f, static_cast<ImGuiID>(SortColumn::Direction));
+        ImGui::TableSetupColumn("Opcode", ImGuiTableColumnFlags_None, 0.0f, static_cast<ImGuiID>(SortColumn::Opcode));
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_None, 0.0f, static_cast<ImGuiID>(SortColumn::Name));
+        ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, static_cast<ImGuiID>(SortColumn::Size));
+        ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_None, 0.0f, static_cast<ImGuiID>(SortColumn::BufferState));
+        ImGui::TableSetupColumn("Preview", ImGuiTableColumnFlags_NoSort);
+        ImGui::TableHeadersRow();
+        const float headerBottom = ImGui::GetItemRectMax().y;
+
+        ReadSortSpecs();
+        const std::vector<PacketSequence>& displayOrder = GetDisplayOrder(filtered);
+
+        // Rows are plain text cells; the mouse is mapped to a row by position instead of
+        // giving every row its own selectable item.
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const float cellPaddingY = ImGui::GetStyle().CellPadding.y;
+        const float rowHeight = ImGui::GetTextLineHeight() + 2.0f * cellPaddingY;
+        const bool tableHovered = ImGui::IsWindowHovered() && !ImGui::IsAnyItemHovered() && mouse.y > headerBottom;
+        const ImU32 selectedColor = ImGui::GetColorU32(ImGuiCol_Header);
+        const ImU32 hoveredColor = ImGui::GetColorU32(ImGuiCol_HeaderHovered);
+
+        int hoveredRow = -1;
+        std::size_t visibleRows = 0;
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(displayOrder.size()));
+        while (clipper.Step()) {
+            std::lock_guard<std::mutex> lock(g_packetLogMutex);
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(Col_Sequence);
+                const PacketSequence sequence = displayOrder[row];
+                const float rowTop = ImGui::GetCursorScreenPos().y - cellPaddingY;
+                if (tableHovered && mouse.y >= rowTop && mouse.y < rowTop + rowHeight) {
+                    hoveredRow = row;
+                }
+                std::size_t position = 0;
+                if (!FindLogPosition(sequence, position)) continue;
+
+                if (IsSelected(sequence)) {
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, selectedColor);
+                }
+                else if (row == hoveredRow) {
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, hoveredColor);
+                }
+
+                const PacketInfo& packet = g_packetLog[position];
+                ImGui::Text("%llu", static_cast<unsigned long long>(sequence));
+                RenderCells(position, packet, GetRow(sequence, packet));
+                ++visibleRows;
+            }
+        }
+        clipper.End();
+
+        bool openContextMenu = false;
+        if (hoveredRow >= 0) {
+            if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+                HandleClick(displayOrder, hoveredRow);
+            }
+            else if (ImGui::IsMouseClicked(ImGuiMouseButton_Right)) {
+                if (!IsSelected(displayOrder[hoveredRow])) {
+                    HandleClick(displayOrder, hoveredRow); // Right-click on an unselected row selects it first
+                }
+                openContextMenu = true;
+            }
+        }
+
+        if (ImGui::IsWindowFocused()) {
+            const ImGuiIO& io = ImGui::GetIO();
+            if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_A, false)) {
+                SelectAll(displayOrder);
+            }
+            if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_C, false)) {
+                CopySelection(displayOrder);
+            }
+            if (ImGui::IsKeyPressed(ImGuiKey_Escape, false)) {
+                ClearSelection();
+            }
+        }
+
+        if (openContextMenu) {
+            ImGui::OpenPopup("##LogRowMenu");
+        }
+        if (ImGui::BeginPopup("##LogRowMenu")) {
+            char label[64];
+            snprintf(label, sizeof(label), "Copy %zu Row(s)", s_selectedCount);
+            if (ImGui::MenuItem(label, "Ctrl+C", false, s_selectedCount > 0)) {
+                CopySelection(displayOrder);
+            }
+            if (ImGui::MenuItem("Select All", "Ctrl+A")) {
+                SelectAll(displayOrder);
+            }
+            if (ImGui::MenuItem("Clear Selection", "Esc", false, s_selectedCount > 0)) {
+                ClearSelection();
+            }
+            ImGui::EndPopup();
+        }
+
+        // Auto-scroll to bottom if scrollbar is already at the end.
+        if (!displayOrder.empty() && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+            ImGui::SetScrollHereY(1.0f);
+        }
+
+        ImGui::EndTable();
+
+        // Drop cells of rows that scrolled out of view.
+        if (s_rowCache.size() > 2 * visibleRows + 64) {
+            for (auto it = s_rowCache.begin(); it != s_rowCache.end();) {
+                it = (it->second.lastFrame != s_frame) ? s_rowCache.erase(it) : std::next(it);
+            }
+        }
+    }
+
+    std::size_t SelectedCount() {
+        return s_selectedCount;
+    }
+
+    PacketSequence FocusedSequence() {
+        return s_anchor;
+    }
+
+    void ClearSelection() {
+        s_selected.clear();
+        s_selectedCount = 0;
+        s_anchor = INVALID_PACKET_SEQUENCE;
+    }
+
+} // namespace kx::LogView
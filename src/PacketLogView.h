@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+ * @file PacketLogView.h
+ * @brief Sortable packet log table with multi-row selection and copy.
+ * @details The log is an ImGui table (#, time, delta to the previous packet, direction,
+ *          opcode, name, size, buffer state, payload preview) that owns its scrolling and
+ *          freezes the header row. Only the rows in view are submitted, as plain text cells;
+ *          the time and preview cells are cached per log entry while the row stays on
+ *          screen, so the per-frame cost depends on the window height, not on the log size.
+ *          Interaction maps the mouse position to a row instead of giving each row an item.
+ *
+ *          Sorting: clicking a header sorts by that column (Shift+click adds secondary
+ *          columns). The filtered indices are ordered by a radix sort over the metadata
+ *          columns (see PacketSort.h); packets are never moved. The sorted view is rebuilt
+ *          when the sort changes and at most every 250 ms while rows are added or filters
+ *          change, on a worker that holds the log lock only while copying a chunk of keys.
+ *          The default sort (# ascending) is the capture order and costs nothing.
+ *
+ *          Selection: click selects one row, Ctrl+click toggles, Shift+click extends from the
+ *          last clicked row; Ctrl+A selects all filtered rows and Ctrl+C (or the context menu)
+ *          copies the selected rows untruncated, in display order. Selection is kept by packet
+ *          sequence, so it survives filter and sort changes.
+ */
+
+#include <cstddef>
+#include <vector>
+#include "PacketData.h" // For PacketSequence
+
+namespace kx::LogView {
+
+    /**
+     * @brief Draws the filtered log as a table.
+     * @param filtered Sequences of the packets to show, in capture order.
+     * @param height Table height in pixels; 0 fills the remaining content region.
+     * @details Takes g_packetLogMutex while reading packets; the caller must not hold it.
+     */
+    void RenderRows(const std::vector<PacketSequence>& filtered, float height = 0.0f);
+
+    std::size_t SelectedCount();
+
+    /**
+     * @brief Sequence of the last clicked packet (the detail pane shows it), or
+     *        INVALID_PACKET_SEQUENCE.
+     */
+    PacketSequence FocusedSequence();
+
+    void ClearSelection();
+
+    /**
+     * @brief Waits for a running sort and releases it, so no std::async state is left for
+     *        static destruction at unload. Call when no frame is being rendered.
+     */
+    void Shutdown();
+
+} // namespace kx::LogView
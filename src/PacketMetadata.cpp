@@ -0,0 +1,46 @@
+#include "PacketMetadata.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace kx {
+
+    PacketMetadataStore g_packetMetadata;
+
+    void PacketMetadataStore::Append(const PacketInfo& packet) {
+        m_direction.PushBack(packet.direction == PacketDirection::Sent ? 0 : 1);
+        m_header.PushBack(packet.rawHeaderId);
+        m_type.PushBack(static_cast<std::uint8_t>(packet.specialType));
+        m_size.PushBack(static_cast<std::uint32_t>(std::clamp<long long>(packet.size, 0, std::numeric_limits<std::uint32_t>::max())));
+        m_ticks.PushBack(static_cast<std::int64_t>(packet.timestamp.time_since_epoch().count()));
+        m_bufferState.PushBack(packet.bufferState);
+    }
+
+    void PacketMetadataStore::Clear() {
+        m_direction.Clear();
+        m_header.Clear();
+        m_type.Clear();
+        m_size.Clear();
+        m_ticks.Clear();
+        m_bufferState.Clear();
+    }
+
+    void PacketMetadataStore::Reserve(std::size_t count) {
+        m_direction.Reserve(count);
+        m_header.Reserve(count);
+        m_type.Reserve(count);
+        m_size.Reserve(count);
+        m_ticks.Reserve(count);
+        m_bufferState.Reserve(count);
+    }
+
+    PacketMetadataStore BuildPacketMetadata(const std::deque<PacketInfo>& log) {
+        PacketMetadataStore store;
+        store.Reserve(log.size());
+        for (const auto& packet : log) {
+            store.Append(packet);
+        }
+        return store;
+    }
+
+} // namespace kx
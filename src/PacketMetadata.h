@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file PacketMetadata.h
+ * @brief Structure-of-arrays index of the hot per-packet fields.
+ * @details PacketInfo interleaves the fields every filter pass reads (direction, header,
+ *          type, size, timestamp) with large cold members (name, RC4 snapshot, payload
+ *          vectors), so scanning the deque touches several cache lines per packet. This
+ *          store keeps the hot fields in packed, index-aligned columns next to g_packetLog
+ *          so scans stream through a few bytes per packet instead.
+ *
+ *          Columns are chunked (CHUNK_ROWS rows per chunk), so an append under the log lock
+ *          never reallocates and copies the existing rows. Scans that need raw arrays walk
+ *          the store one contiguous run at a time (ContiguousRows()).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include "ChunkedArray.h"
+#include "PacketData.h" // For PacketInfo
+
+namespace kx {
+
+    class PacketMetadataStore {
+    public:
+        static constexpr std::size_t CHUNK_ROWS = 16384;
+
+        template <typename T>
+        using Column = ChunkedArray<T, CHUNK_ROWS>;
+
+        void Append(const PacketInfo& packet);
+        void Clear();
+        void Reserve(std::size_t count);
+
+        std::size_t Size() const { return m_direction.Size(); }
+
+        // Rows [first, first + ContiguousRows(first)) are contiguous in every column.
+        std::size_t ContiguousRows(std::size_t first) const { return m_direction.ContiguousSize(first); }
+
+        // Column accessors. All columns have Size() entries, index-aligned with the log.
+        const Column<std::uint8_t>& Directions() const { return m_direction; }   // 0 = sent, 1 = received
+        const Column<std::uint8_t>& Headers() const { return m_header; }         // rawHeaderId
+        const Column<std::uint8_t>& Types() const { return m_type; }             // InternalPacketType
+        const Column<std::uint32_t>& Sizes() const { return m_size; }
+        const Column<std::int64_t>& Ticks() const { return m_ticks; }            // system_clock ticks since epoch
+        const Column<std::int32_t>& BufferStates() const { return m_bufferState; }
+
+    private:
+        Column<std::uint8_t> m_direction;
+        Column<std::uint8_t> m_header;
+        Column<std::uint8_t> m_type;
+        Column<std::uint32_t> m_size;
+        Column<std::int64_t> m_ticks;
+        Column<std::int32_t> m_bufferState;
+    };
+
+    /**
+     * @brief Builds a metadata store for an arbitrary log (e.g. benchmark data).
+     */
+    PacketMetadataStore BuildPacketMetadata(const std::deque<PacketInfo>& log);
+
+    // Metadata for g_packetLog. Guarded by g_packetLogMutex and always appended/cleared
+    // together with the log, so index i describes g_packetLog[i].
+    extern PacketMetadataStore g_packetMetadata;
+
+} // namespace kx
@@ -0,0 +1,77 @@
+#include "PacketPayload.h"
+
+#include <cstring>
+
+namespace kx {
+
+    PacketPayload::PacketPayload(PacketPayload&& other) noexcept {
+        if (other.m_onHeap) {
+            m_heap = other.m_heap;
+            m_onHeap = true;
+            other.m_onHeap = false;
+        }
+        else {
+            std::memcpy(m_inline, other.m_inline, other.m_size);
+        }
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+
+    PacketPayload& PacketPayload::operator=(const PacketPayload& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    PacketPayload& PacketPayload::operator=(PacketPayload&& other) noexcept {
+        if (this != &other) {
+            Release();
+            if (other.m_onHeap) {
+                m_heap = other.m_heap;
+                m_onHeap = true;
+                other.m_onHeap = false;
+            }
+            else {
+                std::memcpy(m_inline, other.m_inline, other.m_size);
+            }
+            m_size = other.m_size;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    void PacketPayload::assign(const std::uint8_t* first, const std::uint8_t* last) {
+        const std::size_t count = static_cast<std::size_t>(last - first);
+        // Keep the old heap block alive until the copy is done, since the range may point into it.
+        std::uint8_t* oldHeap = m_onHeap ? m_heap : nullptr;
+
+        if (count <= INLINE_CAPACITY) {
+            if (count > 0) {
+                std::memmove(m_inline, first, count);
+            }
+            m_onHeap = false;
+        }
+        else {
+            std::uint8_t* block = new std::uint8_t[count];
+            std::memcpy(block, first, count);
+            m_heap = block;
+            m_onHeap = true;
+        }
+        m_size = static_cast<std::uint32_t>(count);
+        delete[] oldHeap;
+    }
+
+    void PacketPayload::clear() noexcept {
+        Release();
+        m_size = 0;
+    }
+
+    void PacketPayload::Release() noexcept {
+        if (m_onHeap) {
+            delete[] m_heap;
+            m_onHeap = false;
+        }
+    }
+
+} // namespace kx
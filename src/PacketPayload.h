@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @file PacketPayload.h
+ * @brief Byte buffer with inline storage for short packets.
+ * @details Most CMSG traffic (heartbeats, movement, jumps) is a few tens of bytes, so a
+ *          std::vector per payload costs a heap allocation plus allocator overhead for
+ *          every captured packet. PacketPayload keeps up to INLINE_CAPACITY bytes inside
+ *          the object and only allocates for longer packets. It exposes the subset of the
+ *          std::vector interface the inspector uses (data/size/empty/iterators/indexing).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kx {
+
+    class PacketPayload {
+    public:
+        static constexpr std::size_t INLINE_CAPACITY = 48;
+
+        PacketPayload() noexcept {}
+        PacketPayload(const std::uint8_t* bytes, std::size_t size) { assign(bytes, bytes + size); }
+        explicit PacketPayload(const std::vector<std::uint8_t>& bytes) { assign(bytes.data(), bytes.data() + bytes.size()); }
+
+        PacketPayload(const PacketPayload& other) { assign(other.begin(), other.end()); }
+        PacketPayload(PacketPayload&& other) noexcept;
+        PacketPayload& operator=(const PacketPayload& other);
+        PacketPayload& operator=(PacketPayload&& other) noexcept;
+        ~PacketPayload() { Release(); }
+
+        /**
+         * @brief Replaces the contents with [first, last). The range may alias this payload.
+         */
+        void assign(const std::uint8_t* first, const std::uint8_t* last);
+        void clear() noexcept;
+
+        std::uint8_t* data() noexcept { return m_onHeap ? m_heap : m_inline; }
+        const std::uint8_t* data() const noexcept { return m_onHeap ? m_heap : m_inline; }
+        std::size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        std::uint8_t* begin() noexcept { return data(); }
+        std::uint8_t* end() noexcept { return data() + m_size; }
+        const std::uint8_t* begin() const noexcept { return data(); }
+        const std::uint8_t* end() const noexcept { return data() + m_size; }
+
+        std::uint8_t& operator[](std::size_t index) noexcept { return data()[index]; }
+        const std::uint8_t& operator[](std::size_t index) const noexcept { return data()[index]; }
+
+        bool IsInline() const noexcept { return !m_onHeap; }
+        std::size_t HeapBytes() const noexcept { return m_onHeap ? m_size : 0; }
+        std::vector<std::uint8_t> ToVector() const { return std::vector<std::uint8_t>(begin(), end()); }
+
+    private:
+        void Release() noexcept;
+
+        union {
+            std::uint8_t m_inline[INLINE_CAPACITY];
+            std::uint8_t* m_heap;
+        };
+        std::uint32_t m_size = 0;
+        bool m_onHeap = false;
+    };
+
+} // namespace kx
@@ -5,19 +5,51 @@
 // Now include your project headers and standard library headers
 #include "PacketProcessor.h"
 #include "PacketData.h"
+#include "PacketStaging.h"
 #include "AppState.h"
 #include "PacketHeaders.h"
 #include "CryptoUtils.h"
 #include "GameStructs.h" // Included via PacketProcessor.h but good practice
+#include "CaptureControl.h"
+#include "CapturePolicy.h"
 
 #include <vector>
+#include <algorithm>
 #include <chrono>
-#include <mutex>
 #include <limits>
 #include <cstring> // For memcpy
 
 namespace kx::PacketProcessing {
 
+    namespace {
+
+        // Single point where processed packets enter shared state. They are staged on the
+        // calling thread and published to the statistics, rate graphs, timeline and log in
+        // batches (see PacketStaging.h), which also timestamps them. For encrypted packets,
+        // rc4Snapshot/rc4After are the states before and after the payload.
+        void PublishPacket(PacketInfo&& info,
+            const GameStructs::RC4State* rc4Snapshot = nullptr,
+            const GameStructs::RC4State* rc4After = nullptr)
+        {
+            Staging::StagePacket(std::move(info), rc4Snapshot, rc4After);
+        }
+
+        // Packets rejected by the capture policy still count towards statistics and rate graphs.
+        // For encrypted packets the RC4 states keep the snapshot pool's stream continuous.
+        void RecordSkippedPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+            const GameStructs::RC4State* rc4Snapshot = nullptr,
+            const GameStructs::RC4State* rc4After = nullptr)
+        {
+            TrafficSample sample;
+            sample.size = static_cast<std::uint32_t>(std::min<std::size_t>(size, std::numeric_limits<std::uint32_t>::max()));
+            sample.direction = direction;
+            sample.headerId = headerId;
+            sample.skipped = true;
+            Staging::StageSkippedPacket(sample, rc4Snapshot, rc4After);
+        }
+
+    } // anonymous namespace
+
     void ProcessOutgoingPacket(const GameStructs::MsgSendContext* context) {
         // Basic check (hook should ideally ensure non-null, but double-check)
         if (!context) {
@@ -69,29 +101,31 @@ namespace kx::PacketProcessing {
             // --- End Sanity Checks ---
 
             if (dataIsValid && bufferSize > 0) {
+                // Apply the capture policy before copying anything.
+                const Capture::Admission admission = Capture::AdmitPacket(PacketDirection::Sent, packetData[0], bufferSize, true);
+                if (!admission.capture) {
+                    RecordSkippedPacket(PacketDirection::Sent, packetData[0], bufferSize);
+                    return;
+                }
+
                 PacketInfo info;
-                info.timestamp = std::chrono::system_clock::now();
                 info.size = static_cast<int>(bufferSize);
                 info.direction = PacketDirection::Sent;
                 info.bufferState = context->bufferState;
                 info.specialType = InternalPacketType::NORMAL; // Assume normal
 
-                // Copy packet data
-                info.data.assign(packetData, packetData + bufferSize);
+                // Copy packet data (only the first bytes for header-only capture)
+                info.data.assign(packetData, packetData + admission.keepBytes);
 
                 // Analyze header
                 info.rawHeaderId = info.data[0];
                 info.name = GetPacketName(info.direction, info.rawHeaderId); // Use directional lookup
 
                 // Log the packet
-                {
-                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
-                    g_packetLog.push_back(std::move(info));
-                }
+                PublishPacket(std::move(info));
             }
             else if (dataIsValid && bufferSize == 0) {
                 PacketInfo info;
-                info.timestamp = std::chrono::system_clock::now();
                 info.size = 0;
                 info.direction = PacketDirection::Sent;
                 info.bufferState = context->bufferState;
@@ -99,10 +133,7 @@ namespace kx::PacketProcessing {
                 info.name = GetSpecialPacketTypeName(info.specialType);
                 info.rawHeaderId = 0; // Or some default
                 // Log the empty packet info
-                {
-                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
-                    g_packetLog.push_back(std::move(info));
-                }
+                PublishPacket(std::move(info));
             }
         }
         catch (const std::exception& e) {
@@ -146,45 +177,94 @@ namespace kx::PacketProcessing {
         }
 
         try {
+            // --- Capture Policy ---
+            // Only evaluated while a policy is active. The header of an encrypted packet is
+            // found by decrypting one byte on a copy of the RC4 state, before any payload copy.
+            Capture::Admission admission;
+            admission.keepBytes = size;
+            if (Capture::g_captureControl.IsSet(Capture::CONTROL_SAMPLING)) {
+                std::uint8_t header = 0;
+                bool headerKnown = false;
+                GameStructs::RC4State probe;
+                if (size > 0 && capturedRc4State.has_value()) {
+                    probe = capturedRc4State.value();
+                    header = buffer[0];
+                    Crypto::rc4_process_stream(probe, &header, 1);
+                    headerKnown = true;
+                }
+                else if (size > 0 && currentState != 3) {
+                    header = buffer[0];
+                    headerKnown = true;
+                }
+                admission = Capture::AdmitPacket(PacketDirection::Received, header, size, headerKnown);
+                if (!admission.capture) {
+                    if (size > 0 && capturedRc4State.has_value()) {
+                        // Skipping the rest of the keystream yields the next packet's snapshot,
+                        // so the pool can keep sharing keyframes across unlogged packets.
+                        Crypto::rc4_skip(probe, size - 1);
+                        RecordSkippedPacket(PacketDirection::Received, header, size, &capturedRc4State.value(), &probe);
+                    }
+                    else {
+                        RecordSkippedPacket(PacketDirection::Received, header, size);
+                    }
+                    return;
+                }
+            }
+            // --- End Capture Policy ---
+
             PacketInfo info;
-            info.timestamp = std::chrono::system_clock::now();
             info.size = static_cast<int>(size);
             info.direction = PacketDirection::Received;
             info.bufferState = currentState;
-            info.rc4State = capturedRc4State; // Store captured state
             info.specialType = InternalPacketType::NORMAL; // Assume normal initially
             info.rawHeaderId = 0; // Default
 
-            // Copy original data (even if empty)
+            // Copy original data (even if empty; only the first bytes for header-only capture)
             if (size > 0) {
-                info.data.assign(buffer, buffer + size);
+                info.data.assign(buffer, buffer + admission.keepBytes);
             }
 
             // --- Decrypt Data if Applicable ---
             bool wasDecrypted = false;
             bool decryptionAttempted = false;
-            if (info.rc4State.has_value() && !info.data.empty()) {
+            bool decryptionDeferred = false;
+            std::uint8_t deferredHeader = 0;
+            GameStructs::RC4State rc4After; // Keystream position after this packet
+            if (capturedRc4State.has_value()) {
+                rc4After = capturedRc4State.value();
+            }
+            if (capturedRc4State.has_value() && !info.data.empty()) {
                 decryptionAttempted = true; // Mark that we tried
-                // ... decryption logic using Crypto::rc4_process_copy ...
-                if (/* decryption successful */ true) { // Assume success for now
-                    // info.decryptedData = ... result ...
-                    wasDecrypted = true;
+                if (Capture::g_captureControl.IsSet(Capture::CONTROL_LAZY_DECRYPTION)) {
+                    // Only the header byte is needed now; the rest of the keystream is skipped
+                    // without producing output and the payload is decrypted when viewed.
+                    deferredHeader = info.data[0];
+                    Crypto::rc4_process_stream(rc4After, &deferredHeader, 1);
+                    Crypto::rc4_skip(rc4After, size - 1);
+                    decryptionDeferred = true;
                 }
                 else {
-                    info.specialType = InternalPacketType::PROCESSING_ERROR; // Mark decryption failure
+                    // The snapshot was taken before the game processed this buffer, so running
+                    // the PRGA from it over the ciphertext yields the plaintext. Streaming on a
+                    // copy also yields the next snapshot, which the pool uses to detect continuity.
+                    PacketPayload decrypted = info.data;
+                    Crypto::rc4_process_stream(rc4After, decrypted.data(), decrypted.size());
+                    Crypto::rc4_skip(rc4After, size - decrypted.size()); // Bytes dropped by header-only capture
+                    info.decryptedData = std::move(decrypted);
                 }
+                wasDecrypted = true;
             }
             // --- End Decryption ---
 
 
             // --- Packet Analysis ---
-            const std::vector<uint8_t>& dataToAnalyze = info.GetDisplayData();
+            const PacketPayload& dataToAnalyze = info.GetDisplayData();
 
             // Prioritize special states
             if (info.specialType == InternalPacketType::PROCESSING_ERROR) {
                 info.name = GetSpecialPacketTypeName(info.specialType);
             }
-            else if (currentState == 3 && !wasDecrypted && !info.rc4State.has_value()) {
+            else if (currentState == 3 && !wasDecrypted && !capturedRc4State.has_value()) {
                 // If state was 3 but we failed to capture state, mark it specifically
                 info.specialType = InternalPacketType::ENCRYPTED_RC4; // Or a subtype?
                 info.name = "Encrypted (RC4 State Read Fail)";
@@ -206,7 +286,7 @@ namespace kx::PacketProcessing {
             else {
                 // If none of the above, it's a "NORMAL" packet (decrypted or plaintext)
                 info.specialType = InternalPacketType::NORMAL;
-                info.rawHeaderId = dataToAnalyze[0];
+                info.rawHeaderId = decryptionDeferred ? deferredHeader : dataToAnalyze[0];
                 info.name = GetPacketName(info.direction, info.rawHeaderId); // Use directional lookup
 
                 // Check if GetPacketName returned an "Unknown" formatted string
@@ -218,9 +298,11 @@ namespace kx::PacketProcessing {
 
 
             // Log the processed packet info
-            {
-                std::lock_guard<std::mutex> lock(g_packetLogMutex);
-                g_packetLog.push_back(std::move(info));
+            if (capturedRc4State.has_value()) {
+                PublishPacket(std::move(info), &capturedRc4State.value(), &rc4After);
+            }
+            else {
+                PublishPacket(std::move(info));
             }
         }
         catch (const std::exception& e) {
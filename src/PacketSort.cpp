@@ -0,0 +1,251 @@
+#include "PacketSort.h"
+#include "PacketHeaders.h"   // For GetPacketName, GetSpecialPacketTypeName
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace kx::Sorting {
+
+    namespace {
+
+        // 11-bit digits: a 64-bit key needs at most 6 passes, a 32-bit range 3, and one
+        // histogram (16 KiB) still fits in L1.
+        constexpr int RADIX_BITS = 11;
+        constexpr std::size_t RADIX_SIZE = std::size_t(1) << RADIX_BITS;
+        constexpr std::uint64_t RADIX_MASK = RADIX_SIZE - 1;
+        constexpr std::size_t MIN_ROWS_PER_THREAD = 64 * 1024;
+        constexpr unsigned MAX_SORT_THREADS = 16;
+        constexpr std::size_t TYPE_COUNT = static_cast<std::size_t>(InternalPacketType::PROCESSING_ERROR) + 1;
+        constexpr std::uint64_t SIGN_BIT = 1ull << 63;
+
+        // Maps a signed value to an unsigned key with the same ordering.
+        std::uint64_t OrderedKey(std::int64_t value) {
+            return static_cast<std::uint64_t>(value) ^ SIGN_BIT;
+        }
+
+        // Alphabetical rank of every packet name, by [type][direction][header]. The name of a
+        // special type does not depend on direction and header, so those slots repeat it.
+        struct NameRanks {
+            std::uint16_t rank[TYPE_COUNT][2][256] = {};
+        };
+
+        NameRanks BuildNameRanks() {
+            std::vector<std::string> names(TYPE_COUNT * 2 * 256);
+            for (std::size_t type = 0; type < TYPE_COUNT; ++type) {
+                const auto specialType = static_cast<InternalPacketType>(type);
+                const bool named = specialType == InternalPacketType::NORMAL || specialType == InternalPacketType::UNKNOWN_HEADER;
+                const std::string specialName = named ? std::string() : GetSpecialPacketTypeName(specialType);
+                for (int dir = 0; dir < 2; ++dir) {
+                    for (int header = 0; header < 256; ++header) {
+                        names[(type * 2 + dir) * 256 + header] = named
+                            ? GetPacketName(dir == 0 ? PacketDirection::Sent : PacketDirection::Received, static_cast<std::uint8_t>(header))
+                            : specialName;
+                    }
+                }
+            }
+
+            std::vector<std::string> sorted = names;
+            std::sort(sorted.begin(), sorted.end());
+            sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+            NameRanks ranks;
+            for (std::size_t slot = 0; slot < names.size(); ++slot) {
+                const auto rank = std::lower_bound(sorted.begin(), sorted.end(), names[slot]) - sorted.begin();
+                ranks.rank[slot / 512][(slot / 256) % 2][slot % 256] = static_cast<std::uint16_t>(rank);
+            }
+            return ranks;
+        }
+
+        const NameRanks& GetNameRanks() {
+            static const NameRanks ranks = BuildNameRanks();
+            return ranks;
+        }
+
+        unsigned ChooseThreadCount(std::size_t rows, unsigned requested) {
+            if (requested == 0) {
+                requested = std::max(1u, std::thread::hardware_concurrency());
+            }
+            const std::size_t byRows = std::max<std::size_t>(1, rows / MIN_ROWS_PER_THREAD);
+            return static_cast<unsigned>(std::min<std::size_t>({ requested, byRows, MAX_SORT_THREADS }));
+        }
+
+        // Runs fn(t) for t in [0, threads), t = 0 on the calling thread.
+        template <typename Fn>
+        void RunParallel(unsigned threads, Fn&& fn) {
+            if (threads <= 1) {
+                fn(0u);
+                return;
+            }
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            for (unsigned t = 1; t < threads; ++t) {
+                workers.emplace_back([&fn, t]() { fn(t); });
+            }
+            fn(0u);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        // Key of `column` for metadata row i; `sequence` is the row's capture-order key.
+        std::uint64_t RowKey(const PacketMetadataStore& metadata, std::size_t i, std::uint64_t sequence, SortColumn column) {
+            const auto& ticks = metadata.Ticks();
+            const auto& directions = metadata.Directions();
+            const auto& headers = metadata.Headers();
+            const auto& types = metadata.Types();
+            switch (column) {
+                case SortColumn::Sequence:    return sequence;
+                case SortColumn::Time:        return OrderedKey(ticks[i]);
+                case SortColumn::DeltaTime:   return OrderedKey(i > 0 ? std::max<std::int64_t>(0, ticks[i] - ticks[i - 1]) : 0); // As displayed
+                case SortColumn::Direction:   return directions[i];
+                case SortColumn::Opcode:      return headers[i];
+                case SortColumn::Name:
+                    return types[i] < TYPE_COUNT ? GetNameRanks().rank[types[i]][directions[i] & 1][headers[i]] : 0xFFFFu;
+                case SortColumn::Size:        return metadata.Sizes()[i];
+                case SortColumn::BufferState: return OrderedKey(metadata.BufferStates()[i]);
+                default:                      return 0;
+            }
+        }
+
+        // Sorts a permutation of positions by the key columns, least significant first.
+        // Consumes `keys`.
+        std::vector<std::uint32_t> SortPermutation(std::size_t count, std::vector<std::vector<std::uint64_t>>& keys, unsigned threadCount) {
+            std::vector<std::uint32_t> permutation(count);
+            std::iota(permutation.begin(), permutation.end(), 0u);
+            std::vector<std::uint64_t> current;
+            for (std::size_t k = keys.size(); k-- > 0;) {
+                if (k + 1 == keys.size()) {
+                    current = std::move(keys[k]); // Permutation is still the identity
+                }
+                else {
+                    for (std::size_t j = 0; j < count; ++j) {
+                        current[j] = keys[k][permutation[j]];
+                    }
+                    keys[k] = {};
+                }
+                RadixSortPairs(current, permutation, threadCount);
+            }
+            keys.clear();
+            return permutation;
+        }
+
+        template <typename T>
+        void ApplyPermutation(std::vector<T>& values, const std::vector<std::uint32_t>& permutation) {
+            std::vector<T> sorted(values.size());
+            for (std::size_t j = 0; j < values.size(); ++j) {
+                sorted[j] = values[permutation[j]];
+            }
+            values.swap(sorted);
+        }
+
+    } // anonymous namespace
+
+
+    std::vector<std::uint64_t> BuildSortKeys(const PacketMetadataStore& metadata, const std::vector<int>& indices, const SortSpec& spec) {
+        std::vector<std::uint64_t> keys(indices.size());
+        for (std::size_t j = 0; j < indices.size(); ++j) {
+            const std::size_t i = static_cast<std::size_t>(indices[j]);
+            const std::uint64_t key = RowKey(metadata, i, i, spec.column);
+            keys[j] = spec.descending ? ~key : key;
+        }
+        return keys;
+    }
+
+    std::vector<std::uint64_t> BuildSortKeys(const PacketMetadataStore& metadata, const std::vector<PacketSequence>& sequences,
+        PacketSequence firstSequence, const SortSpec& spec)
+    {
+        std::vector<std::uint64_t> keys(sequences.size());
+        for (std::size_t j = 0; j < sequences.size(); ++j) {
+            const std::uint64_t key = RowKey(metadata, static_cast<std::size_t>(sequences[j] - firstSequence), sequences[j], spec.column);
+            keys[j] = spec.descending ? ~key : key;
+        }
+        return keys;
+    }
+
+    void RadixSortPairs(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, unsigned threadCount) {
+        const std::size_t count = keys.size();
+        if (count < 2) {
+            return;
+        }
+
+        // Sorting key - min instead of key keeps the order and leaves only log2(max - min)
+        // significant bits; digits above them need no pass.
+        const auto [minKey, maxKey] = std::minmax_element(keys.begin(), keys.end());
+        const std::uint64_t base = *minKey;
+        const std::uint64_t range = *maxKey - base;
+        if (range == 0) {
+            return;
+        }
+        int significantBits = 0;
+        while (significantBits < 64 && (range >> significantBits) != 0) {
+            ++significantBits;
+        }
+
+        const unsigned threads = ChooseThreadCount(count, threadCount);
+        std::vector<std::array<std::size_t, RADIX_SIZE>> offsets(threads);
+        std::vector<std::uint64_t> scratchKeys(count);
+        std::vector<std::uint32_t> scratchValues(count);
+        auto rangeBegin = [&](unsigned t) { return count * t / threads; };
+
+        for (int shift = 0; shift < significantBits; shift += RADIX_BITS) {
+            RunParallel(threads, [&](unsigned t) {
+                auto& histogram = offsets[t];
+                histogram.fill(0);
+                for (std::size_t i = rangeBegin(t), end = rangeBegin(t + 1); i < end; ++i) {
+                    ++histogram[((keys[i] - base) >> shift) & RADIX_MASK];
+                }
+            });
+
+            // Digit-major prefix sum: thread t writes its rows of digit d after those of
+            // threads < t, which keeps the pass stable.
+            std::size_t running = 0;
+            for (std::size_t digit = 0; digit < RADIX_SIZE; ++digit) {
+                for (unsigned t = 0; t < threads; ++t) {
+                    const std::size_t rows = offsets[t][digit];
+                    offsets[t][digit] = running;
+                    running += rows;
+                }
+            }
+
+            RunParallel(threads, [&](unsigned t) {
+                auto& next = offsets[t];
+                for (std::size_t i = rangeBegin(t), end = rangeBegin(t + 1); i < end; ++i) {
+                    const std::size_t position = next[((keys[i] - base) >> shift) & RADIX_MASK]++;
+                    scratchKeys[position] = keys[i];
+                    scratchValues[position] = values[i];
+                }
+            });
+
+            keys.swap(scratchKeys);
+            values.swap(scratchValues);
+        }
+    }
+
+    void SortIndicesByKeys(std::vector<int>& indices, std::vector<std::vector<std::uint64_t>>& keys, unsigned threadCount) {
+        if (indices.size() < 2 || keys.empty()) {
+            return;
+        }
+        ApplyPermutation(indices, SortPermutation(indices.size(), keys, threadCount));
+    }
+
+    void SortIndicesByKeys(std::vector<PacketSequence>& sequences, std::vector<std::vector<std::uint64_t>>& keys, unsigned threadCount) {
+        if (sequences.size() < 2 || keys.empty()) {
+            return;
+        }
+        ApplyPermutation(sequences, SortPermutation(sequences.size(), keys, threadCount));
+    }
+
+    void SortIndices(std::vector<int>& indices, const PacketMetadataStore& metadata, const std::vector<SortSpec>& specs, unsigned threadCount) {
+        std::vector<std::vector<std::uint64_t>> keys;
+        keys.reserve(specs.size());
+        for (const SortSpec& spec : specs) {
+            keys.push_back(BuildSortKeys(metadata, indices, spec));
+        }
+        SortIndicesByKeys(indices, keys, threadCount);
+    }
+
+} // namespace kx::Sorting
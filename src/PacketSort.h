@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file PacketSort.h
+ * @brief Sorts views of the packet log by metadata columns without moving packets.
+ * @details A sort turns a list of log indices or packet sequences (e.g. the filtered view)
+ *          into the same list in display order. Each sort column is mapped to an unsigned 64-bit key
+ *          per row, read from the PacketMetadataStore columns, and the rows are ordered by
+ *          a stable LSD radix sort over those keys: 11-bit digits, only the digits in which
+ *          the keys actually differ, with the histogram and scatter of every pass split
+ *          across threads. Multi-column sorts run one radix sort per column from the least
+ *          to the most significant, which is correct because each one is stable.
+ *
+ *          Key extraction needs the metadata (and so g_packetLogMutex for the live store);
+ *          the sort itself works on the copied keys and can run without the lock.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PacketMetadata.h" // Also PacketSequence
+
+namespace kx::Sorting {
+
+    enum class SortColumn : int {
+        Sequence = 0,   // Capture order
+        Time,
+        DeltaTime,      // Time since the previous packet in the log
+        Direction,
+        Opcode,
+        Name,           // Alphabetical packet name
+        Size,           // Original packet size
+        BufferState,
+        Count
+    };
+
+    struct SortSpec {
+        SortColumn column = SortColumn::Sequence;
+        bool descending = false;
+    };
+
+    /**
+     * @brief Builds the key of `column` for every entry of `indices`.
+     * @return Keys aligned with `indices`; ascending key order is the column's ascending order
+     *         (descending specs have their keys inverted).
+     * @details Every index must be below metadata.Size(). Reads `metadata` only; the caller
+     *          holds whatever guards it.
+     */
+    std::vector<std::uint64_t> BuildSortKeys(const PacketMetadataStore& metadata, const std::vector<int>& indices, const SortSpec& spec);
+
+    /**
+     * @brief BuildSortKeys for packet sequences of a log whose first packet is `firstSequence`.
+     * @details Every sequence must describe a row of `metadata`. The Sequence column sorts by
+     *          the sequence itself.
+     */
+    std::vector<std::uint64_t> BuildSortKeys(const PacketMetadataStore& metadata, const std::vector<PacketSequence>& sequences,
+        PacketSequence firstSequence, const SortSpec& spec);
+
+    /**
+     * @brief Stably reorders `indices` by `keys`, keys[0] being the most significant column.
+     * @param keys One key vector per column, each aligned with `indices`. Consumed.
+     * @param threadCount Worker threads; 0 picks one per hardware thread for large inputs.
+     */
+    void SortIndicesByKeys(std::vector<int>& indices, std::vector<std::vector<std::uint64_t>>& keys, unsigned threadCount = 0);
+    void SortIndicesByKeys(std::vector<PacketSequence>& sequences, std::vector<std::vector<std::uint64_t>>& keys, unsigned threadCount = 0);
+
+    /**
+     * @brief BuildSortKeys for every spec followed by SortIndicesByKeys.
+     */
+    void SortIndices(std::vector<int>& indices, const PacketMetadataStore& metadata, const std::vector<SortSpec>& specs, unsigned threadCount = 0);
+
+    /**
+     * @brief Stable LSD radix sort of (key, value) pairs by key, in place.
+     * @details Exposed for the benchmark suite.
+     */
+    void RadixSortPairs(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values, unsigned threadCount = 0);
+
+} // namespace kx::Sorting
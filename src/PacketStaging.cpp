@@ -0,0 +1,288 @@
+#include "PacketStaging.h"
+#include "ControlLoop.h"     // For ScheduleOnce
+#include "PacketMetadata.h"  // For g_packetMetadata
+#include "RC4SnapshotPool.h" // For g_rc4Snapshots
+#include "PacketStatistics.h"
+#include "TrafficTimeSeries.h"
+#include "TrafficTimeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace kx::Staging {
+
+    namespace {
+
+        struct StagedPacket {
+            PacketInfo info;
+            bool logged = true;             // False for a skipped packet staged only for its keystream
+            bool hasRc4 = false;
+            GameStructs::RC4State rc4Snapshot;
+            GameStructs::RC4State rc4After;
+        };
+
+        // One thread's staging buffer. The mutex is only held to stage a packet or to take
+        // the staged packets for publishing.
+        struct Stager {
+            std::mutex mutex;
+            std::vector<StagedPacket> packets;
+            std::vector<TrafficSample> samples; // Every staged packet, logged or skipped, in order
+            bool leased = false;                // Owned by a live thread; guarded by s_registryMutex
+
+            // Packets taken for publishing, swapped with the vectors above so both keep their
+            // capacity. Guarded by s_publishMutex.
+            std::vector<StagedPacket> publishingPackets;
+            std::vector<TrafficSample> publishingSamples;
+        };
+
+        std::atomic<bool> s_batching{ true };
+        std::atomic<bool> s_flushScheduled{ false }; // A one-shot flush is pending on the control loop
+        std::atomic<std::uint64_t> s_batches{ 0 };
+        std::atomic<std::uint64_t> s_publishedPackets{ 0 };
+        std::atomic<std::uint64_t> s_skippedPackets{ 0 };
+
+        // Buffers are never freed while the DLL is loaded. A thread that exits hands its
+        // buffer back for the next new thread; packets left in it are published by FlushAll().
+        std::mutex s_registryMutex;
+        std::vector<std::unique_ptr<Stager>> s_stagers;
+
+        // Serializes publishing, so one batch is appended completely before the next is taken.
+        std::mutex s_publishMutex;
+        std::vector<TrafficSample> s_mergedSamples; // Guarded by s_publishMutex
+
+        // Releases the thread's buffer when the thread exits. It does not publish: thread
+        // exit runs under the loader lock, which must not be held while waiting for the log.
+        struct Lease {
+            Stager* stager = nullptr;
+
+            ~Lease() {
+                if (stager) {
+                    std::lock_guard<std::mutex> lock(s_registryMutex);
+                    stager->leased = false;
+                }
+            }
+        };
+
+        thread_local Lease t_lease;
+
+        Stager& ThisThreadStager() {
+            if (!t_lease.stager) {
+                std::lock_guard<std::mutex> lock(s_registryMutex);
+                auto free = std::find_if(s_stagers.begin(), s_stagers.end(), [](const auto& stager) { return !stager->leased; });
+                if (free == s_stagers.end()) {
+                    s_stagers.push_back(std::make_unique<Stager>());
+                    free = s_stagers.end() - 1;
+                }
+                (*free)->leased = true;
+                t_lease.stager = free->get();
+            }
+            return *t_lease.stager;
+        }
+
+        // Calls visit(element) for the elements of all buffers in timestamp order. Only the
+        // heads of the buffers are compared, so each buffer keeps its own order even if its
+        // timestamps are not monotonic (clock adjustments).
+        template <typename T, typename TimeOf, typename Visit>
+        void MergeByTime(const std::vector<std::vector<T>*>& buffers, TimeOf timeOf, Visit visit) {
+            std::vector<std::size_t> next(buffers.size(), 0);
+            for (;;) {
+                std::size_t earliest = buffers.size();
+                for (std::size_t b = 0; b < buffers.size(); ++b) {
+                    if (next[b] < buffers[b]->size()
+                        && (earliest == buffers.size() || timeOf((*buffers[b])[next[b]]) < timeOf((*buffers[earliest])[next[earliest]]))) {
+                        earliest = b;
+                    }
+                }
+                if (earliest == buffers.size()) {
+                    return;
+                }
+                visit((*buffers[earliest])[next[earliest]++]);
+            }
+        }
+
+        // Takes the packets staged by every thread and publishes them as one batch, merged
+        // by timestamp, taking each aggregate's lock and the log lock once. The buffers are
+        // taken while holding all their locks at once: packets are stamped under their
+        // buffer's lock, so every packet of this batch is stamped before any packet of a
+        // later one. Staging threads only wait while the buffers are being swapped out.
+        void PublishAll() {
+            std::lock_guard<std::mutex> publishLock(s_publishMutex);
+            std::vector<Stager*> taken;
+            {
+                std::lock_guard<std::mutex> registryLock(s_registryMutex);
+                std::vector<std::unique_lock<std::mutex>> locks;
+                locks.reserve(s_stagers.size());
+                for (const auto& stager : s_stagers) {
+                    locks.emplace_back(stager->mutex);
+                }
+                for (const auto& stager : s_stagers) {
+                    if (stager->samples.empty()) {
+                        continue;
+                    }
+                    stager->packets.swap(stager->publishingPackets);
+                    stager->samples.swap(stager->publishingSamples);
+                    taken.push_back(stager.get());
+                }
+            }
+            if (taken.empty()) {
+                return;
+            }
+
+            std::vector<std::vector<TrafficSample>*> sampleBuffers;
+            std::vector<std::vector<StagedPacket>*> packetBuffers;
+            bool anyPackets = false;
+            for (Stager* stager : taken) {
+                sampleBuffers.push_back(&stager->publishingSamples);
+                packetBuffers.push_back(&stager->publishingPackets);
+                anyPackets = anyPackets || !stager->publishingPackets.empty();
+            }
+
+            s_mergedSamples.clear();
+            std::uint64_t skipped = 0;
+            MergeByTime(sampleBuffers, [](const TrafficSample& sample) { return sample.timestamp; },
+                [&skipped](const TrafficSample& sample) {
+                    s_mergedSamples.push_back(sample);
+                    skipped += sample.skipped ? 1 : 0;
+                });
+
+            try {
+                Statistics::RecordPackets(s_mergedSamples.data(), s_mergedSamples.size());
+                TimeSeries::RecordPackets(s_mergedSamples.data(), s_mergedSamples.size());
+                Timeline::RecordPackets(s_mergedSamples.data(), s_mergedSamples.size());
+
+                if (anyPackets) {
+                    std::lock_guard<std::mutex> lock(g_packetLogMutex);
+                    MergeByTime(packetBuffers, [](const StagedPacket& staged) { return staged.info.timestamp; },
+                        [](StagedPacket& staged) {
+                            // Pooled under the log lock so the id is valid for the log the packet
+                            // lands in. The pool advances by the original size, which exceeds the
+                            // stored bytes for header-only captures.
+                            if (!staged.logged) {
+                                g_rc4Snapshots.Skip(staged.rc4Snapshot,
+                                    static_cast<std::size_t>(staged.info.size), staged.rc4After);
+                                return;
+                            }
+                            if (staged.hasRc4) {
+                                staged.info.rc4Snapshot = g_rc4Snapshots.Add(staged.rc4Snapshot,
+                                    static_cast<std::size_t>(staged.info.size), staged.rc4After);
+                            }
+                            g_packetMetadata.Append(staged.info);
+                            g_packetLog.push_back(std::move(staged.info));
+                        });
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[Staging] Publishing " << s_mergedSamples.size() << " packets failed: " << e.what() << std::endl;
+            }
+
+            s_batches.fetch_add(1, std::memory_order_relaxed);
+            s_publishedPackets.fetch_add(s_mergedSamples.size(), std::memory_order_relaxed);
+            s_skippedPackets.fetch_add(skipped, std::memory_order_relaxed);
+            for (Stager* stager : taken) {
+                stager->publishingPackets.clear();
+                stager->publishingSamples.clear();
+            }
+        }
+
+        // Called by the capturing thread after staging, without any lock held. With batching
+        // it only makes sure a publish is coming: the first packet staged after the last
+        // scheduled flush ran schedules the next one on the control loop, so the loop does
+        // not wake while nothing is captured.
+        void AfterStaging() {
+            if (!s_batching.load(std::memory_order_relaxed)) {
+                PublishAll();
+                return;
+            }
+            if (!s_flushScheduled.load(std::memory_order_relaxed) && !s_flushScheduled.exchange(true, std::memory_order_acq_rel)) {
+                Control::ScheduleOnce("staging-flush", FLUSH_INTERVAL, []() {
+                    s_flushScheduled.store(false, std::memory_order_release); // Later packets schedule the next one
+                    PublishAll();
+                });
+            }
+        }
+
+    } // anonymous namespace
+
+
+    void StagePacket(PacketInfo&& info, const GameStructs::RC4State* rc4Snapshot, const GameStructs::RC4State* rc4After) {
+        TrafficSample sample;
+        sample.size = static_cast<std::uint32_t>(std::clamp(info.size, 0, std::numeric_limits<int>::max()));
+        sample.direction = info.direction;
+        sample.headerId = info.rawHeaderId;
+
+        Stager& stager = ThisThreadStager();
+        {
+            std::lock_guard<std::mutex> lock(stager.mutex);
+            info.timestamp = std::chrono::system_clock::now(); // Under the lock; see PublishAll()
+            sample.timestamp = info.timestamp;
+            stager.packets.emplace_back();
+            StagedPacket& staged = stager.packets.back();
+            staged.info = std::move(info);
+            if (rc4Snapshot != nullptr) {
+                staged.hasRc4 = true;
+                staged.rc4Snapshot = *rc4Snapshot;
+                staged.rc4After = rc4After != nullptr ? *rc4After : *rc4Snapshot;
+            }
+            stager.samples.push_back(sample);
+        }
+        AfterStaging();
+    }
+
+    void StageSkippedPacket(TrafficSample sample, const GameStructs::RC4State* rc4Snapshot,
+        const GameStructs::RC4State* rc4After)
+    {
+        Stager& stager = ThisThreadStager();
+        {
+            std::lock_guard<std::mutex> lock(stager.mutex);
+            sample.timestamp = std::chrono::system_clock::now();
+            if (rc4Snapshot != nullptr) {
+                stager.packets.emplace_back();
+                StagedPacket& staged = stager.packets.back();
+                staged.info.timestamp = sample.timestamp; // Merge position
+                staged.info.size = static_cast<int>(sample.size);
+                staged.logged = false;
+                staged.hasRc4 = true;
+                staged.rc4Snapshot = *rc4Snapshot;
+                staged.rc4After = rc4After != nullptr ? *rc4After : *rc4Snapshot;
+            }
+            stager.samples.push_back(sample);
+        }
+        AfterStaging();
+    }
+
+    void FlushAll() {
+        PublishAll();
+    }
+
+    void SetBatchingEnabled(bool enabled) {
+        s_batching.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool IsBatchingEnabled() {
+        return s_batching.load(std::memory_order_relaxed);
+    }
+
+    Stats GetStats() {
+        Stats stats;
+        stats.batches = s_batches.load(std::memory_order_relaxed);
+        stats.packets = s_publishedPackets.load(std::memory_order_relaxed);
+        stats.skipped = s_skippedPackets.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        stats.threads = s_stagers.size();
+        return stats;
+    }
+
+    void ResetStats() {
+        s_batches = 0;
+        s_publishedPackets = 0;
+        s_skippedPackets = 0;
+    }
+
+} // namespace kx::Staging
@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+ * @file PacketStaging.h
+ * @brief Per-thread staging of captured packets, published to the shared state in batches.
+ * @details Every thread that captures packets (the send and receive detours, load test
+ *          producers) stages them in a buffer of its own instead of taking the statistics,
+ *          rate graph, timeline and log locks for each packet. Staging only appends to that
+ *          buffer; the capturing thread never publishes. The buffers are published as one
+ *          batch, taking each of those locks once, by FlushAll():
+ *          - on the render thread, once per frame,
+ *          - on the control loop, FLUSH_INTERVAL after the first packet staged since its last
+ *            flush (for a hidden or stalled game window). The loop is woken this way only
+ *            while packets arrive.
+ *
+ *          Packets are timestamped when staged. Publishing takes the buffers of all threads
+ *          at once and merges them by timestamp, so the log, its sequence numbers and the
+ *          timeline follow capture time across threads and batches. The merge only compares
+ *          the heads of the buffers, so a thread's packets keep their order (and the received
+ *          keystream still reaches the RC4 snapshot pool in order) even if the system clock
+ *          is set back; only then can timestamps in the log decrease.
+ *
+ *          With batching disabled every packet is published as soon as it is staged, on the
+ *          capturing thread (for comparison).
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "GameStructs.h" // For RC4State
+#include "PacketData.h"  // For PacketInfo, TrafficSample
+
+namespace kx::Staging {
+
+    constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(50);
+
+    /**
+     * @brief Stages a processed packet for the log, statistics, rate graphs and timeline.
+     * @param rc4Snapshot For encrypted packets, the RC4 state before the payload; it is
+     *                    added to g_rc4Snapshots when the batch is published.
+     * @param rc4After The state after the payload (see RC4SnapshotPool::Add).
+     * @details Sets info.timestamp. Must not be called with g_packetLogMutex held.
+     */
+    void StagePacket(PacketInfo&& info,
+        const GameStructs::RC4State* rc4Snapshot = nullptr,
+        const GameStructs::RC4State* rc4After = nullptr);
+
+    /**
+     * @brief Stages a packet rejected by the capture policy (counted, not logged).
+     * @details Sets sample.timestamp.
+     * @param rc4Snapshot For encrypted packets, the RC4 state before the payload; it is
+     *                    passed to RC4SnapshotPool::Skip() in order with the logged packets.
+     * @param rc4After The state after the payload.
+     */
+    void StageSkippedPacket(TrafficSample sample,
+        const GameStructs::RC4State* rc4Snapshot = nullptr,
+        const GameStructs::RC4State* rc4After = nullptr);
+
+    /**
+     * @brief Publishes the packets staged by every thread.
+     * @details Must not be called with g_packetLogMutex held.
+     */
+    void FlushAll();
+
+    void SetBatchingEnabled(bool enabled);
+    bool IsBatchingEnabled();
+
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t packets = 0;    // Logged and skipped packets published
+        std::uint64_t skipped = 0;    // Of `packets`, those rejected by the capture policy
+        std::size_t threads = 0;      // Staging buffers (one per capturing thread)
+    };
+
+    Stats GetStats();
+
+    void ResetStats();
+
+} // namespace kx::Staging
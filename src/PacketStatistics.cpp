@@ -0,0 +1,172 @@
+#include "PacketStatistics.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+namespace kx::Statistics {
+
+    namespace {
+
+        constexpr std::size_t DIRECTION_COUNT = 2;
+        constexpr std::size_t HEADER_COUNT = 256;
+
+        // Cumulative per-opcode counters.
+        struct OpcodeCounters {
+            std::uint64_t count = 0;
+            std::uint64_t skipped = 0;
+            std::uint64_t bytes = 0;
+            std::uint32_t minSize = std::numeric_limits<std::uint32_t>::max();
+            std::uint32_t maxSize = 0;
+            std::int64_t firstMs = 0;
+            std::int64_t lastMs = 0;
+        };
+
+        std::mutex s_statsMutex;
+        OpcodeCounters s_counters[DIRECTION_COUNT][HEADER_COUNT];
+
+        // Ring of one-second buckets. A bucket is lazily zeroed the first time a packet
+        // from a newer second lands in it, which keeps recording O(1) amortized.
+        std::int64_t s_bucketSecond[WINDOW_SECONDS];
+        std::uint32_t s_bucketCounts[WINDOW_SECONDS][DIRECTION_COUNT][HEADER_COUNT];
+
+        struct RingInitializer {
+            RingInitializer() { std::fill(std::begin(s_bucketSecond), std::end(s_bucketSecond), -1); }
+        } s_ringInitializer;
+
+        std::int64_t ToMilliseconds(std::chrono::system_clock::time_point tp) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+        }
+
+        std::int64_t ToSeconds(std::chrono::system_clock::time_point tp) {
+            return std::chrono::duration_cast<std::chrono::seconds>(tp.time_since_epoch()).count();
+        }
+
+        std::size_t BucketOf(std::int64_t second) {
+            return static_cast<std::size_t>(second % static_cast<std::int64_t>(WINDOW_SECONDS));
+        }
+
+        // Sum of bucket counts for seconds [endSecond - windowSeconds, endSecond).
+        std::uint64_t SumWindow(std::size_t direction, std::size_t header, std::int64_t endSecond, std::size_t windowSeconds) {
+            std::uint64_t total = 0;
+            for (std::int64_t second = endSecond - static_cast<std::int64_t>(windowSeconds); second < endSecond; ++second) {
+                if (second < 0) continue;
+                std::size_t bucket = BucketOf(second);
+                if (s_bucketSecond[bucket] == second) {
+                    total += s_bucketCounts[bucket][direction][header];
+                }
+            }
+            return total;
+        }
+
+        // Requires s_statsMutex.
+        void Record(const TrafficSample& sample) {
+            const std::size_t dir = (sample.direction == PacketDirection::Sent) ? 0 : 1;
+            const std::int64_t ms = ToMilliseconds(sample.timestamp);
+            const std::int64_t second = ToSeconds(sample.timestamp);
+
+            OpcodeCounters& c = s_counters[dir][sample.headerId];
+            if (c.count == 0) {
+                c.firstMs = ms;
+            }
+            ++c.count;
+            if (sample.skipped) {
+                ++c.skipped;
+            }
+            c.bytes += sample.size;
+            c.minSize = std::min(c.minSize, sample.size);
+            c.maxSize = std::max(c.maxSize, sample.size);
+            c.lastMs = std::max(c.lastMs, ms);
+
+            if (second >= 0) {
+                std::size_t bucket = BucketOf(second);
+                if (s_bucketSecond[bucket] < second) {
+                    std::memset(s_bucketCounts[bucket], 0, sizeof(s_bucketCounts[bucket]));
+                    s_bucketSecond[bucket] = second;
+                }
+                if (s_bucketSecond[bucket] == second) { // Skip late packets older than the ring
+                    ++s_bucketCounts[bucket][dir][sample.headerId];
+                }
+            }
+        }
+
+        TrafficSample MakeSample(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+            std::chrono::system_clock::time_point timestamp, bool skipped)
+        {
+            TrafficSample sample;
+            sample.timestamp = timestamp;
+            sample.size = static_cast<std::uint32_t>(std::min<std::size_t>(size, std::numeric_limits<std::uint32_t>::max()));
+            sample.direction = direction;
+            sample.headerId = headerId;
+            sample.skipped = skipped;
+            return sample;
+        }
+
+    } // anonymous namespace
+
+
+    void RecordPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+        std::chrono::system_clock::time_point timestamp)
+    {
+        const TrafficSample sample = MakeSample(direction, headerId, size, timestamp, false);
+        RecordPackets(&sample, 1);
+    }
+
+    void RecordSkippedPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+        std::chrono::system_clock::time_point timestamp)
+    {
+        const TrafficSample sample = MakeSample(direction, headerId, size, timestamp, true);
+        RecordPackets(&sample, 1);
+    }
+
+    void RecordPackets(const TrafficSample* samples, std::size_t count) {
+        std::lock_guard<std::mutex> lock(s_statsMutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            Record(samples[i]);
+        }
+    }
+
+    std::vector<OpcodeStats> GetSnapshot(std::chrono::system_clock::time_point now) {
+        std::vector<OpcodeStats> snapshot;
+        const std::int64_t currentSecond = ToSeconds(now);
+
+        std::lock_guard<std::mutex> lock(s_statsMutex);
+        for (std::size_t dir = 0; dir < DIRECTION_COUNT; ++dir) {
+            for (std::size_t header = 0; header < HEADER_COUNT; ++header) {
+                const OpcodeCounters& c = s_counters[dir][header];
+                if (c.count == 0) continue;
+
+                OpcodeStats stats;
+                stats.direction = (dir == 0) ? PacketDirection::Sent : PacketDirection::Received;
+                stats.headerId = static_cast<std::uint8_t>(header);
+                stats.count = c.count;
+                stats.skipped = c.skipped;
+                stats.bytes = c.bytes;
+                stats.minSize = c.minSize;
+                stats.maxSize = c.maxSize;
+                stats.meanSize = static_cast<double>(c.bytes) / static_cast<double>(c.count);
+                if (c.count > 1) {
+                    stats.meanInterArrivalMs = static_cast<double>(c.lastMs - c.firstMs) / static_cast<double>(c.count - 1);
+                }
+                stats.rate1s = static_cast<double>(SumWindow(dir, header, currentSecond, 1));
+                stats.rate10s = static_cast<double>(SumWindow(dir, header, currentSecond, 10)) / 10.0;
+                stats.rate60s = static_cast<double>(SumWindow(dir, header, currentSecond, 60)) / 60.0;
+                snapshot.push_back(stats);
+            }
+        }
+        return snapshot;
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(s_statsMutex);
+        for (auto& direction : s_counters) {
+            for (auto& c : direction) {
+                c = OpcodeCounters{};
+            }
+        }
+        std::fill(std::begin(s_bucketSecond), std::end(s_bucketSecond), -1);
+        std::memset(s_bucketCounts, 0, sizeof(s_bucketCounts));
+    }
+
+} // namespace kx::Statistics
@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * @file PacketStatistics.h
+ * @brief Live per-opcode traffic statistics, updated incrementally as packets are logged.
+ * @details Storage is a flat [direction][rawHeaderId] array (2 x 256 entries) plus a
+ *          60-slot ring of per-second counters shared by all opcodes, so recording a
+ *          packet is O(1) and never touches g_packetLog. Packets rejected by the capture
+ *          policy (see CapturePolicy.h) are recorded too, so counts and rates describe the
+ *          real traffic; `skipped` says how many of them were not logged.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PacketData.h" // For PacketDirection, TrafficSample
+
+namespace kx::Statistics {
+
+    // Length of the longest sliding window, in one-second buckets.
+    constexpr std::size_t WINDOW_SECONDS = 60;
+
+    /**
+     * @brief Snapshot of the statistics for one (direction, rawHeaderId) pair.
+     */
+    struct OpcodeStats {
+        PacketDirection direction = PacketDirection::Sent;
+        std::uint8_t headerId = 0;
+        std::uint64_t count = 0;
+        std::uint64_t skipped = 0;      // Of `count`, packets not logged due to the capture policy
+        std::uint64_t bytes = 0;
+        double rate1s = 0.0;            // Packets/s over the last complete second
+        double rate10s = 0.0;           // Packets/s over the last 10 complete seconds
+        double rate60s = 0.0;           // Packets/s over the last 60 complete seconds
+        std::uint32_t minSize = 0;
+        std::uint32_t maxSize = 0;
+        double meanSize = 0.0;
+        double meanInterArrivalMs = 0.0; // 0 until at least two packets were seen
+    };
+
+    /**
+     * @brief Records one logged packet. O(1), thread-safe.
+     * @param direction Packet direction.
+     * @param headerId The packet's rawHeaderId (0 for special types without a header).
+     * @param size Original packet size in bytes.
+     * @param timestamp Capture timestamp.
+     */
+    void RecordPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+        std::chrono::system_clock::time_point timestamp);
+
+    /**
+     * @brief Records a packet seen by a detour but rejected by the capture policy. O(1), thread-safe.
+     */
+    void RecordSkippedPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+        std::chrono::system_clock::time_point timestamp);
+
+    /**
+     * @brief Records a batch of packets under one lock acquisition. Thread-safe.
+     * @details Samples with `skipped` set count as RecordSkippedPacket() would.
+     */
+    void RecordPackets(const TrafficSample* samples, std::size_t count);
+
+    /**
+     * @brief Returns statistics for every (direction, header) pair seen so far.
+     * @param now Reference time for the sliding windows (normally the current time).
+     */
+    std::vector<OpcodeStats> GetSnapshot(std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Clears all counters (e.g. when the log is cleared).
+     */
+    void Reset();
+
+} // namespace kx::Statistics
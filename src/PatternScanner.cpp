@@ -47,6 +47,34 @@ bool PatternScanner::PatternToBytes(const std::string& pattern, std::vector<int>
 }
 
 
+// Core scan loop shared by FindPattern and FindPatternInRange.
+static std::optional<uintptr_t> ScanBytes(const std::vector<int>& patternBytes, uintptr_t baseAddress, uintptr_t scanSize) {
+    size_t patternSize = patternBytes.size();
+
+    if (scanSize < patternSize) {
+         std::cerr << "[PatternScanner] Error: Scan range is smaller than pattern size." << std::endl;
+        return std::nullopt; // Cannot possibly find the pattern
+    }
+
+    for (uintptr_t i = 0; i <= scanSize - patternSize; ++i) {
+        bool found = true;
+        for (size_t j = 0; j < patternSize; ++j) {
+            // Check if the byte is a wildcard (-1) or if the memory matches the pattern byte
+            if (patternBytes[j] != -1 && patternBytes[j] != *reinterpret_cast<unsigned char*>(baseAddress + i + j)) {
+                found = false;
+                break;
+            }
+        }
+
+        if (found) {
+            return baseAddress + i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+
 std::optional<uintptr_t> PatternScanner::FindPattern(const std::string& pattern, const std::string& moduleName) {
     std::vector<int> patternBytes;
     if (!PatternToBytes(pattern, patternBytes)) {
@@ -67,27 +95,9 @@ std::optional<uintptr_t> PatternScanner::FindPattern(const std::string& pattern,
     }
 
     uintptr_t baseAddress = reinterpret_cast<uintptr_t>(moduleInfo.lpBaseOfDll);
-    uintptr_t scanSize = moduleInfo.SizeOfImage;
-    size_t patternSize = patternBytes.size();
-
-    if (scanSize < patternSize) {
-         std::cerr << "[PatternScanner] Error: Module size is smaller than pattern size." << std::endl;
-        return std::nullopt; // Cannot possibly find the pattern
-    }
-
-    for (uintptr_t i = 0; i <= scanSize - patternSize; ++i) {
-        bool found = true;
-        for (size_t j = 0; j < patternSize; ++j) {
-            // Check if the byte is a wildcard (-1) or if the memory matches the pattern byte
-            if (patternBytes[j] != -1 && patternBytes[j] != *reinterpret_cast<unsigned char*>(baseAddress + i + j)) {
-                found = false;
-                break;
-            }
-        }
-
-        if (found) {
-            return baseAddress + i;
-        }
+    std::optional<uintptr_t> result = ScanBytes(patternBytes, baseAddress, moduleInfo.SizeOfImage);
+    if (result) {
+        return result;
     }
 
     // Pattern not found
@@ -95,4 +105,16 @@ std::optional<uintptr_t> PatternScanner::FindPattern(const std::string& pattern,
     return std::nullopt;
 }
 
+std::optional<uintptr_t> PatternScanner::FindPatternInRange(const std::string& pattern, uintptr_t baseAddress, size_t scanSize) {
+    std::vector<int> patternBytes;
+    if (!PatternToBytes(pattern, patternBytes)) {
+        std::cerr << "[PatternScanner] Failed to parse pattern string." << std::endl;
+        return std::nullopt;
+    }
+    if (baseAddress == 0) {
+        return std::nullopt;
+    }
+    return ScanBytes(patternBytes, baseAddress, scanSize);
+}
+
 }
\ No newline at end of file
@@ -15,8 +15,14 @@ public:
     // Returns the address of the first match, or std::nullopt if not found.
     static std::optional<uintptr_t> FindPattern(const std::string& pattern, const std::string& moduleName);
 
-private:
+    // Scans an arbitrary, readable memory range for a given byte pattern.
+    // pattern: IDA-style pattern string.
+    // baseAddress/scanSize: The range to scan. The caller guarantees it is readable.
+    // Returns the address of the first match, or std::nullopt if not found.
+    static std::optional<uintptr_t> FindPatternInRange(const std::string& pattern, uintptr_t baseAddress, size_t scanSize);
+
     // Helper to convert pattern string to bytes and mask.
+    // Wildcard bytes ("?" or "??") are stored as -1.
     static bool PatternToBytes(const std::string& pattern, std::vector<int>& bytes);
 };
 
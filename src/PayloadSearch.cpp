@@ -0,0 +1,317 @@
+#include "PayloadSearch.h"
+#include "HookQuiescence.h" // For StartBackgroundThread
+#include "LazyDecryption.h"
+#include "PacketData.h"
+#include "PatternScanner.h"
+
+#include <emmintrin.h> // SSE2, always available on x64
+#if defined(_MSC_VER)
+#include <intrin.h>    // For _BitScanForward
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace kx::Search {
+
+    namespace {
+
+        constexpr std::size_t CHUNK_PACKETS = 2048;
+        constexpr unsigned MAX_WORKERS = 8;
+
+        /**
+         * @brief Shared state of one search. Workers keep it alive through a shared_ptr,
+         *        so a cancelled search can finish in the background without blocking.
+         */
+        struct SearchJob {
+            SearchPattern pattern;
+            PacketSequence firstSequence = 0; // Packets [firstSequence, firstSequence + totalPackets) are searched
+            std::size_t totalPackets = 0;
+            std::size_t chunkCount = 0;
+            std::chrono::steady_clock::time_point startTime;
+
+            std::atomic<std::size_t> nextChunk{ 0 };
+            std::atomic<std::size_t> scannedPackets{ 0 };
+            std::atomic<unsigned> activeWorkers{ 0 };
+            std::atomic<bool> cancelled{ false };
+            std::atomic<std::int64_t> elapsedUs{ 0 };
+
+            std::mutex resultsMutex;
+            std::vector<std::uint8_t> matchFlags; // Indexed by sequence - firstSequence
+            std::size_t matchCount = 0;
+        };
+
+        std::mutex s_jobMutex;
+        std::shared_ptr<SearchJob> s_currentJob;
+
+        std::shared_ptr<SearchJob> CurrentJob() {
+            std::lock_guard<std::mutex> lock(s_jobMutex);
+            return s_currentJob;
+        }
+
+        unsigned LowestSetBit(unsigned value) {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanForward(&index, value);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+        }
+
+        bool ParseQuotedString(const std::string& text, SearchPattern& pattern, std::string& error) {
+            const bool wide = text[0] == 'u';
+            const std::size_t open = wide ? 1 : 0;
+            if (text.size() < open + 2 || text[open] != '"' || text.back() != '"') {
+                error = "Unterminated string.";
+                return false;
+            }
+            for (std::size_t i = open + 1; i + 1 < text.size(); ++i) {
+                std::uint8_t ch = static_cast<std::uint8_t>(text[i]);
+                pattern.bytes.push_back(ch);
+                if (wide) pattern.bytes.push_back(0x00);
+            }
+            if (pattern.bytes.empty()) {
+                error = "Empty string.";
+                return false;
+            }
+            pattern.mask.assign(pattern.bytes.size(), 0xFF);
+            return true;
+        }
+
+        bool MatchesAt(const std::uint8_t* data, const SearchPattern& pattern) {
+            for (std::size_t j = 0; j < pattern.bytes.size(); ++j) {
+                if ((data[j] & pattern.mask[j]) != pattern.bytes[j]) return false;
+            }
+            return true;
+        }
+
+        // Scans one chunk of the log: copies its payloads out under the log lock, then
+        // searches them without holding it. Deferred payloads are decrypted while copying,
+        // in log order so the chunk costs one pass over its keystream.
+        void ScanChunk(SearchJob& job, std::size_t chunk, std::vector<std::uint8_t>& buffer, std::vector<std::size_t>& offsets) {
+            const std::size_t first = chunk * CHUNK_PACKETS;
+            const std::size_t last = std::min(first + CHUNK_PACKETS, job.totalPackets);
+
+            buffer.clear();
+            offsets.clear();
+            {
+                std::lock_guard<std::mutex> lock(g_packetLogMutex);
+                RC4Cursor cursor;
+                for (std::size_t i = first; i < last; ++i) {
+                    offsets.push_back(buffer.size());
+                    std::size_t position = 0;
+                    if (!FindLogPosition(job.firstSequence + i, position)) continue; // Cleared
+                    const PacketInfo& packet = g_packetLog[position];
+                    const PacketPayload& payload = packet.GetDisplayData();
+                    const std::size_t at = buffer.size();
+                    buffer.insert(buffer.end(), payload.begin(), payload.end());
+                    if (packet.IsDecryptionDeferred()) {
+                        Decryption::DecryptInto(packet, buffer.data() + at, cursor);
+                    }
+                }
+                offsets.push_back(buffer.size());
+            }
+
+            std::vector<std::size_t> chunkMatches;
+            for (std::size_t k = 0; k + 1 < offsets.size(); ++k) {
+                if (job.cancelled.load(std::memory_order_relaxed)) return;
+                const std::size_t length = offsets[k + 1] - offsets[k];
+                if (FindFirst(buffer.data() + offsets[k], length, job.pattern) != NOT_FOUND) {
+                    chunkMatches.push_back(first + k);
+                }
+            }
+
+            if (!chunkMatches.empty()) {
+                std::lock_guard<std::mutex> lock(job.resultsMutex);
+                for (std::size_t index : chunkMatches) {
+                    job.matchFlags[index] = 1;
+                }
+                job.matchCount += chunkMatches.size();
+            }
+            job.scannedPackets.fetch_add(last - first, std::memory_order_relaxed);
+        }
+
+        void FinishWorker(SearchJob& job) {
+            if (job.activeWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                auto elapsed = std::chrono::steady_clock::now() - job.startTime;
+                job.elapsedUs.store(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), std::memory_order_relaxed);
+            }
+        }
+
+        void WorkerLoop(std::shared_ptr<SearchJob> job) {
+            std::vector<std::uint8_t> buffer;
+            std::vector<std::size_t> offsets;
+            try {
+                while (!job->cancelled.load(std::memory_order_relaxed)) {
+                    std::size_t chunk = job->nextChunk.fetch_add(1, std::memory_order_relaxed);
+                    if (chunk >= job->chunkCount) break;
+                    ScanChunk(*job, chunk, buffer, offsets);
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[PayloadSearch] Exception in worker: " << e.what() << std::endl;
+            }
+            FinishWorker(*job);
+        }
+
+    } // anonymous namespace
+
+
+    bool ParseSearchPattern(const std::string& text, SearchPattern& pattern, std::string& error) {
+        pattern = SearchPattern{};
+        error.clear();
+
+        std::size_t begin = text.find_first_not_of(" \t");
+        std::size_t end = text.find_last_not_of(" \t");
+        if (begin == std::string::npos) {
+            error = "Empty pattern.";
+            return false;
+        }
+        std::string trimmed = text.substr(begin, end - begin + 1);
+
+        if (trimmed[0] == '"' || (trimmed.size() > 1 && trimmed[0] == 'u' && trimmed[1] == '"')) {
+            return ParseQuotedString(trimmed, pattern, error);
+        }
+
+        std::vector<int> bytes;
+        if (!PatternScanner::PatternToBytes(trimmed, bytes)) {
+            error = "Invalid byte pattern.";
+            return false;
+        }
+        for (int value : bytes) {
+            pattern.bytes.push_back(value < 0 ? 0x00 : static_cast<std::uint8_t>(value));
+            pattern.mask.push_back(value < 0 ? 0x00 : 0xFF);
+        }
+        return true;
+    }
+
+    std::size_t FindFirst(const std::uint8_t* data, std::size_t length, const SearchPattern& pattern) {
+        const std::size_t patternLength = pattern.bytes.size();
+        if (patternLength == 0 || length < patternLength) {
+            return NOT_FOUND;
+        }
+
+        // Anchor on the first and last concrete bytes (Mula's "generic SIMD" memmem):
+        // 16 candidate positions are filtered at once, survivors are verified in full.
+        std::size_t firstAnchor = 0;
+        while (firstAnchor < patternLength && pattern.mask[firstAnchor] == 0) ++firstAnchor;
+        if (firstAnchor == patternLength) {
+            return 0; // Only wildcards
+        }
+        std::size_t lastAnchor = patternLength - 1;
+        while (pattern.mask[lastAnchor] == 0) --lastAnchor;
+
+        const std::size_t lastStart = length - patternLength;
+        std::size_t start = 0;
+
+        const __m128i firstByte = _mm_set1_epi8(static_cast<char>(pattern.bytes[firstAnchor]));
+        const __m128i lastByte = _mm_set1_epi8(static_cast<char>(pattern.bytes[lastAnchor]));
+        for (; start + 15 <= lastStart; start += 16) {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + start + firstAnchor));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + start + lastAnchor));
+            unsigned candidates = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, firstByte), _mm_cmpeq_epi8(blockLast, lastByte))));
+            while (candidates != 0) {
+                unsigned bit = LowestSetBit(candidates);
+                if (MatchesAt(data + start + bit, pattern)) {
+                    return start + bit;
+                }
+                candidates &= candidates - 1;
+            }
+        }
+
+        for (; start <= lastStart; ++start) {
+            if (data[start + firstAnchor] == pattern.bytes[firstAnchor] && MatchesAt(data + start, pattern)) {
+                return start;
+            }
+        }
+        return NOT_FOUND;
+    }
+
+    bool StartSearch(const std::string& patternText, std::string& error) {
+        auto job = std::make_shared<SearchJob>();
+        if (!ParseSearchPattern(patternText, job->pattern, error)) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_packetLogMutex);
+            job->firstSequence = g_packetLogFirstSequence;
+            job->totalPackets = g_packetLog.size();
+        }
+        job->chunkCount = (job->totalPackets + CHUNK_PACKETS - 1) / CHUNK_PACKETS;
+        job->matchFlags.assign(job->totalPackets, 0);
+        job->startTime = std::chrono::steady_clock::now();
+
+        unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        unsigned workerCount = static_cast<unsigned>(std::min<std::size_t>(
+            std::min(MAX_WORKERS, std::max(1u, hardwareThreads - 1)), std::max<std::size_t>(1, job->chunkCount)));
+        job->activeWorkers.store(workerCount, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(s_jobMutex);
+            if (s_currentJob) s_currentJob->cancelled = true;
+            s_currentJob = job;
+        }
+
+        // Background threads, so unload can cancel the search and wait for the workers.
+        for (unsigned w = 0; w < workerCount; ++w) {
+            if (!Quiescence::StartBackgroundThread("search-worker", [job]() { WorkerLoop(job); })) {
+                FinishWorker(*job); // The other workers cover its chunks
+            }
+        }
+        return true;
+    }
+
+    void CancelSearch() {
+        std::lock_guard<std::mutex> lock(s_jobMutex);
+        if (s_currentJob) {
+            s_currentJob->cancelled = true;
+            s_currentJob.reset();
+        }
+    }
+
+    SearchProgress GetProgress() {
+        SearchProgress progress;
+        std::shared_ptr<SearchJob> job = CurrentJob();
+        if (!job) {
+            return progress;
+        }
+
+        progress.active = true;
+        progress.running = job->activeWorkers.load(std::memory_order_acquire) > 0;
+        progress.scannedPackets = job->scannedPackets.load(std::memory_order_relaxed);
+        progress.totalPackets = job->totalPackets;
+        {
+            std::lock_guard<std::mutex> lock(job->resultsMutex);
+            progress.matchCount = job->matchCount;
+        }
+        if (progress.running) {
+            progress.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job->startTime).count();
+        }
+        else {
+            progress.elapsedMs = static_cast<double>(job->elapsedUs.load(std::memory_order_relaxed)) / 1000.0;
+        }
+        return progress;
+    }
+
+    void FilterToMatches(std::vector<PacketSequence>& sequences) {
+        std::shared_ptr<SearchJob> job = CurrentJob();
+        if (!job) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(job->resultsMutex);
+        sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [&](PacketSequence sequence) {
+            return sequence < job->firstSequence || sequence - job->firstSequence >= job->matchFlags.size()
+                || job->matchFlags[static_cast<std::size_t>(sequence - job->firstSequence)] == 0;
+        }), sequences.end());
+    }
+
+} // namespace kx::Search
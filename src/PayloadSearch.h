@@ -0,0 +1,77 @@
+#pragma once
+
+/**
+ * @file PayloadSearch.h
+ * @brief Parallel byte-sequence search over every payload in the packet log.
+ * @details Patterns use the IDA syntax understood by PatternScanner ("0A ? FF"), or a
+ *          quoted string: "text" searches ASCII bytes and u"text" UTF-16LE. Payloads are
+ *          searched as displayed (decrypted where available, on the fly for deferred
+ *          packets). Worker threads claim chunks of the log, copy the payloads out under
+ *          g_packetLogMutex and scan them with an SSE2 memmem outside the lock, publishing
+ *          matches as each chunk completes.
+ *          Results are kept by packet sequence. Packets cleared from the log while a search
+ *          runs are skipped; clearing the log should still call CancelSearch() so the
+ *          results of the cleared packets are dropped.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PacketData.h" // For PacketSequence
+
+namespace kx::Search {
+
+    /**
+     * @brief A compiled search pattern. Wildcard positions have mask 0x00 and byte 0x00.
+     */
+    struct SearchPattern {
+        std::vector<std::uint8_t> bytes;
+        std::vector<std::uint8_t> mask;
+    };
+
+    constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief Parses an IDA-style pattern or a quoted ("..." / u"...") string.
+     * @param error Receives a short description if parsing fails.
+     * @return True on success.
+     */
+    bool ParseSearchPattern(const std::string& text, SearchPattern& pattern, std::string& error);
+
+    /**
+     * @brief Returns the offset of the first occurrence of the pattern, or NOT_FOUND.
+     */
+    std::size_t FindFirst(const std::uint8_t* data, std::size_t length, const SearchPattern& pattern);
+
+    struct SearchProgress {
+        bool active = false;          // A search exists (running or finished)
+        bool running = false;
+        std::size_t scannedPackets = 0;
+        std::size_t totalPackets = 0; // Log size when the search started
+        std::size_t matchCount = 0;
+        double elapsedMs = 0.0;
+    };
+
+    /**
+     * @brief Cancels any previous search and starts a new one over the current log.
+     * @param error Receives the parse error if the pattern is invalid.
+     * @return False if the pattern could not be parsed.
+     */
+    bool StartSearch(const std::string& patternText, std::string& error);
+
+    /**
+     * @brief Stops the current search (if any) and discards its results. Does not block;
+     *        at unload Quiescence::WaitForBackgroundThreads() waits for the workers to exit.
+     */
+    void CancelSearch();
+
+    SearchProgress GetProgress();
+
+    /**
+     * @brief Removes every sequence that has not matched the current search (so far).
+     * @details No-op when no search is active. Results stream in while the search runs.
+     */
+    void FilterToMatches(std::vector<PacketSequence>& sequences);
+
+} // namespace kx::Search
@@ -0,0 +1,117 @@
+#include "RC4SnapshotPool.h"
+
+#include <cstring>
+#include "CryptoUtils.h"
+
+namespace kx {
+
+    RC4SnapshotPool g_rc4Snapshots;
+
+    namespace {
+
+        // Compares states the way the PRGA sees them: only the low byte of i and j is used.
+        bool SameState(const GameStructs::RC4State& a, const GameStructs::RC4State& b) {
+            return (a.i & 0xFF) == (b.i & 0xFF)
+                && (a.j & 0xFF) == (b.j & 0xFF)
+                && std::memcmp(a.S.data(), b.S.data(), a.S.size()) == 0;
+        }
+
+    } // anonymous namespace
+
+    RC4SnapshotId RC4SnapshotPool::Add(const GameStructs::RC4State& snapshot, std::size_t consumedBytes,
+        const GameStructs::RC4State& stateAfter)
+    {
+        if (m_entries.Size() >= static_cast<std::size_t>(INVALID_RC4_SNAPSHOT)) {
+            return INVALID_RC4_SNAPSHOT;
+        }
+
+        const bool continues = m_hasExpected
+            && m_packetsSinceKeyframe < KEYFRAME_INTERVAL_PACKETS
+            && m_expectedOffset < KEYFRAME_INTERVAL_BYTES
+            && SameState(snapshot, m_expected);
+
+        if (!continues) {
+            m_keyframes.PushBack(snapshot);
+            m_expectedOffset = 0;
+            m_packetsSinceKeyframe = 0;
+        }
+
+        const RC4SnapshotId id = static_cast<RC4SnapshotId>(m_entries.Size());
+        m_entries.PushBack(Entry{ static_cast<std::uint32_t>(m_keyframes.Size() - 1), m_expectedOffset });
+
+        // Packets are capped at 16 KiB by the processor, so the offset stays far below 2^32.
+        m_expected = stateAfter;
+        m_hasExpected = true;
+        m_expectedOffset += static_cast<std::uint32_t>(consumedBytes);
+        ++m_packetsSinceKeyframe;
+        return id;
+    }
+
+    void RC4SnapshotPool::Skip(const GameStructs::RC4State& snapshot, std::size_t consumedBytes,
+        const GameStructs::RC4State& stateAfter)
+    {
+        // Past the byte interval the next Add() keyframes anyway, which also keeps the
+        // offset from growing without bound over a long run of skipped packets.
+        if (!m_hasExpected || m_expectedOffset >= KEYFRAME_INTERVAL_BYTES || !SameState(snapshot, m_expected)) {
+            m_hasExpected = false;
+            return;
+        }
+        m_expected = stateAfter;
+        m_expectedOffset += static_cast<std::uint32_t>(consumedBytes);
+    }
+
+    bool RC4SnapshotPool::Get(RC4SnapshotId id, GameStructs::RC4State& out) const {
+        if (id >= m_entries.Size()) {
+            return false;
+        }
+        const Entry& entry = m_entries[id];
+        out = m_keyframes[entry.keyframe];
+        if (entry.offset > 0) {
+            Crypto::rc4_skip(out, entry.offset);
+        }
+        return true;
+    }
+
+    bool RC4SnapshotPool::Seek(RC4SnapshotId id, RC4Cursor& cursor) const {
+        if (id >= m_entries.Size()) {
+            return false;
+        }
+        const Entry& entry = m_entries[id];
+        SeekTo(entry.keyframe, entry.offset, m_keyframes[entry.keyframe], cursor);
+        return true;
+    }
+
+    bool RC4SnapshotPool::Locate(RC4SnapshotId id, std::uint32_t& keyframe, std::uint32_t& offset) const {
+        if (id >= m_entries.Size()) {
+            return false;
+        }
+        keyframe = m_entries[id].keyframe;
+        offset = m_entries[id].offset;
+        return true;
+    }
+
+    void RC4SnapshotPool::SeekTo(std::uint32_t keyframe, std::uint32_t offset, const GameStructs::RC4State& keyframeState, RC4Cursor& cursor) {
+        if (cursor.keyframe != keyframe || cursor.offset > offset) {
+            cursor.keyframe = keyframe;
+            cursor.offset = 0;
+            cursor.state = keyframeState;
+        }
+        if (offset > cursor.offset) {
+            Crypto::rc4_skip(cursor.state, offset - cursor.offset);
+            cursor.offset = offset;
+        }
+    }
+
+    void RC4SnapshotPool::Clear() {
+        m_keyframes.Clear();
+        m_entries.Clear();
+        m_hasExpected = false;
+        m_expectedOffset = 0;
+        m_packetsSinceKeyframe = 0;
+    }
+
+    std::size_t RC4SnapshotPool::MemoryBytes() const {
+        return m_keyframes.MemoryBytes() + m_entries.MemoryBytes();
+    }
+
+} // namespace kx
@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * @file RC4SnapshotPool.h
+ * @brief Compact out-of-line storage for the RC4 snapshots of received packets.
+ * @details Every encrypted packet needs the RC4 state the game held before processing it,
+ *          and a full RC4State (264 bytes) is usually larger than the packet. Received
+ *          traffic is one continuous keystream, though: the snapshot of packet n+1 is the
+ *          snapshot of packet n advanced by n's length. The pool therefore stores a full
+ *          keyframe only when the stream breaks (reconnect, missed packet) or every
+ *          KEYFRAME_INTERVAL_PACKETS packets / KEYFRAME_INTERVAL_BYTES keystream bytes, and
+ *          otherwise records just (keyframe, keystream offset). Get() rebuilds any snapshot
+ *          by skipping the keyframe forward, which is bounded by the byte interval.
+ *
+ *          Packets the capture policy does not log are passed to Skip(), so sampling only
+ *          widens the gaps between stored snapshots instead of breaking the stream.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "ChunkedArray.h"
+#include "GameStructs.h" // For RC4State
+
+namespace kx {
+
+    using RC4SnapshotId = std::uint32_t;
+    constexpr RC4SnapshotId INVALID_RC4_SNAPSHOT = std::numeric_limits<RC4SnapshotId>::max();
+
+    /**
+     * @brief A position in the pooled keystream, for decrypting many packets in order.
+     * @details After Seek(), process the packet with rc4_process_stream(cursor.state, ...)
+     *          and add its length to `offset`; the next Seek() on the same keyframe then
+     *          only skips the gap instead of starting from the keyframe again.
+     */
+    struct RC4Cursor {
+        std::uint32_t keyframe = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t offset = 0;
+        GameStructs::RC4State state;
+    };
+
+    class RC4SnapshotPool {
+    public:
+        static constexpr std::uint32_t KEYFRAME_INTERVAL_PACKETS = 64;
+        static constexpr std::uint32_t KEYFRAME_INTERVAL_BYTES = 4 * 1024;
+
+        /**
+         * @brief Records the snapshot of the next packet.
+         * @param snapshot State before the packet was processed.
+         * @param consumedBytes Keystream bytes the packet used (its length).
+         * @param stateAfter `snapshot` advanced by consumedBytes, i.e. the state the caller
+         *                   ended up with after decrypting. Used to recognize continuation.
+         * @return Id for Get(), or INVALID_RC4_SNAPSHOT if the pool is full.
+         */
+        RC4SnapshotId Add(const GameStructs::RC4State& snapshot, std::size_t consumedBytes,
+            const GameStructs::RC4State& stateAfter);
+
+        /**
+         * @brief Advances the stream past a packet that is not logged, without storing it.
+         * @details Parameters as for Add(). If the packet does not continue the stream, or the
+         *          gap already exceeds the byte interval, the next Add() starts a keyframe.
+         */
+        void Skip(const GameStructs::RC4State& snapshot, std::size_t consumedBytes,
+            const GameStructs::RC4State& stateAfter);
+
+        /**
+         * @brief Reconstructs a stored snapshot.
+         * @return False if the id is unknown.
+         */
+        bool Get(RC4SnapshotId id, GameStructs::RC4State& out) const;
+
+        /**
+         * @brief Moves `cursor` to snapshot `id`, continuing from its current position when
+         *        it is on the same keyframe and not past the snapshot.
+         * @return False if the id is unknown (the cursor is left unchanged).
+         */
+        bool Seek(RC4SnapshotId id, RC4Cursor& cursor) const;
+
+        /**
+         * @brief Keyframe and keystream offset of snapshot `id`, so it can be rebuilt with
+         *        SeekTo() from a copy of the keyframe without access to the pool.
+         * @return False if the id is unknown.
+         */
+        bool Locate(RC4SnapshotId id, std::uint32_t& keyframe, std::uint32_t& offset) const;
+        const GameStructs::RC4State& KeyframeState(std::uint32_t keyframe) const { return m_keyframes[keyframe]; }
+
+        /**
+         * @brief Seek() for a located snapshot, given the state of its keyframe.
+         */
+        static void SeekTo(std::uint32_t keyframe, std::uint32_t offset, const GameStructs::RC4State& keyframeState, RC4Cursor& cursor);
+
+        void Clear();
+
+        std::size_t Size() const { return m_entries.Size(); }
+        std::size_t KeyframeCount() const { return m_keyframes.Size(); }
+        std::size_t MemoryBytes() const;
+
+    private:
+        struct Entry {
+            std::uint32_t keyframe; // Index into m_keyframes
+            std::uint32_t offset;   // Keystream bytes to skip from the keyframe
+        };
+
+        // Chunked so that growing the pool under g_packetLogMutex never copies it.
+        ChunkedArray<GameStructs::RC4State, 256> m_keyframes;
+        ChunkedArray<Entry, 4096> m_entries;
+
+        GameStructs::RC4State m_expected;      // State the next snapshot has if the stream continues
+        bool m_hasExpected = false;
+        std::uint32_t m_expectedOffset = 0;    // Offset of m_expected from the current keyframe
+        std::uint32_t m_packetsSinceKeyframe = 0;
+    };
+
+    // Snapshots referenced by PacketInfo::rc4Snapshot in g_packetLog. Guarded by
+    // g_packetLogMutex and cleared together with the log.
+    extern RC4SnapshotPool g_rc4Snapshots;
+
+} // namespace kx
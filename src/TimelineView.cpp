@@ -0,0 +1,254 @@
+#include "TimelineView.h"
+#include "TrafficTimeline.h"
+#include "FormattingUtils.h"
+#include "PacketHeaders.h"   // For GetPacketName
+#include "../ImGui/imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace kx::TimelineView {
+
+    namespace {
+
+        constexpr float LABEL_WIDTH = 190.0f;
+        constexpr double MIN_SPAN_MS = 1.0;
+        constexpr float ZOOM_STEP = 1.25f;
+        constexpr int INTENSITY_LEVELS = 8;
+
+        bool s_wholeSession = true;
+        bool s_followLive = false;
+        double s_startMs = 0.0; // Unix time in milliseconds
+        double s_endMs = 0.0;
+
+        // Last query, reused while the view and the session are unchanged, and its cells
+        // quantized to INTENSITY_LEVELS (row 0: all packets, then the opcode rows).
+        Timeline::Density s_density;
+        std::vector<std::uint8_t> s_intensity;
+        double s_queriedStartMs = 0.0;
+        double s_queriedEndMs = 0.0;
+        double s_queriedLastMs = 0.0;
+        std::chrono::steady_clock::time_point s_queryTime;
+
+        void ForceRefresh() {
+            s_queriedLastMs = -1.0;
+            s_queryTime = {};
+        }
+
+        std::string FormatSpan(double ms) {
+            char text[32];
+            if (ms < 1000.0) {
+                snprintf(text, sizeof(text), "%.2f ms", ms);
+            }
+            else if (ms < 60000.0) {
+                snprintf(text, sizeof(text), "%.2f s", ms / 1000.0);
+            }
+            else if (ms < 3600000.0) {
+                const int seconds = static_cast<int>(ms / 1000.0);
+                snprintf(text, sizeof(text), "%dm %02ds", seconds / 60, seconds % 60);
+            }
+            else {
+                const int minutes = static_cast<int>(ms / 60000.0);
+                snprintf(text, sizeof(text), "%dh %02dm", minutes / 60, minutes % 60);
+            }
+            return text;
+        }
+
+        std::string FormatTime(double ms) {
+            const auto whole = static_cast<std::int64_t>(std::floor(ms));
+            const std::chrono::system_clock::time_point tp{ std::chrono::milliseconds(whole) };
+            char millis[8];
+            snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(((whole % 1000) + 1000) % 1000));
+            return Utils::FormatTimestamp(tp) + millis;
+        }
+
+        std::string DescribeKey(std::uint16_t key) {
+            const PacketDirection direction = Timeline::KeyDirection(key);
+            const std::uint8_t header = Timeline::KeyHeader(key);
+            char text[96];
+            snprintf(text, sizeof(text), "[%s] 0x%02X %s", direction == PacketDirection::Sent ? "S" : "R",
+                header, GetPacketName(direction, header).c_str());
+            return text;
+        }
+
+        // Log scale relative to the busiest column of the row.
+        void QuantizeRow(const float* counts, int columns, std::uint8_t* out) {
+            float maxCount = 0.0f;
+            for (int c = 0; c < columns; ++c) {
+                maxCount = std::max(maxCount, counts[c]);
+            }
+            const float scale = maxCount > 0.0f ? static_cast<float>(INTENSITY_LEVELS) / std::log1p(maxCount) : 0.0f;
+            for (int c = 0; c < columns; ++c) {
+                out[c] = counts[c] <= 0.0f ? 0
+                    : static_cast<std::uint8_t>(std::clamp(static_cast<int>(std::ceil(std::log1p(counts[c]) * scale)), 1, INTENSITY_LEVELS));
+            }
+        }
+
+        // One rectangle per run of columns with the same intensity.
+        void DrawRow(ImDrawList* drawList, float x, float y, float height, const std::uint8_t* intensity, int columns, ImU32 color) {
+            const ImVec4 base = ImGui::ColorConvertU32ToFloat4(color);
+            for (int c = 0; c < columns;) {
+                const int level = intensity[c];
+                int end = c + 1;
+                while (end < columns && intensity[end] == level) ++end;
+                if (level > 0) {
+                    const float alpha = base.w * static_cast<float>(level) / static_cast<float>(INTENSITY_LEVELS);
+                    drawList->AddRectFilled(ImVec2(x + static_cast<float>(c), y), ImVec2(x + static_cast<float>(end), y + height),
+                        ImGui::GetColorU32(ImVec4(base.x, base.y, base.z, alpha)));
+                }
+                c = end;
+            }
+        }
+
+    } // anonymous namespace
+
+
+    void Render() {
+        const Timeline::SessionRange range = Timeline::GetSessionRange();
+        if (range.empty) {
+            ImGui::TextDisabled("No packets captured yet.");
+            return;
+        }
+
+        if (ImGui::SmallButton("Whole Session")) {
+            s_wholeSession = true;
+            s_followLive = false;
+            ForceRefresh();
+        }
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Follow Live", &s_followLive)) {
+            ForceRefresh();
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("(wheel: zoom, drag: pan)");
+
+        const double sessionSpan = std::max(MIN_SPAN_MS, range.lastMs - range.firstMs);
+        const double maxSpan = sessionSpan * 1.25;
+
+        // New packets move the whole-session and live views at most every REQUERY_INTERVAL.
+        const auto now = std::chrono::steady_clock::now();
+        const bool refreshDue = range.lastMs != s_queriedLastMs && now - s_queryTime >= REQUERY_INTERVAL;
+        if (refreshDue && s_wholeSession) {
+            s_startMs = range.firstMs;
+            s_endMs = range.firstMs + sessionSpan;
+        }
+        else if (refreshDue && s_followLive) {
+            const double span = s_endMs - s_startMs;
+            s_endMs = range.lastMs;
+            s_startMs = s_endMs - span;
+        }
+
+        const float stripWidth = std::max(50.0f, ImGui::GetContentRegionAvail().x - LABEL_WIDTH);
+        const int columns = static_cast<int>(stripWidth);
+        const bool viewMoved = s_density.columns != columns || s_startMs != s_queriedStartMs || s_endMs != s_queriedEndMs;
+        if (viewMoved || refreshDue) {
+            s_density = Timeline::Query(s_startMs, s_endMs, columns);
+            const std::size_t cells = static_cast<std::size_t>(columns);
+            const std::size_t shownRows = std::min<std::size_t>(MAX_ROWS, s_density.keys.size());
+            s_intensity.resize((shownRows + 1) * cells);
+            QuantizeRow(s_density.totals.data(), columns, s_intensity.data());
+            for (std::size_t row = 0; row < shownRows; ++row) {
+                QuantizeRow(s_density.counts.data() + row * cells, columns, s_intensity.data() + (row + 1) * cells);
+            }
+            s_queriedStartMs = s_startMs;
+            s_queriedEndMs = s_endMs;
+            s_queriedLastMs = range.lastMs;
+            s_queryTime = now;
+        }
+        const Timeline::Density& density = s_density;
+        const int rows = std::min(MAX_ROWS, static_cast<int>(density.keys.size()));
+        const float rowHeight = ImGui::GetTextLineHeight();
+        const float height = rowHeight * static_cast<float>(rows + 1);
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImGui::InvisibleButton("##TimelineStrip", ImVec2(LABEL_WIDTH + stripWidth, height));
+        ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY); // Zoom instead of scrolling the window
+        const bool hovered = ImGui::IsItemHovered();
+        const bool active = ImGui::IsItemActive();
+
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const float stripX = origin.x + LABEL_WIDTH;
+        drawList->AddRectFilled(ImVec2(stripX, origin.y), ImVec2(stripX + stripWidth, origin.y + height), ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+        const ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+        drawList->AddText(ImVec2(origin.x, origin.y), textColor, "All packets");
+        DrawRow(drawList, stripX, origin.y, rowHeight, s_intensity.data(), columns, ImGui::GetColorU32(ImGuiCol_PlotLines));
+        drawList->PushClipRect(origin, ImVec2(stripX - 4.0f, origin.y + height), true);
+        for (int row = 0; row < rows; ++row) {
+            const float y = origin.y + rowHeight * static_cast<float>(row + 1);
+            drawList->AddText(ImVec2(origin.x, y), textColor, DescribeKey(density.keys[static_cast<std::size_t>(row)]).c_str());
+        }
+        drawList->PopClipRect();
+        for (int row = 0; row < rows; ++row) {
+            const float y = origin.y + rowHeight * static_cast<float>(row + 1);
+            DrawRow(drawList, stripX, y, rowHeight, s_intensity.data() + static_cast<std::size_t>(row + 1) * columns, columns,
+                ImGui::GetColorU32(ImGuiCol_PlotHistogram));
+        }
+
+        // --- Zoom and pan ---
+        const ImGuiIO& io = ImGui::GetIO();
+        const double span = s_endMs - s_startMs;
+        const float mouseFraction = std::clamp((io.MousePos.x - stripX) / stripWidth, 0.0f, 1.0f);
+        if (hovered && io.MouseWheel != 0.0f) {
+            const double newSpan = std::clamp(span * std::pow(ZOOM_STEP, -io.MouseWheel), MIN_SPAN_MS, maxSpan);
+            if (s_followLive) {
+                s_startMs = s_endMs - newSpan;
+            }
+            else {
+                const double anchorMs = s_startMs + mouseFraction * span;
+                s_startMs = anchorMs - mouseFraction * newSpan;
+                s_endMs = s_startMs + newSpan;
+            }
+            s_wholeSession = false;
+        }
+        if (active && ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.0f) && io.MouseDelta.x != 0.0f) {
+            const double shift = -static_cast<double>(io.MouseDelta.x) / stripWidth * span;
+            s_startMs += shift;
+            s_endMs += shift;
+            s_wholeSession = false;
+            s_followLive = false;
+        }
+        // Keep some of the session in view.
+        const double currentSpan = s_endMs - s_startMs;
+        if (s_startMs > range.lastMs - currentSpan * 0.1) {
+            s_startMs = range.lastMs - currentSpan * 0.1;
+            s_endMs = s_startMs + currentSpan;
+        }
+        if (s_endMs < range.firstMs + currentSpan * 0.1) {
+            s_endMs = range.firstMs + currentSpan * 0.1;
+            s_startMs = s_endMs - currentSpan;
+        }
+
+        if (hovered && io.MousePos.x >= stripX) {
+            const int column = std::min(columns - 1, static_cast<int>(io.MousePos.x - stripX));
+            const int row = static_cast<int>((io.MousePos.y - origin.y) / rowHeight) - 1;
+            const double columnMs = span / columns;
+            ImGui::BeginTooltip();
+            ImGui::Text("%s (+%s)", FormatTime(s_startMs + column * columnMs).c_str(), FormatSpan(columnMs).c_str());
+            ImGui::Text("All packets: %.1f", density.totals[static_cast<std::size_t>(column)]);
+            if (row >= 0 && row < rows) {
+                ImGui::Text("%s: %.1f", DescribeKey(density.keys[static_cast<std::size_t>(row)]).c_str(),
+                    density.counts[static_cast<std::size_t>(row) * columns + column]);
+            }
+            ImGui::EndTooltip();
+        }
+
+        ImGui::TextDisabled("%s - %s | span %s | %s bins (level %d) | %zu opcodes | %.1f KB",
+            FormatTime(s_startMs).c_str(), FormatTime(s_endMs).c_str(), FormatSpan(span).c_str(),
+            FormatSpan(static_cast<double>(1ull << density.level)).c_str(), density.level,
+            density.keys.size(), static_cast<double>(Timeline::MemoryBytes()) / 1024.0);
+    }
+
+    void Reset() {
+        s_wholeSession = true;
+        s_followLive = false;
+        s_density = Timeline::Density();
+        s_intensity.clear();
+        ForceRefresh();
+    }
+
+} // namespace kx::TimelineView
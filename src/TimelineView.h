@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file TimelineView.h
+ * @brief Zoomable strip of packet density per opcode over the whole session.
+ * @details One row per opcode (the most active ones in view, plus a row for all packets),
+ *          one column per pixel. Columns come from Timeline::Query(), so drawing costs the
+ *          same at any zoom level, from the whole session down to a few milliseconds.
+ *          Cell brightness is the column's packet count on a log scale relative to the
+ *          busiest column of that row; the tooltip shows the actual counts. The query
+ *          result is reused until the view moves, or for REQUERY_INTERVAL while packets
+ *          keep arriving.
+ *
+ *          Mouse wheel zooms around the cursor, dragging pans. By default the strip shows
+ *          the whole session; with Follow Live the right edge stays on the latest packet.
+ */
+
+#include <chrono>
+
+namespace kx::TimelineView {
+
+    constexpr int MAX_ROWS = 12; // Opcode rows, besides the row for all packets
+    constexpr auto REQUERY_INTERVAL = std::chrono::milliseconds(100);
+
+    /**
+     * @brief Draws the strip and its controls into the current window.
+     */
+    void Render();
+
+    /**
+     * @brief Returns to the whole-session view (e.g. after Clear Log).
+     */
+    void Reset();
+
+} // namespace kx::TimelineView
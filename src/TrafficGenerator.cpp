@@ -0,0 +1,362 @@
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "TrafficGenerator.h"
+#include "PacketProcessor.h"
+#include "PacketHeaders.h"
+#include "CryptoUtils.h"
+#include "GameStructs.h"
+#include "HookQuiescence.h"
+#include "PacketStaging.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace kx::LoadTest {
+
+    namespace {
+
+        // Packets scheduled further in the past than this are not sent at all rather than late.
+        constexpr std::chrono::milliseconds MAX_SCHEDULE_LAG{ 50 };
+        constexpr std::size_t MAX_LATENCY_SAMPLES = 10000000;
+        // The load test's private log is numbered apart from live packets (and from the
+        // UI benchmark's log, numbered from 2^62).
+        constexpr PacketSequence LOAD_TEST_FIRST_SEQUENCE = 1ull << 61;
+
+        std::atomic<bool> s_isRunning = false;
+        std::atomic<bool> s_stopRequested = false;
+        std::mutex s_resultMutex;
+        std::optional<LoadTestResult> s_lastResult;
+
+        struct OpcodeWeight {
+            CMSG_HeaderId header;
+            int weight;
+        };
+
+        // Opcode mix per phase. Heartbeats are present everywhere, movement dominates
+        // while running around and skill use dominates in combat.
+        const std::vector<OpcodeWeight>& GetPhaseWeights(int phase) {
+            static const std::vector<OpcodeWeight> idle = {
+                { CMSG_HeaderId::HEARTBEAT, 70 },
+                { CMSG_HeaderId::SELECT_AGENT, 10 },
+                { CMSG_HeaderId::DESELECT_AGENT, 8 },
+                { CMSG_HeaderId::CHAT_SEND_MESSAGE, 7 },
+                { CMSG_HeaderId::MOVEMENT_END, 5 },
+            };
+            static const std::vector<OpcodeWeight> moving = {
+                { CMSG_HeaderId::MOVEMENT, 45 },
+                { CMSG_HeaderId::MOVEMENT_WITH_ROTATION, 25 },
+                { CMSG_HeaderId::HEARTBEAT, 10 },
+                { CMSG_HeaderId::MOUNT_MOVEMENT, 8 },
+                { CMSG_HeaderId::JUMP, 6 },
+                { CMSG_HeaderId::MOVEMENT_END, 6 },
+            };
+            static const std::vector<OpcodeWeight> combat = {
+                { CMSG_HeaderId::USE_SKILL, 40 },
+                { CMSG_HeaderId::MOVEMENT, 25 },
+                { CMSG_HeaderId::MOVEMENT_WITH_ROTATION, 15 },
+                { CMSG_HeaderId::SELECT_AGENT, 8 },
+                { CMSG_HeaderId::HEARTBEAT, 7 },
+                { CMSG_HeaderId::JUMP, 5 },
+            };
+            switch (phase) {
+                case 1:  return moving;
+                case 2:  return combat;
+                default: return idle;
+            }
+        }
+
+        double Percentile(std::vector<float>& samples, double fraction) {
+            if (samples.empty()) return 0.0;
+            std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+            std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+            return samples[index];
+        }
+
+        // Sequence the next logged packet gets; unlike the log size it keeps counting across Clear Log.
+        PacketSequence GetNextSequence() {
+            std::lock_guard<std::mutex> lock(g_packetLogMutex);
+            return g_packetLogFirstSequence + g_packetLog.size();
+        }
+
+    } // anonymous namespace
+
+
+    // --- TrafficGenerator ---
+
+    TrafficGenerator::TrafficGenerator(const TrafficConfig& config)
+        : m_config(config),
+          m_rng(config.seed),
+          m_smsgSize(std::log(std::max(config.smsgMedianSize, 2.0)), 1.0),
+          m_unit(0.0, 1.0)
+    {
+        std::uint8_t key[16];
+        for (auto& b : key) b = static_cast<std::uint8_t>(m_rng());
+        m_recvStream = Crypto::rc4_initialize_state(key, sizeof(key));
+    }
+
+    std::uint8_t TrafficGenerator::PickCmsgHeader() {
+        if (m_phaseRemaining <= 0) {
+            m_phase = static_cast<Phase>(m_rng() % 3);
+            m_phaseRemaining = std::max(1, m_config.burstLength);
+        }
+        --m_phaseRemaining;
+
+        const auto& weights = GetPhaseWeights(static_cast<int>(m_phase));
+        int total = 0;
+        for (const auto& w : weights) total += w.weight;
+        int pick = static_cast<int>(m_rng() % static_cast<std::uint32_t>(total));
+        for (const auto& w : weights) {
+            if (pick < w.weight) return static_cast<std::uint8_t>(w.header);
+            pick -= w.weight;
+        }
+        return static_cast<std::uint8_t>(CMSG_HeaderId::HEARTBEAT);
+    }
+
+    int TrafficGenerator::PickCmsgSize(std::uint8_t headerId) {
+        int minSize = 8;
+        int maxSize = 32;
+        switch (static_cast<CMSG_HeaderId>(headerId)) {
+            case CMSG_HeaderId::HEARTBEAT:              minSize = 6;  maxSize = 10;  break;
+            case CMSG_HeaderId::MOVEMENT:               minSize = 20; maxSize = 40;  break;
+            case CMSG_HeaderId::MOVEMENT_WITH_ROTATION: minSize = 24; maxSize = 44;  break;
+            case CMSG_HeaderId::MOVEMENT_END:           minSize = 16; maxSize = 24;  break;
+            case CMSG_HeaderId::MOUNT_MOVEMENT:         minSize = 24; maxSize = 48;  break;
+            case CMSG_HeaderId::JUMP:                   minSize = 8;  maxSize = 16;  break;
+            case CMSG_HeaderId::USE_SKILL:              minSize = 12; maxSize = 28;  break;
+            case CMSG_HeaderId::SELECT_AGENT:           minSize = 8;  maxSize = 12;  break;
+            case CMSG_HeaderId::DESELECT_AGENT:         minSize = 4;  maxSize = 8;   break;
+            case CMSG_HeaderId::CHAT_SEND_MESSAGE:      minSize = 24; maxSize = 256; break;
+            default: break;
+        }
+        return minSize + static_cast<int>(m_rng() % static_cast<std::uint32_t>(maxSize - minSize + 1));
+    }
+
+    SyntheticPacket TrafficGenerator::Next() {
+        SyntheticPacket packet;
+        Next(packet);
+        return packet;
+    }
+
+    void TrafficGenerator::Next(SyntheticPacket& out) {
+        out.rc4State.reset();
+
+        if (m_unit(m_rng) >= m_config.receivedRatio) {
+            out.direction = PacketDirection::Sent;
+            out.headerId = PickCmsgHeader();
+            out.bufferState = 0;
+            out.payload.resize(static_cast<std::size_t>(PickCmsgSize(out.headerId)));
+        }
+        else {
+            out.direction = PacketDirection::Received;
+            // A handful of hot opcodes carries most server traffic; the rest is spread out.
+            static constexpr std::uint8_t HOT_SMSG[] = { 0x01, 0x02, 0x05, 0x07, 0x0C, 0x15, 0x1D, 0x2A };
+            out.headerId = (m_rng() % 10 < 7) ? HOT_SMSG[m_rng() % (sizeof(HOT_SMSG))] : static_cast<std::uint8_t>(m_rng());
+            int size = std::clamp(static_cast<int>(m_smsgSize(m_rng)), 2, std::max(2, m_config.smsgMaxSize));
+            out.payload.resize(static_cast<std::size_t>(size));
+            out.bufferState = (m_unit(m_rng) < m_config.encryptedRatio) ? 3 : 0;
+        }
+
+        for (std::size_t k = 1; k < out.payload.size(); ++k) {
+            out.payload[k] = static_cast<std::uint8_t>(m_rng());
+        }
+        out.payload[0] = out.headerId;
+
+        // Received state-3 packets consume the shared keystream in order, exactly like the
+        // game's MsgConn RC4 state, so snapshots of consecutive packets chain together.
+        if (out.direction == PacketDirection::Received && out.bufferState == 3) {
+            out.rc4State = m_recvStream;
+            Crypto::rc4_process_stream(m_recvStream, out.payload.data(), out.payload.size());
+        }
+    }
+
+
+    // --- Load Test Driver ---
+
+    namespace {
+
+        struct ProducerResult {
+            std::size_t generated = 0;
+            std::size_t processed = 0;
+            std::size_t behindSchedule = 0;
+            std::vector<float> latenciesUs;
+        };
+
+        // One producer thread: its own generator (seeded by its index) at its share of the
+        // rate, scheduled so the producers' packets are evenly spaced overall.
+        void RunProducer(const TrafficConfig& config, unsigned index, unsigned producers,
+            std::chrono::steady_clock::time_point start, ProducerResult& result)
+        {
+            TrafficConfig producerConfig = config;
+            producerConfig.seed = config.seed + index;
+            TrafficGenerator generator(producerConfig);
+            SyntheticPacket packet;
+
+            // Backing storage for a fake MsgSendContext followed by its packet buffer.
+            constexpr std::size_t MAX_CMSG_SIZE = 1024;
+            std::vector<std::uint8_t> sendContextStorage(GameStructs::MsgSendContext::PACKET_BUFFER_OFFSET + MAX_CMSG_SIZE, 0);
+            auto* sendContext = reinterpret_cast<GameStructs::MsgSendContext*>(sendContextStorage.data());
+
+            const double rate = std::max(config.packetsPerSecond, 1.0);
+            const auto period = std::chrono::duration<double>(static_cast<double>(producers) / rate);
+            const auto offset = std::chrono::duration<double>(static_cast<double>(index) / rate);
+            const auto duration = std::chrono::duration<double>(std::max(config.durationSeconds, 0.1));
+
+            result.latenciesUs.reserve(std::min(MAX_LATENCY_SAMPLES / producers,
+                static_cast<std::size_t>(rate / producers * duration.count()) + 1));
+
+            for (std::size_t k = 0; !s_stopRequested.load(std::memory_order_relaxed); ++k) {
+                auto scheduled = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset + period * static_cast<double>(k));
+                if (scheduled - start >= duration) {
+                    break;
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                while (now < scheduled) {
+                    if (scheduled - now > std::chrono::milliseconds(2)) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    else {
+                        std::this_thread::yield();
+                    }
+                    now = std::chrono::steady_clock::now();
+                }
+
+                generator.Next(packet);
+                ++result.generated;
+
+                if (now - scheduled > MAX_SCHEDULE_LAG) {
+                    ++result.behindSchedule;
+                    continue;
+                }
+
+                auto callStart = std::chrono::steady_clock::now();
+                {
+                    // Counted like a detour, so unload waits for a call in progress.
+                    Quiescence::InFlightScope scope(Quiescence::g_hookTracker);
+                    if (packet.direction == PacketDirection::Sent) {
+                        std::size_t size = std::min(packet.payload.size(), MAX_CMSG_SIZE);
+                        std::memcpy(sendContext->GetPacketBufferStart(), packet.payload.data(), size);
+                        sendContext->currentBufferEndPtr = sendContext->GetPacketBufferStart() + size;
+                        sendContext->bufferState = 3;
+                        PacketProcessing::ProcessOutgoingPacket(sendContext);
+                    }
+                    else {
+                        PacketProcessing::ProcessIncomingPacket(packet.bufferState, packet.payload.data(), packet.payload.size(), packet.rc4State);
+                    }
+                }
+                auto callEnd = std::chrono::steady_clock::now();
+
+                ++result.processed;
+                if (result.latenciesUs.size() < MAX_LATENCY_SAMPLES / producers) {
+                    result.latenciesUs.push_back(std::chrono::duration<float, std::micro>(callEnd - callStart).count());
+                }
+            }
+        }
+
+    } // anonymous namespace
+
+    LoadTestResult RunLoadTest(const TrafficConfig& config) {
+        LoadTestResult result;
+        const unsigned producers = static_cast<unsigned>(std::clamp(config.producerThreads, 1, MAX_PRODUCER_THREADS));
+        std::vector<ProducerResult> producerResults(producers);
+
+        {
+            // Pauses live capture and publishes what it staged, so from here on the
+            // private log and the staging counters only see this run's packets.
+            IsolatedPacketLog isolated(LOAD_TEST_FIRST_SEQUENCE);
+            const PacketSequence sequenceBefore = GetNextSequence();
+            const std::uint64_t skippedBefore = Staging::GetStats().skipped;
+            const auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> threads;
+            threads.reserve(producers - 1);
+            for (unsigned t = 1; t < producers; ++t) {
+                threads.emplace_back(RunProducer, std::cref(config), t, producers, start, std::ref(producerResults[t]));
+            }
+            RunProducer(config, 0, producers, start, producerResults[0]);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            Staging::FlushAll();
+            result.logged = static_cast<std::size_t>(GetNextSequence() - sequenceBefore);
+            result.skipped = static_cast<std::size_t>(Staging::GetStats().skipped - skippedBefore);
+        }
+
+        std::vector<float> latenciesUs;
+        for (ProducerResult& producer : producerResults) {
+            result.generated += producer.generated;
+            result.processed += producer.processed;
+            result.behindSchedule += producer.behindSchedule;
+            latenciesUs.insert(latenciesUs.end(), producer.latenciesUs.begin(), producer.latenciesUs.end());
+            producer.latenciesUs = std::vector<float>();
+        }
+        // Logged and skipped packets are counted as they leave staging, so a packet lost
+        // anywhere between the processor and the log shows up here.
+        const std::size_t accounted = result.logged + result.skipped;
+        result.lost = result.processed > accounted ? result.processed - accounted : 0;
+        result.throughputPerSecond = result.elapsedSeconds > 0.0 ? static_cast<double>(result.processed) / result.elapsedSeconds : 0.0;
+        if (!latenciesUs.empty()) {
+            result.maxLatencyUs = *std::max_element(latenciesUs.begin(), latenciesUs.end());
+            result.p50LatencyUs = Percentile(latenciesUs, 0.50);
+            result.p99LatencyUs = Percentile(latenciesUs, 0.99);
+        }
+        return result;
+    }
+
+    bool StartAsync(const TrafficConfig& config) {
+        bool expected = false;
+        if (!s_isRunning.compare_exchange_strong(expected, true)) {
+            return false;
+        }
+        s_stopRequested = false;
+
+        const bool started = Quiescence::StartBackgroundThread("load-test", [config]() {
+            try {
+                std::cout << "[LoadTest] Generating " << config.packetsPerSecond << " packets/s for "
+                    << config.durationSeconds << " s on " << config.producerThreads << " thread(s)..." << std::endl;
+                LoadTestResult result = RunLoadTest(config);
+                std::cout << "[LoadTest] Processed " << result.processed << " (" << result.throughputPerSecond
+                    << "/s), " << result.behindSchedule << " behind schedule, " << result.logged << " logged, "
+                    << result.skipped << " skipped, " << result.lost << " lost, p99 " << result.p99LatencyUs << " us." << std::endl;
+                std::lock_guard<std::mutex> lock(s_resultMutex);
+                s_lastResult = result;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[LoadTest] Exception: " << e.what() << std::endl;
+            }
+            catch (...) {
+                std::cerr << "[LoadTest] Unknown exception." << std::endl;
+            }
+            s_isRunning = false;
+        });
+        if (!started) {
+            s_isRunning = false;
+        }
+        return started;
+    }
+
+    void RequestStop() {
+        s_stopRequested = true;
+    }
+
+    bool IsRunning() {
+        return s_isRunning.load();
+    }
+
+    std::optional<LoadTestResult> GetLastResult() {
+        std::lock_guard<std::mutex> lock(s_resultMutex);
+        return s_lastResult;
+    }
+
+} // namespace kx::LoadTest
@@ -0,0 +1,133 @@
+#pragma once
+
+/**
+ * @file TrafficGenerator.h
+ * @brief Deterministic synthetic GW2-like traffic for load testing and benchmarks.
+ * @details Produces CMSG/SMSG-shaped payloads using the opcodes from PacketHeaders.h
+ *          (heartbeats, movement bursts, skill use) and RC4-encrypts received packets
+ *          with a continuous keystream, exposing the RC4State snapshot the MsgRecv hook
+ *          would have captured. The load test drives the PacketProcessor entry points
+ *          directly at a target rate.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+#include "GameStructs.h" // For RC4State
+#include "PacketData.h"  // For PacketDirection
+
+namespace kx::LoadTest {
+
+    constexpr int MAX_PRODUCER_THREADS = 16;
+
+    /**
+     * @brief Configuration for the synthetic traffic stream.
+     */
+    struct TrafficConfig {
+        std::uint32_t seed = 0x4B58u;     // Same seed => identical packet sequence
+        double packetsPerSecond = 5000.0; // Target rate for RunLoadTest
+        double durationSeconds = 10.0;    // Length of a load test run
+        double receivedRatio = 0.4;       // Fraction of packets that are SMSG
+        double encryptedRatio = 1.0;      // Fraction of SMSG packets sent in state 3 (RC4)
+        double smsgMedianSize = 90.0;     // Median SMSG payload size (log-normal)
+        int smsgMaxSize = 4096;           // Upper bound for SMSG payload sizes
+        int burstLength = 200;            // Packets per movement/combat phase before switching
+        int producerThreads = 1;          // RunLoadTest threads sharing the rate, each with its own stream
+    };
+
+    /**
+     * @brief A single generated packet as the hooks would see it on the wire.
+     */
+    struct SyntheticPacket {
+        PacketDirection direction = PacketDirection::Sent;
+        std::uint8_t headerId = 0;                 // Plaintext opcode
+        int bufferState = 0;                       // 3 for RC4-encrypted SMSG
+        std::vector<std::uint8_t> payload;         // Wire bytes (ciphertext for state 3)
+        std::optional<GameStructs::RC4State> rc4State; // Snapshot before this packet was encrypted
+    };
+
+    /**
+     * @brief Generates a deterministic sequence of synthetic packets.
+     */
+    class TrafficGenerator {
+    public:
+        explicit TrafficGenerator(const TrafficConfig& config);
+
+        /**
+         * @brief Produces the next packet in the sequence.
+         */
+        SyntheticPacket Next();
+
+        /**
+         * @brief Like Next(), but reuses the payload buffer of `out` to avoid allocations.
+         */
+        void Next(SyntheticPacket& out);
+
+    private:
+        enum class Phase { Idle, Moving, Combat };
+
+        std::uint8_t PickCmsgHeader();
+        int PickCmsgSize(std::uint8_t headerId);
+
+        TrafficConfig m_config;
+        std::mt19937 m_rng;
+        std::lognormal_distribution<double> m_smsgSize;
+        std::uniform_real_distribution<double> m_unit;
+        GameStructs::RC4State m_recvStream; // Continuous keystream for received traffic
+        Phase m_phase = Phase::Idle;
+        int m_phaseRemaining = 0;
+    };
+
+    /**
+     * @brief Summary of a load test run.
+     */
+    struct LoadTestResult {
+        std::size_t generated = 0;     // Packets produced by the generator
+        std::size_t behindSchedule = 0; // Generated packets not sent because the driver fell behind schedule
+        std::size_t processed = 0;     // Packets handed to the processor
+        std::size_t logged = 0;        // Of `processed`, packets that reached the log
+        std::size_t skipped = 0;       // Of `processed`, packets the capture policy did not log
+        std::size_t lost = 0;          // Of `processed`, packets neither logged nor skipped; must be zero
+        double elapsedSeconds = 0.0;
+        double throughputPerSecond = 0.0; // processed / elapsedSeconds
+        double p50LatencyUs = 0.0;     // Per-call latency of the processor entry points
+        double p99LatencyUs = 0.0;
+        double maxLatencyUs = 0.0;
+    };
+
+    /**
+     * @brief Drives ProcessOutgoingPacket/ProcessIncomingPacket at the configured rate.
+     * @details Runs synchronously. With several producer threads each one runs its own
+     *          generator (seed + thread index, so its own RC4 keystream) at an equal share of
+     *          the rate, the calling thread being the first. Packets whose scheduled time is
+     *          more than MAX_SCHEDULE_LAG behind the clock are counted as behind schedule.
+     *
+     *          The run logs into an IsolatedPacketLog, so live capture is paused meanwhile
+     *          and the synthetic packets are gone from the log view afterwards; the traffic
+     *          statistics, rate graph and timeline do count them. Every processed packet must
+     *          come out of staging either logged (a sequence number in the private log) or
+     *          skipped by the capture policy; the difference is reported as `lost`.
+     */
+    LoadTestResult RunLoadTest(const TrafficConfig& config);
+
+    /**
+     * @brief Starts RunLoadTest on a background thread (see Quiescence::StartBackgroundThread).
+     * @return False if a run is already in progress or the thread could not be started.
+     */
+    bool StartAsync(const TrafficConfig& config);
+
+    /**
+     * @brief Asks a running load test to stop early. Also called at unload.
+     */
+    void RequestStop();
+
+    bool IsRunning();
+
+    /**
+     * @brief Returns the result of the last completed run, if any.
+     */
+    std::optional<LoadTestResult> GetLastResult();
+
+} // namespace kx::LoadTest
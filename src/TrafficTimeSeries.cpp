@@ -0,0 +1,173 @@
+#include "TrafficTimeSeries.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace kx::TimeSeries {
+
+    namespace {
+
+        constexpr std::size_t DIRECTION_COUNT = 2;
+        constexpr std::size_t HEADER_COUNT = 256;
+
+        /**
+         * @brief Ring of per-bucket packet and byte totals keyed by absolute bucket number.
+         */
+        class RateRing {
+        public:
+            RateRing(std::size_t capacity, std::int64_t bucketMs)
+                : m_packets(capacity, 0.0f), m_bytes(capacity, 0.0f), m_bucketMs(bucketMs) {
+            }
+
+            void Add(std::int64_t timestampMs, float bytes) {
+                const std::int64_t bucket = timestampMs / m_bucketMs;
+                const std::int64_t capacity = static_cast<std::int64_t>(m_packets.size());
+
+                if (bucket > m_lastBucket) {
+                    // Zero the buckets skipped since the last packet (at most one full lap).
+                    std::int64_t first = std::max(m_lastBucket + 1, bucket - capacity + 1);
+                    for (std::int64_t b = first; b <= bucket; ++b) {
+                        std::size_t slot = SlotOf(b);
+                        m_packets[slot] = 0.0f;
+                        m_bytes[slot] = 0.0f;
+                    }
+                    m_lastBucket = bucket;
+                }
+                else if (bucket <= m_lastBucket - capacity) {
+                    return; // Older than the ring can hold
+                }
+
+                std::size_t slot = SlotOf(bucket);
+                m_packets[slot] += 1.0f;
+                m_bytes[slot] += bytes;
+            }
+
+            void CopyRates(std::int64_t nowMs, Series& out) const {
+                const std::int64_t capacity = static_cast<std::int64_t>(m_packets.size());
+                const std::int64_t endBucket = nowMs / m_bucketMs - 1; // Last complete bucket
+                const float scale = 1000.0f / static_cast<float>(m_bucketMs);
+
+                out.packetsPerSecond.assign(m_packets.size(), 0.0f);
+                out.bytesPerSecond.assign(m_bytes.size(), 0.0f);
+                out.sampleIntervalSeconds = static_cast<double>(m_bucketMs) / 1000.0;
+
+                for (std::int64_t i = 0; i < capacity; ++i) {
+                    std::int64_t bucket = endBucket - capacity + 1 + i;
+                    if (bucket < 0 || bucket > m_lastBucket || bucket <= m_lastBucket - capacity) {
+                        continue;
+                    }
+                    std::size_t slot = SlotOf(bucket);
+                    out.packetsPerSecond[static_cast<std::size_t>(i)] = m_packets[slot] * scale;
+                    out.bytesPerSecond[static_cast<std::size_t>(i)] = m_bytes[slot] * scale;
+                }
+            }
+
+            void Clear() {
+                std::fill(m_packets.begin(), m_packets.end(), 0.0f);
+                std::fill(m_bytes.begin(), m_bytes.end(), 0.0f);
+                m_lastBucket = -1;
+            }
+
+        private:
+            std::size_t SlotOf(std::int64_t bucket) const {
+                return static_cast<std::size_t>(bucket % static_cast<std::int64_t>(m_packets.size()));
+            }
+
+            std::vector<float> m_packets;
+            std::vector<float> m_bytes;
+            std::int64_t m_bucketMs;
+            std::int64_t m_lastBucket = -1;
+        };
+
+        struct DirectionSeries {
+            RateRing coarse{ COARSE_SAMPLES, 1000 };
+            RateRing fine{ FINE_SAMPLES, 100 };
+        };
+
+        std::mutex s_seriesMutex;
+        DirectionSeries s_directions[DIRECTION_COUNT];
+        std::unique_ptr<RateRing> s_opcodes[DIRECTION_COUNT][HEADER_COUNT];
+
+        std::size_t DirectionIndex(PacketDirection direction) {
+            return (direction == PacketDirection::Sent) ? 0 : 1;
+        }
+
+        std::int64_t ToMilliseconds(std::chrono::system_clock::time_point tp) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+        }
+
+        // Requires s_seriesMutex.
+        void Record(PacketDirection direction, std::uint8_t headerId, float bytes, std::int64_t ms) {
+            const std::size_t dir = DirectionIndex(direction);
+            s_directions[dir].coarse.Add(ms, bytes);
+            s_directions[dir].fine.Add(ms, bytes);
+
+            auto& opcodeRing = s_opcodes[dir][headerId];
+            if (!opcodeRing) {
+                opcodeRing = std::make_unique<RateRing>(OPCODE_SAMPLES, 1000);
+            }
+            opcodeRing->Add(ms, bytes);
+        }
+
+    } // anonymous namespace
+
+
+    void RecordPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+        std::chrono::system_clock::time_point timestamp)
+    {
+        const std::int64_t ms = ToMilliseconds(timestamp);
+        if (ms < 0) return;
+        std::lock_guard<std::mutex> lock(s_seriesMutex);
+        Record(direction, headerId, static_cast<float>(size), ms);
+    }
+
+    void RecordPackets(const TrafficSample* samples, std::size_t count) {
+        std::lock_guard<std::mutex> lock(s_seriesMutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::int64_t ms = ToMilliseconds(samples[i].timestamp);
+            if (ms < 0) continue;
+            Record(samples[i].direction, samples[i].headerId, static_cast<float>(samples[i].size), ms);
+        }
+    }
+
+    Series GetDirectionSeries(PacketDirection direction, Resolution resolution,
+        std::chrono::system_clock::time_point now)
+    {
+        Series series;
+        std::lock_guard<std::mutex> lock(s_seriesMutex);
+        const DirectionSeries& entry = s_directions[DirectionIndex(direction)];
+        (resolution == Resolution::Fine ? entry.fine : entry.coarse).CopyRates(ToMilliseconds(now), series);
+        return series;
+    }
+
+    Series GetOpcodeSeries(PacketDirection direction, std::uint8_t headerId,
+        std::chrono::system_clock::time_point now)
+    {
+        Series series;
+        std::lock_guard<std::mutex> lock(s_seriesMutex);
+        const auto& opcodeRing = s_opcodes[DirectionIndex(direction)][headerId];
+        if (opcodeRing) {
+            opcodeRing->CopyRates(ToMilliseconds(now), series);
+        }
+        else {
+            series.packetsPerSecond.assign(OPCODE_SAMPLES, 0.0f);
+            series.bytesPerSecond.assign(OPCODE_SAMPLES, 0.0f);
+        }
+        return series;
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(s_seriesMutex);
+        for (auto& entry : s_directions) {
+            entry.coarse.Clear();
+            entry.fine.Clear();
+        }
+        for (auto& direction : s_opcodes) {
+            for (auto& opcodeRing : direction) {
+                opcodeRing.reset();
+            }
+        }
+    }
+
+} // namespace kx::TimeSeries
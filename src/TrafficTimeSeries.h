@@ -0,0 +1,61 @@
+#pragma once
+
+/**
+ * @file TrafficTimeSeries.h
+ * @brief Fixed-size ring buffers of packets/s and bytes/s for the overlay graphs.
+ * @details Samples are bucketed by the packets' capture timestamps as they are logged,
+ *          so there is no sampling thread or timer: a bucket is closed implicitly when a
+ *          packet from a later bucket arrives, and empty buckets read back as zero.
+ *          Per-direction series are kept at 1 Hz for one hour and at 10 Hz for five
+ *          minutes; per-opcode series at 1 Hz for five minutes, allocated on first use.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PacketData.h" // For PacketDirection, TrafficSample
+
+namespace kx::TimeSeries {
+
+    constexpr std::size_t COARSE_SAMPLES = 3600; // 1 Hz, 1 hour
+    constexpr std::size_t FINE_SAMPLES = 3000;   // 10 Hz, 5 minutes
+    constexpr std::size_t OPCODE_SAMPLES = 300;  // 1 Hz, 5 minutes
+
+    enum class Resolution {
+        Coarse, // 1 Hz
+        Fine    // 10 Hz
+    };
+
+    /**
+     * @brief A copied-out series, oldest sample first, ending at the last complete bucket.
+     */
+    struct Series {
+        std::vector<float> packetsPerSecond;
+        std::vector<float> bytesPerSecond;
+        double sampleIntervalSeconds = 1.0;
+    };
+
+    /**
+     * @brief Adds one logged packet to the direction and opcode series. Thread-safe.
+     */
+    void RecordPacket(PacketDirection direction, std::uint8_t headerId, std::size_t size,
+        std::chrono::system_clock::time_point timestamp);
+
+    /**
+     * @brief Adds a batch of packets (logged or skipped) under one lock acquisition. Thread-safe.
+     */
+    void RecordPackets(const TrafficSample* samples, std::size_t count);
+
+    Series GetDirectionSeries(PacketDirection direction, Resolution resolution,
+        std::chrono::system_clock::time_point now);
+
+    /**
+     * @brief Returns the 1 Hz series for one opcode (all zeros if it was never seen).
+     */
+    Series GetOpcodeSeries(PacketDirection direction, std::uint8_t headerId,
+        std::chrono::system_clock::time_point now);
+
+    void Reset();
+
+} // namespace kx::TimeSeries
@@ -0,0 +1,337 @@
+#include "TrafficTimeline.h"
+#include "ChunkedArray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <numeric>
+
+namespace kx::Timeline {
+
+    namespace {
+
+        // A stored count: opcode key in the top 9 bits, count in the low 23. A count that
+        // reaches the maximum continues in a second entry with the same key.
+        using Entry = std::uint32_t;
+        constexpr int ENTRY_COUNT_BITS = 23;
+        constexpr std::uint32_t ENTRY_COUNT_MASK = (1u << ENTRY_COUNT_BITS) - 1;
+        constexpr std::uint32_t NO_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+        struct Bin {
+            std::uint32_t index;      // Bin number since the session origin
+            std::uint32_t firstEntry; // Entries run up to the next bin's firstEntry
+        };
+
+        /**
+         * @brief One stored resolution of the pyramid: the non-empty bins in time order.
+         */
+        class Level {
+        public:
+            Level() : m_openSlot(KEY_COUNT, NO_SLOT) {}
+
+            void Add(std::uint32_t index, std::uint16_t key) {
+                if (m_bins.Empty() || index > m_bins.Back().index) {
+                    CloseBin();
+                    m_bins.PushBack({ index, static_cast<std::uint32_t>(m_entries.Size()) });
+                }
+
+                std::uint32_t& slot = m_openSlot[key];
+                if (slot == NO_SLOT || (m_entries[slot] & ENTRY_COUNT_MASK) == ENTRY_COUNT_MASK) {
+                    slot = static_cast<std::uint32_t>(m_entries.Size());
+                    m_entries.PushBack((static_cast<std::uint32_t>(key) << ENTRY_COUNT_BITS) | 1u);
+                }
+                else {
+                    ++m_entries[slot];
+                }
+            }
+
+            const ChunkedArray<Bin>& Bins() const { return m_bins; }
+            const ChunkedArray<Entry>& Entries() const { return m_entries; }
+
+            std::size_t EntriesEnd(std::size_t bin) const {
+                return bin + 1 < m_bins.Size() ? m_bins[bin + 1].firstEntry : m_entries.Size();
+            }
+
+            std::size_t MemoryBytes() const {
+                return m_bins.MemoryBytes() + m_entries.MemoryBytes() + m_openSlot.capacity() * sizeof(std::uint32_t);
+            }
+
+            void Clear() {
+                m_bins.Clear();
+                m_entries.Clear();
+                std::fill(m_openSlot.begin(), m_openSlot.end(), NO_SLOT);
+            }
+
+        private:
+            void CloseBin() {
+                if (m_bins.Empty()) return;
+                for (std::size_t e = m_bins.Back().firstEntry; e < m_entries.Size(); ++e) {
+                    m_openSlot[m_entries[e] >> ENTRY_COUNT_BITS] = NO_SLOT;
+                }
+            }
+
+            ChunkedArray<Bin> m_bins;
+            ChunkedArray<Entry> m_entries;
+            std::vector<std::uint32_t> m_openSlot; // Key -> latest entry of the open bin
+        };
+
+        /**
+         * @brief Spreads bins over the columns of a Density by overlap.
+         */
+        class Accumulator {
+        public:
+            Accumulator(Density& density, double relativeStart, double msPerColumn)
+                : m_density(density), m_rowOfKey(KEY_COUNT, -1), m_relativeStart(relativeStart), m_msPerColumn(msPerColumn) {
+            }
+
+            // False if the bin lies outside the columns.
+            bool BeginBin(double binStart, double binMs) {
+                const double from = (binStart - m_relativeStart) / m_msPerColumn;
+                const double width = binMs / m_msPerColumn;
+                const double to = from + width;
+                m_firstColumn = std::max(0, static_cast<int>(std::floor(from)));
+                const int lastColumn = std::min(m_density.columns - 1, static_cast<int>(std::ceil(to)) - 1);
+                m_weights.clear();
+                m_inRange = 0.0f;
+                m_binTotal = 0.0f;
+                for (int column = m_firstColumn; column <= lastColumn; ++column) {
+                    const double overlap = std::min(to, column + 1.0) - std::max(from, static_cast<double>(column));
+                    m_weights.push_back(static_cast<float>(std::max(0.0, overlap) / width));
+                    m_inRange += m_weights.back();
+                }
+                return !m_weights.empty();
+            }
+
+            void Add(std::uint16_t key, float count) {
+                int& row = m_rowOfKey[key];
+                if (row < 0) {
+                    row = static_cast<int>(m_density.keys.size());
+                    m_density.keys.push_back(key);
+                    m_density.keyTotals.push_back(0.0);
+                    m_density.counts.resize(m_density.counts.size() + static_cast<std::size_t>(m_density.columns), 0.0f);
+                }
+                float* rowCounts = m_density.counts.data() + static_cast<std::size_t>(row) * m_density.columns + m_firstColumn;
+                for (std::size_t w = 0; w < m_weights.size(); ++w) {
+                    rowCounts[w] += count * m_weights[w];
+                }
+                m_density.keyTotals[static_cast<std::size_t>(row)] += count * m_inRange;
+                m_binTotal += count;
+            }
+
+            void EndBin() {
+                float* totals = m_density.totals.data() + m_firstColumn;
+                for (std::size_t w = 0; w < m_weights.size(); ++w) {
+                    totals[w] += m_binTotal * m_weights[w];
+                }
+            }
+
+        private:
+            Density& m_density;
+            std::vector<int> m_rowOfKey;
+            std::vector<float> m_weights; // Share of the current bin per column, from m_firstColumn on
+            double m_relativeStart;
+            double m_msPerColumn;
+            int m_firstColumn = 0;
+            float m_inRange = 0.0f;
+            float m_binTotal = 0.0f;
+        };
+
+        std::mutex s_timelineMutex;
+        Level s_levels[LEVEL_COUNT]; // Levels below FIRST_STORED_LEVEL, except FINE_STORED_LEVEL, stay empty
+        ChunkedArray<std::uint32_t> s_packetTimes; // Milliseconds since the origin, non-decreasing
+        ChunkedArray<std::uint16_t> s_packetKeys;
+        bool s_hasOrigin = false;
+        std::int64_t s_originMs = 0; // Timestamp of the first packet; bin indices count from here
+
+        std::int64_t ToMilliseconds(std::chrono::system_clock::time_point tp) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+        }
+
+        // Requires s_timelineMutex.
+        void ReadStoredLevel(int level, double relativeStart, double relativeEnd, Accumulator& accumulator) {
+            const double binMs = static_cast<double>(std::uint64_t{ 1 } << level);
+            const double firstIndex = std::max(0.0, std::floor(relativeStart / binMs));
+            if (firstIndex > static_cast<double>(std::numeric_limits<std::uint32_t>::max())) {
+                return;
+            }
+
+            const Level& source = s_levels[level];
+            const ChunkedArray<Bin>& bins = source.Bins();
+            const ChunkedArray<Entry>& entries = source.Entries();
+            std::size_t bin = bins.LowerBound(0, bins.Size(), static_cast<std::uint32_t>(firstIndex),
+                [](const Bin& b, std::uint32_t index) { return b.index < index; });
+            for (; bin < bins.Size(); ++bin) {
+                const double binStart = static_cast<double>(bins[bin].index) * binMs;
+                if (binStart >= relativeEnd) break;
+                if (!accumulator.BeginBin(binStart, binMs)) continue;
+                const std::size_t end = source.EntriesEnd(bin);
+                for (std::size_t e = bins[bin].firstEntry; e < end; ++e) {
+                    const Entry entry = entries[e];
+                    accumulator.Add(static_cast<std::uint16_t>(entry >> ENTRY_COUNT_BITS), static_cast<float>(entry & ENTRY_COUNT_MASK));
+                }
+                accumulator.EndBin();
+            }
+        }
+
+        // Requires s_timelineMutex. Reads 1 ms bins from the packet times; false (nothing
+        // read) if the range holds more than `maxPackets`.
+        bool ReadPacketTimes(double relativeStart, double relativeEnd, std::size_t maxPackets, Accumulator& accumulator) {
+            const double first = std::max(0.0, std::floor(relativeStart));
+            const double last = std::ceil(relativeEnd);
+            const auto less = [](std::uint32_t time, double value) { return static_cast<double>(time) < value; };
+            const std::size_t begin = s_packetTimes.LowerBound(0, s_packetTimes.Size(), first, less);
+            const std::size_t end = s_packetTimes.LowerBound(begin, s_packetTimes.Size(), last, less);
+            if (end - begin > maxPackets) {
+                return false;
+            }
+
+            for (std::size_t i = begin; i < end;) {
+                const std::uint32_t time = s_packetTimes[i];
+                if (accumulator.BeginBin(static_cast<double>(time), 1.0)) {
+                    for (; i < end && s_packetTimes[i] == time; ++i) {
+                        accumulator.Add(s_packetKeys[i], 1.0f);
+                    }
+                    accumulator.EndBin();
+                }
+                else {
+                    for (; i < end && s_packetTimes[i] == time; ++i) {}
+                }
+            }
+            return true;
+        }
+
+        // Requires s_timelineMutex.
+        void Record(std::uint16_t key, std::int64_t ms) {
+            if (!s_hasOrigin) {
+                s_hasOrigin = true;
+                s_originMs = ms;
+            }
+
+            std::int64_t relative = std::max<std::int64_t>(0, ms - s_originMs);
+            if (!s_packetTimes.Empty()) {
+                relative = std::max<std::int64_t>(relative, s_packetTimes.Back()); // Late packet
+            }
+            if (relative > std::numeric_limits<std::uint32_t>::max()) {
+                return; // Past ~49 days of session
+            }
+
+            s_packetTimes.PushBack(static_cast<std::uint32_t>(relative));
+            s_packetKeys.PushBack(key);
+            s_levels[FINE_STORED_LEVEL].Add(static_cast<std::uint32_t>(relative >> FINE_STORED_LEVEL), key);
+            for (int level = FIRST_STORED_LEVEL; level < LEVEL_COUNT; ++level) {
+                s_levels[level].Add(static_cast<std::uint32_t>(relative >> level), key);
+            }
+        }
+
+    } // anonymous namespace
+
+
+    void RecordPacket(PacketDirection direction, std::uint8_t headerId,
+        std::chrono::system_clock::time_point timestamp)
+    {
+        const std::int64_t ms = ToMilliseconds(timestamp);
+        std::lock_guard<std::mutex> lock(s_timelineMutex);
+        Record(MakeKey(direction, headerId), ms);
+    }
+
+    void RecordPackets(const TrafficSample* samples, std::size_t count) {
+        std::lock_guard<std::mutex> lock(s_timelineMutex);
+        for (std::size_t i = 0; i < count; ++i) {
+            Record(MakeKey(samples[i].direction, samples[i].headerId), ToMilliseconds(samples[i].timestamp));
+        }
+    }
+
+    SessionRange GetSessionRange() {
+        SessionRange range;
+        std::lock_guard<std::mutex> lock(s_timelineMutex);
+        if (s_hasOrigin && !s_packetTimes.Empty()) {
+            range.empty = false;
+            range.firstMs = static_cast<double>(s_originMs);
+            range.lastMs = static_cast<double>(s_originMs + s_packetTimes.Back()) + 1.0; // End of the last 1 ms bin
+        }
+        return range;
+    }
+
+    Density Query(double startMs, double endMs, int columns) {
+        Density density;
+        if (columns <= 0 || !(endMs > startMs)) {
+            return density;
+        }
+        density.columns = columns;
+        density.totals.assign(static_cast<std::size_t>(columns), 0.0f);
+
+        const double msPerColumn = (endMs - startMs) / columns;
+        int level = 0;
+        if (msPerColumn >= 1.0) {
+            level = std::min(LEVEL_COUNT - 1, static_cast<int>(std::floor(std::log2(msPerColumn))));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_timelineMutex);
+            if (!s_hasOrigin) {
+                return density;
+            }
+            const double relativeStart = startMs - static_cast<double>(s_originMs);
+            const double relativeEnd = endMs - static_cast<double>(s_originMs);
+            if (relativeEnd <= 0.0) {
+                return density;
+            }
+
+            Accumulator accumulator(density, relativeStart, msPerColumn);
+            if (level < FIRST_STORED_LEVEL) {
+                const std::size_t maxPackets = static_cast<std::size_t>(columns) * RAW_PACKETS_PER_COLUMN;
+                if (ReadPacketTimes(relativeStart, relativeEnd, maxPackets, accumulator)) {
+                    level = 0;
+                }
+                else {
+                    level = FINE_STORED_LEVEL;
+                    ReadStoredLevel(level, relativeStart, relativeEnd, accumulator);
+                }
+            }
+            else {
+                ReadStoredLevel(level, relativeStart, relativeEnd, accumulator);
+            }
+        }
+        density.level = level;
+
+        // Most active opcodes first.
+        std::vector<std::size_t> order(density.keys.size());
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+        std::stable_sort(order.begin(), order.end(), [&density](std::size_t a, std::size_t b) {
+            return density.keyTotals[a] > density.keyTotals[b];
+        });
+        Density sorted;
+        sorted.columns = density.columns;
+        sorted.level = density.level;
+        sorted.totals = std::move(density.totals);
+        sorted.counts.reserve(density.counts.size());
+        for (std::size_t row : order) {
+            sorted.keys.push_back(density.keys[row]);
+            sorted.keyTotals.push_back(density.keyTotals[row]);
+            sorted.counts.insert(sorted.counts.end(), density.counts.begin() + row * columns, density.counts.begin() + (row + 1) * columns);
+        }
+        return sorted;
+    }
+
+    std::size_t MemoryBytes() {
+        std::lock_guard<std::mutex> lock(s_timelineMutex);
+        std::size_t bytes = s_packetTimes.MemoryBytes() + s_packetKeys.MemoryBytes();
+        for (const Level& level : s_levels) {
+            bytes += level.MemoryBytes();
+        }
+        return bytes;
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(s_timelineMutex);
+        for (Level& level : s_levels) {
+            level.Clear();
+        }
+        s_packetTimes.Clear();
+        s_packetKeys.Clear();
+        s_hasOrigin = false;
+        s_originMs = 0;
+    }
+
+} // namespace kx::Timeline
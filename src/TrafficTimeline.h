@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * @file TrafficTimeline.h
+ * @brief Packet counts per opcode over the whole session, at power-of-two time resolutions.
+ * @details Level k of the pyramid splits the session into bins of 2^k milliseconds (1 ms up
+ *          to about 2.3 hours). Every logged or skipped packet is added as it is captured,
+ *          so the pyramid is always current and nothing is rebuilt.
+ *
+ *          - Levels from FIRST_STORED_LEVEL (64 ms) up, plus FINE_STORED_LEVEL (8 ms),
+ *            store the packet count of every opcode that occurs in each bin. They are
+ *            sparse: only bins with packets and only the opcodes in them are kept, so
+ *            memory grows with the traffic, not with the session length.
+ *          - The other fine levels would hold about one entry per packet each. Instead they
+ *            are read from the packets' own times and opcodes (6 bytes per packet).
+ *
+ *          Query() picks the level whose bins are just narrower than a column of the
+ *          requested view. The work is proportional to the number of columns times the
+ *          opcodes per bin, however many packets the range covers. Levels below
+ *          FIRST_STORED_LEVEL are read from packet times only while the view holds at most
+ *          RAW_PACKETS_PER_COLUMN packets per column. Denser views use FINE_STORED_LEVEL,
+ *          whose bins are at most 8 per column there, and bins wider than a column are
+ *          spread over the columns they cover. Dense traffic thus resolves to 8 ms.
+ *
+ *          Storage grows in fixed-size chunks, so recording a packet never copies the
+ *          existing data.
+ *
+ *          Packets arrive in timestamp order (see PacketStaging.h) unless the system clock
+ *          is set back. A late packet is counted at the latest time seen so far.
+ */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PacketData.h" // For PacketDirection, TrafficSample
+
+namespace kx::Timeline {
+
+    constexpr int LEVEL_COUNT = 24;        // Bins of 2^0 .. 2^23 ms
+    constexpr int FIRST_STORED_LEVEL = 6;  // 64 ms
+    constexpr int FINE_STORED_LEVEL = 3;   // 8 ms; the only stored level below FIRST_STORED_LEVEL
+    constexpr int RAW_PACKETS_PER_COLUMN = 8;
+    constexpr std::size_t KEY_COUNT = 512; // Direction x header id
+
+    inline std::uint16_t MakeKey(PacketDirection direction, std::uint8_t headerId) {
+        return static_cast<std::uint16_t>((direction == PacketDirection::Sent ? 0 : 256) + headerId);
+    }
+
+    inline PacketDirection KeyDirection(std::uint16_t key) {
+        return key < 256 ? PacketDirection::Sent : PacketDirection::Received;
+    }
+
+    inline std::uint8_t KeyHeader(std::uint16_t key) {
+        return static_cast<std::uint8_t>(key & 0xFF);
+    }
+
+    /**
+     * @brief Adds one captured packet. Thread-safe.
+     */
+    void RecordPacket(PacketDirection direction, std::uint8_t headerId,
+        std::chrono::system_clock::time_point timestamp);
+
+    /**
+     * @brief Adds a batch of packets under one lock acquisition. Thread-safe.
+     */
+    void RecordPackets(const TrafficSample* samples, std::size_t count);
+
+    struct SessionRange {
+        bool empty = true;
+        double firstMs = 0.0; // Unix time in milliseconds
+        double lastMs = 0.0;
+    };
+
+    SessionRange GetSessionRange();
+
+    /**
+     * @brief Packet counts of [startMs, endMs) split into equal columns.
+     * @details A bin that straddles column boundaries is split between the columns by
+     *          overlap, so the counts are fractional and a steady packet rate gives even
+     *          columns at every zoom level.
+     */
+    struct Density {
+        int columns = 0;
+        int level = 0;                   // Pyramid level the counts were read from (0: packet times)
+        std::vector<std::uint16_t> keys; // Opcodes with packets in the range, most packets first
+        std::vector<double> keyTotals;   // Packets of each opcode in the range
+        std::vector<float> counts;       // keys.size() rows of `columns` counts
+        std::vector<float> totals;       // All opcodes, per column
+    };
+
+    Density Query(double startMs, double endMs, int columns);
+
+    std::size_t MemoryBytes();
+
+    void Reset();
+
+} // namespace kx::Timeline
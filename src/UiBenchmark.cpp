@@ -0,0 +1,275 @@
+#include "UiBenchmark.h"
+#include "../ImGui/imgui.h"
+#include "Benchmark.h"       // For MakeSyntheticLog, CurrentTimestampIso
+#include "ImGuiManager.h"
+#include "GuiStyle.h"
+#include "AppState.h"        // For g_showSearchMatchesOnly
+#include "Config.h"          // For APP_VERSION
+#include "PacketData.h"
+#include "UiRefresh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace kx::Benchmark {
+
+    namespace {
+
+        constexpr PacketSequence SYNTHETIC_FIRST_SEQUENCE = 1ull << 62;
+
+        std::atomic<bool> s_pending{ false };
+        std::mutex s_uiMutex;
+        UiBenchmarkConfig s_pendingConfig;
+        std::optional<UiBenchmarkResult> s_lastUiResult;
+
+        // Wraps the active ImGui allocator and counts what goes through it.
+        struct AllocationCounter {
+            ImGuiMemAllocFunc alloc = nullptr;
+            ImGuiMemFreeFunc free = nullptr;
+            void* userData = nullptr;
+            std::uint64_t allocations = 0;
+            std::uint64_t bytes = 0;
+        };
+
+        void* CountingAlloc(std::size_t size, void* userData) {
+            auto* counter = static_cast<AllocationCounter*>(userData);
+            ++counter->allocations;
+            counter->bytes += size;
+            return counter->alloc(size, counter->userData);
+        }
+
+        void CountingFree(void* ptr, void* userData) {
+            auto* counter = static_cast<AllocationCounter*>(userData);
+            counter->free(ptr, counter->userData);
+        }
+
+        // Shows a synthetic log in place of the live one (see IsolatedPacketLog) and turns
+        // off "search matches only", since search results index the live log.
+        class LiveLogSwap {
+        public:
+            explicit LiveLogSwap(std::deque<PacketInfo> log)
+                : m_searchMatchesOnly(g_showSearchMatchesOnly), m_isolated(SYNTHETIC_FIRST_SEQUENCE, std::move(log))
+            {
+                g_showSearchMatchesOnly = false;
+            }
+
+            ~LiveLogSwap() {
+                g_showSearchMatchesOnly = m_searchMatchesOnly;
+            }
+
+            LiveLogSwap(const LiveLogSwap&) = delete;
+            LiveLogSwap& operator=(const LiveLogSwap&) = delete;
+
+        private:
+            bool m_searchMatchesOnly = false;
+            IsolatedPacketLog m_isolated;
+        };
+
+        double Percentile(const std::vector<double>& sorted, double fraction) {
+            if (sorted.empty()) return 0.0;
+            std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size()));
+            return sorted[std::min(index, sorted.size() - 1)];
+        }
+
+    } // anonymous namespace
+
+
+    UiBenchmarkResult RunUiBenchmark(const UiBenchmarkConfig& config) {
+        UiBenchmarkResult result;
+        result.rows = config.rows;
+        result.frames = std::max(1, config.frames);
+        result.rebuildRateHz = std::max(0, config.rebuildRateHz);
+
+        LiveLogSwap swap(MakeSyntheticLog(config.rows));
+
+        // A backend-less context sharing the overlay's font atlas (already built by the renderer).
+        ImGuiContext* previousContext = ImGui::GetCurrentContext();
+        ImFontAtlas* sharedAtlas = previousContext ? ImGui::GetIO().Fonts : nullptr;
+        ImGuiContext* context = ImGui::CreateContext(sharedAtlas);
+        ImGui::SetCurrentContext(context);
+
+        AllocationCounter counter;
+        ImGui::GetAllocatorFunctions(&counter.alloc, &counter.free, &counter.userData);
+        ImGui::SetAllocatorFunctions(CountingAlloc, CountingFree, &counter);
+
+        std::vector<double> frameUs;
+        frameUs.reserve(static_cast<std::size_t>(result.frames));
+        double totalVertices = 0.0;
+        double totalIndices = 0.0;
+        double totalCommands = 0.0;
+
+        try {
+            UiRefresh::RebuildScheduler scheduler;
+            scheduler.SetRateHz(result.rebuildRateHz);
+            UiRefresh::DrawDataCache cache;
+            auto simulatedTime = std::chrono::steady_clock::now();
+            const auto gameFrame = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1.0 / std::max(1.0, config.gameFrameRateHz)));
+            auto lastRebuild = simulatedTime;
+
+            ImGuiIO& io = ImGui::GetIO();
+            io.IniFilename = nullptr;
+            io.LogFilename = nullptr;
+            io.DisplaySize = ImVec2(config.displayWidth, config.displayHeight);
+            io.DeltaTime = 1.0f / 60.0f;
+            if (!sharedAtlas) {
+                unsigned char* pixels = nullptr;
+                int width = 0, height = 0;
+                io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+            }
+            GUIStyle::ApplyCustomStyle();
+
+            const int totalFrames = std::max(0, config.warmupFrames) + result.frames;
+            for (int frame = 0; frame < totalFrames; ++frame) {
+                const bool measured = frame >= config.warmupFrames;
+                counter.allocations = 0;
+                counter.bytes = 0;
+
+                simulatedTime += gameFrame;
+
+                const auto start = std::chrono::steady_clock::now();
+                const ImDrawData* drawData = nullptr;
+                const bool rebuild = scheduler.ShouldRebuild(simulatedTime, cache.Get() != nullptr, false);
+                if (rebuild) {
+                    if (result.rebuildRateHz > 0) {
+                        io.DeltaTime = std::chrono::duration<float>(simulatedTime - lastRebuild).count();
+                        lastRebuild = simulatedTime;
+                    }
+                    ImGui::NewFrame();
+                    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
+                    ImGui::SetNextWindowSize(io.DisplaySize, ImGuiCond_Always);
+                    ImGuiManager::RenderUI();
+                    ImGui::Render();
+                    drawData = ImGui::GetDrawData();
+                    if (result.rebuildRateHz > 0) {
+                        cache.Store(*drawData);
+                    }
+                }
+                else {
+                    drawData = cache.Get();
+                }
+                const auto end = std::chrono::steady_clock::now();
+
+                if (!measured) continue;
+                frameUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+                result.rebuiltFrames += rebuild ? 1 : 0;
+                totalVertices += drawData->TotalVtxCount;
+                totalIndices += drawData->TotalIdxCount;
+                for (int n = 0; n < drawData->CmdListsCount; ++n) {
+                    totalCommands += drawData->CmdLists[n]->CmdBuffer.Size;
+                }
+                result.allocationsPerFrame += static_cast<double>(counter.allocations);
+                result.allocatedBytesPerFrame += static_cast<double>(counter.bytes);
+            }
+        }
+        catch (...) {
+            ImGui::SetAllocatorFunctions(counter.alloc, counter.free, counter.userData);
+            ImGui::DestroyContext(context);
+            ImGui::SetCurrentContext(previousContext);
+            throw;
+        }
+
+        ImGui::SetAllocatorFunctions(counter.alloc, counter.free, counter.userData);
+        ImGui::DestroyContext(context);
+        ImGui::SetCurrentContext(previousContext);
+
+        const double frames = static_cast<double>(frameUs.size());
+        double totalUs = 0.0;
+        for (double us : frameUs) totalUs += us;
+        std::sort(frameUs.begin(), frameUs.end());
+        result.meanFrameUs = totalUs / frames;
+        result.p50FrameUs = Percentile(frameUs, 0.50);
+        result.p99FrameUs = Percentile(frameUs, 0.99);
+        result.maxFrameUs = frameUs.back();
+        result.meanVertices = totalVertices / frames;
+        result.meanIndices = totalIndices / frames;
+        result.meanDrawCommands = totalCommands / frames;
+        result.allocationsPerFrame /= frames;
+        result.allocatedBytesPerFrame /= frames;
+        return result;
+    }
+
+    bool RequestUiBenchmark(const UiBenchmarkConfig& config) {
+        std::lock_guard<std::mutex> lock(s_uiMutex);
+        if (s_pending.load()) {
+            return false;
+        }
+        s_pendingConfig = config;
+        s_pending = true;
+        return true;
+    }
+
+    bool IsUiBenchmarkPending() {
+        return s_pending.load();
+    }
+
+    void RunPendingUiBenchmark() {
+        if (!s_pending.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        UiBenchmarkConfig config;
+        {
+            std::lock_guard<std::mutex> lock(s_uiMutex);
+            config = s_pendingConfig;
+        }
+
+        try {
+            std::cout << "[UiBenchmark] Rendering " << config.frames << " frames over " << config.rows << " rows..." << std::endl;
+            UiBenchmarkResult result = RunUiBenchmark(config);
+            WriteUiResultsJson(result, UI_RESULTS_JSON_FILE);
+            std::cout << "[UiBenchmark] Mean " << result.meanFrameUs << " us/frame, p99 " << result.p99FrameUs
+                << " us, " << result.meanVertices << " vertices. Results written to " << UI_RESULTS_JSON_FILE << std::endl;
+            std::lock_guard<std::mutex> lock(s_uiMutex);
+            s_lastUiResult = result;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[UiBenchmark] Exception: " << e.what() << std::endl;
+        }
+        catch (...) {
+            std::cerr << "[UiBenchmark] Unknown exception." << std::endl;
+        }
+        s_pending = false;
+    }
+
+    std::optional<UiBenchmarkResult> GetLastUiBenchmarkResult() {
+        std::lock_guard<std::mutex> lock(s_uiMutex);
+        return s_lastUiResult;
+    }
+
+    bool WriteUiResultsJson(const UiBenchmarkResult& result, const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[UiBenchmark] Failed to open " << path << " for writing." << std::endl;
+            return false;
+        }
+
+        out << "{\n";
+        out << "  \"version\": \"" << APP_VERSION << "\",\n";
+        out << "  \"timestamp\": \"" << CurrentTimestampIso() << "\",\n";
+        out << std::fixed << std::setprecision(3);
+        out << "  \"rows\": " << result.rows << ",\n";
+        out << "  \"frames\": " << result.frames << ",\n";
+        out << "  \"rebuild_rate_hz\": " << result.rebuildRateHz << ",\n";
+        out << "  \"rebuilt_frames\": " << result.rebuiltFrames << ",\n";
+        out << "  \"mean_frame_us\": " << result.meanFrameUs << ",\n";
+        out << "  \"p50_frame_us\": " << result.p50FrameUs << ",\n";
+        out << "  \"p99_frame_us\": " << result.p99FrameUs << ",\n";
+        out << "  \"max_frame_us\": " << result.maxFrameUs << ",\n";
+        out << "  \"mean_vertices\": " << result.meanVertices << ",\n";
+        out << "  \"mean_indices\": " << result.meanIndices << ",\n";
+        out << "  \"mean_draw_commands\": " << result.meanDrawCommands << ",\n";
+        out << "  \"imgui_allocations_per_frame\": " << result.allocationsPerFrame << ",\n";
+        out << "  \"imgui_allocated_bytes_per_frame\": " << result.allocatedBytesPerFrame << "\n";
+        out << "}\n";
+        return static_cast<bool>(out);
+    }
+
+} // namespace kx::Benchmark
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * @file UiBenchmark.h
+ * @brief Headless benchmark of the inspector overlay (ImGuiManager::RenderUI).
+ * @details Renders the UI for a number of frames in a second ImGui context that has no
+ *          platform or renderer backend, over a synthetic packet log swapped in for the
+ *          live one, and reports the CPU time of each frame (NewFrame through Render), the
+ *          vertex/index/draw-command counts of the resulting draw data and the ImGui heap
+ *          allocations per frame. Nothing is submitted to the GPU.
+ *
+ *          With rebuildRateHz set, frames are paced by a simulated clock at gameFrameRateHz
+ *          and scheduled like the overlay's capped rebuild rate (UiRefresh.h) without input:
+ *          rebuilt frames also pay for caching the draw data, replayed frames only fetch it.
+ *
+ *          ImGui state is thread-affine, so the run happens on the render thread between
+ *          two game frames: the Diagnostics button queues it and D3DRenderHook calls
+ *          RunPendingUiBenchmark() before starting its own ImGui frame. Capture is paused
+ *          for the duration and the live log is restored afterwards.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace kx::Benchmark {
+
+    struct UiBenchmarkConfig {
+        std::size_t rows = 100000; // Synthetic packets in the log
+        int warmupFrames = 10;     // Not measured (window creation, first layout)
+        int frames = 240;
+        float displayWidth = 1920.0f;
+        float displayHeight = 1080.0f;
+        int rebuildRateHz = 0;           // 0 rebuilds every frame
+        double gameFrameRateHz = 144.0;  // Simulated frame rate when rebuildRateHz is set
+    };
+
+    struct UiBenchmarkResult {
+        std::size_t rows = 0;
+        int frames = 0;
+        int rebuildRateHz = 0;
+        int rebuiltFrames = 0;   // Measured frames that built the UI
+        double meanFrameUs = 0.0;
+        double p50FrameUs = 0.0;
+        double p99FrameUs = 0.0;
+        double maxFrameUs = 0.0;
+        double meanVertices = 0.0;
+        double meanIndices = 0.0;
+        double meanDrawCommands = 0.0;
+        double allocationsPerFrame = 0.0;   // ImGui heap allocations (std containers are not counted)
+        double allocatedBytesPerFrame = 0.0;
+    };
+
+    /**
+     * @brief Renders the UI headlessly and measures it.
+     * @details Must be called on the thread that owns the ImGui context (if any) and
+     *          outside of an ImGui frame. The current context and its font atlas are
+     *          reused; without a current context a default font atlas is built.
+     */
+    UiBenchmarkResult RunUiBenchmark(const UiBenchmarkConfig& config);
+
+    /**
+     * @brief Queues a run for the next RunPendingUiBenchmark() call.
+     * @return False if a run is already queued.
+     */
+    bool RequestUiBenchmark(const UiBenchmarkConfig& config);
+    bool IsUiBenchmarkPending();
+
+    /**
+     * @brief Executes a queued run, writing UI_RESULTS_JSON_FILE. Cheap when none is queued.
+     */
+    void RunPendingUiBenchmark();
+
+    std::optional<UiBenchmarkResult> GetLastUiBenchmarkResult();
+
+    bool WriteUiResultsJson(const UiBenchmarkResult& result, const std::string& path);
+
+    constexpr const char* UI_RESULTS_JSON_FILE = "kx_ui_benchmark_results.json";
+
+} // namespace kx::Benchmark
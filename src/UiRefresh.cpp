@@ -0,0 +1,179 @@
+#include "UiRefresh.h"
+
+#include <windows.h> // For the WM_* message ids
+
+#include <cstring>
+
+namespace kx::UiRefresh {
+
+    namespace {
+
+        template <typename T>
+        void CopyBuffer(ImVector<T>& destination, const ImVector<T>& source) {
+            // ImVector's assignment frees and reallocates; resize() keeps the capacity.
+            destination.resize(source.Size);
+            if (source.Size > 0) {
+                std::memcpy(destination.Data, source.Data, source.size_in_bytes());
+            }
+        }
+
+        bool ForcesRebuild(unsigned int message, bool overOverlay) {
+            switch (message) {
+            case WM_MOUSEMOVE:
+            case WM_NCMOUSEMOVE:
+                return overOverlay;
+            case WM_MOUSELEAVE:
+            case WM_NCMOUSELEAVE:
+            case WM_LBUTTONDOWN: case WM_LBUTTONDBLCLK: case WM_LBUTTONUP:
+            case WM_RBUTTONDOWN: case WM_RBUTTONDBLCLK: case WM_RBUTTONUP:
+            case WM_MBUTTONDOWN: case WM_MBUTTONDBLCLK: case WM_MBUTTONUP:
+            case WM_XBUTTONDOWN: case WM_XBUTTONDBLCLK: case WM_XBUTTONUP:
+            case WM_MOUSEWHEEL:
+            case WM_MOUSEHWHEEL:
+            case WM_KEYDOWN: case WM_KEYUP:
+            case WM_SYSKEYDOWN: case WM_SYSKEYUP:
+            case WM_CHAR:
+            case WM_SETFOCUS:
+            case WM_KILLFOCUS:
+            case WM_SIZE:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        RebuildScheduler s_scheduler;
+        DrawDataCache s_cache;
+        Stats s_stats;
+
+    } // anonymous namespace
+
+
+    // --- DrawDataCache ---
+
+    DrawDataCache::~DrawDataCache() {
+        for (ImDrawList* list : m_lists) {
+            IM_DELETE(list);
+        }
+    }
+
+    void DrawDataCache::Store(const ImDrawData& drawData) {
+        while (m_lists.Size < drawData.CmdListsCount) {
+            m_lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        }
+
+        m_drawData.CmdLists.resize(0);
+        for (int n = 0; n < drawData.CmdListsCount; ++n) {
+            const ImDrawList* source = drawData.CmdLists[n];
+            ImDrawList* copy = m_lists[n];
+            CopyBuffer(copy->CmdBuffer, source->CmdBuffer);
+            CopyBuffer(copy->IdxBuffer, source->IdxBuffer);
+            CopyBuffer(copy->VtxBuffer, source->VtxBuffer);
+            copy->Flags = source->Flags;
+            m_drawData.CmdLists.push_back(copy);
+        }
+
+        m_drawData.Valid = true;
+        m_drawData.CmdListsCount = drawData.CmdListsCount;
+        m_drawData.TotalIdxCount = drawData.TotalIdxCount;
+        m_drawData.TotalVtxCount = drawData.TotalVtxCount;
+        m_drawData.DisplayPos = drawData.DisplayPos;
+        m_drawData.DisplaySize = drawData.DisplaySize;
+        m_drawData.FramebufferScale = drawData.FramebufferScale;
+        m_drawData.OwnerViewport = nullptr; // The viewport is rebuilt each frame; the renderer does not need it
+        m_valid = true;
+    }
+
+    ImDrawData* DrawDataCache::Get() {
+        return m_valid ? &m_drawData : nullptr;
+    }
+
+    void DrawDataCache::Clear() {
+        for (ImDrawList* list : m_lists) {
+            IM_DELETE(list);
+        }
+        m_lists.clear();
+        m_drawData.Clear();
+        m_valid = false;
+    }
+
+
+    // --- RebuildScheduler ---
+
+    void RebuildScheduler::SetRateHz(int rateHz) {
+        m_rateHz = rateHz > 0 ? rateHz : 0;
+    }
+
+    bool RebuildScheduler::ShouldRebuild(std::chrono::steady_clock::time_point now, bool hasCachedFrame, bool mouseHeld) {
+        bool rebuild = m_rateHz == 0 || !hasCachedFrame || mouseHeld
+            || now - m_lastRebuild >= std::chrono::microseconds(1000000 / m_rateHz);
+
+        if (m_forced.exchange(false, std::memory_order_relaxed)) {
+            m_settleFrames = SETTLE_FRAMES;
+            rebuild = true;
+        }
+        else if (m_settleFrames > 0) {
+            --m_settleFrames;
+            rebuild = true;
+        }
+
+        if (rebuild) {
+            m_lastRebuild = now;
+        }
+        return rebuild;
+    }
+
+
+    // --- The overlay's scheduler and cache ---
+
+    void SetRateCapHz(int rateHz) {
+        s_scheduler.SetRateHz(rateHz);
+        if (s_scheduler.GetRateHz() == 0) {
+            s_cache.Clear();
+        }
+    }
+
+    int GetRateCapHz() {
+        return s_scheduler.GetRateHz();
+    }
+
+    void NotifyInput(unsigned int message, bool overOverlay) {
+        if (ForcesRebuild(message, overOverlay)) {
+            s_scheduler.ForceRebuild();
+        }
+    }
+
+    void RequestRebuild() {
+        s_scheduler.ForceRebuild();
+    }
+
+    bool BeginFrame() {
+        const bool rebuild = s_scheduler.ShouldRebuild(std::chrono::steady_clock::now(),
+            s_cache.Get() != nullptr, ImGui::IsAnyMouseDown() && ImGui::GetIO().WantCaptureMouse);
+        ++(rebuild ? s_stats.rebuiltFrames : s_stats.replayedFrames);
+        return rebuild;
+    }
+
+    void StoreFrame(const ImDrawData* drawData) {
+        if (s_scheduler.GetRateHz() > 0 && drawData && drawData->Valid) {
+            s_cache.Store(*drawData);
+        }
+    }
+
+    ImDrawData* GetCachedFrame() {
+        return s_cache.Get();
+    }
+
+    Stats GetStats() {
+        return s_stats;
+    }
+
+    void ResetStats() {
+        s_stats = Stats();
+    }
+
+    void Shutdown() {
+        s_cache.Clear();
+    }
+
+} // namespace kx::UiRefresh
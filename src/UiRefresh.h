@@ -0,0 +1,119 @@
+#pragma once
+
+/**
+ * @file UiRefresh.h
+ * @brief Optional cap on how often the overlay UI is rebuilt.
+ * @details Building the inspector window (ImGui::NewFrame() through ImGui::Render()) every
+ *          game frame is wasted work at high frame rates when the log changes slowly. With
+ *          a rate cap set, the UI is rebuilt at most that many times per second and the
+ *          other frames submit a copy of the last ImDrawData again.
+ *
+ *          Input keeps the overlay responsive: a message from the window procedure (clicks,
+ *          keys, wheel, and mouse movement over the overlay) forces a rebuild on the next
+ *          frame and on SETTLE_FRAMES frames after it, since some ImGui interactions take a
+ *          frame or two to settle (popups, resizes, scrolling). While a mouse button is held
+ *          the UI is rebuilt every frame. Input events are queued by the Win32 backend
+ *          between rebuilds, so none are lost.
+ *
+ *          Render-thread only, except NotifyInput().
+ */
+
+#include "../ImGui/imgui.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace kx::UiRefresh {
+
+    constexpr int DEFAULT_RATE_HZ = 30;
+    constexpr int SETTLE_FRAMES = 3;
+
+    /**
+     * @brief A deep copy of an ImDrawData that can be rendered again on later frames.
+     * @details The copied draw lists keep their buffers between Store() calls, so caching
+     *          a frame of the same size does not allocate.
+     */
+    class DrawDataCache {
+    public:
+        DrawDataCache() = default;
+        ~DrawDataCache();
+
+        DrawDataCache(const DrawDataCache&) = delete;
+        DrawDataCache& operator=(const DrawDataCache&) = delete;
+
+        void Store(const ImDrawData& drawData);
+        ImDrawData* Get(); // Null if nothing is stored
+        void Clear();
+
+    private:
+        ImDrawData m_drawData;
+        ImVector<ImDrawList*> m_lists; // Owned, m_drawData.CmdLists points into a prefix of it
+        bool m_valid = false;
+    };
+
+    /**
+     * @brief Decides per frame whether to rebuild the UI or replay the cached frame.
+     */
+    class RebuildScheduler {
+    public:
+        void SetRateHz(int rateHz); // 0 rebuilds every frame
+        int GetRateHz() const { return m_rateHz; }
+
+        void ForceRebuild() { m_forced.store(true, std::memory_order_relaxed); }
+
+        /**
+         * @param hasCachedFrame False forces a rebuild.
+         * @param mouseHeld True while a mouse button is held on the overlay.
+         */
+        bool ShouldRebuild(std::chrono::steady_clock::time_point now, bool hasCachedFrame, bool mouseHeld);
+
+    private:
+        int m_rateHz = 0;
+        std::chrono::steady_clock::time_point m_lastRebuild;
+        int m_settleFrames = 0;
+        std::atomic<bool> m_forced{ false };
+    };
+
+    // --- The overlay's scheduler and cache ---
+
+    void SetRateCapHz(int rateHz); // 0 disables the cap
+    int GetRateCapHz();
+
+    /**
+     * @brief Called from the window procedure for every message ImGui sees.
+     * @param overOverlay io.WantCaptureMouse; mouse movement elsewhere does not force a rebuild.
+     */
+    void NotifyInput(unsigned int message, bool overOverlay);
+
+    /**
+     * @brief Forces a rebuild on the next frame (e.g. when the overlay is shown again).
+     */
+    void RequestRebuild();
+
+    /**
+     * @brief True if this frame should build the UI; false to replay GetCachedFrame().
+     */
+    bool BeginFrame();
+
+    /**
+     * @brief Keeps a copy of a freshly built frame for replay. No-op without a rate cap.
+     */
+    void StoreFrame(const ImDrawData* drawData);
+
+    ImDrawData* GetCachedFrame();
+
+    struct Stats {
+        std::uint64_t rebuiltFrames = 0;
+        std::uint64_t replayedFrames = 0;
+    };
+
+    Stats GetStats();
+    void ResetStats();
+
+    /**
+     * @brief Frees the cached frame. Call before destroying the ImGui context.
+     */
+    void Shutdown();
+
+} // namespace kx::UiRefresh
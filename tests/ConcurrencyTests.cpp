@@ -0,0 +1,105 @@
+/**
+ * @file ConcurrencyTests.cpp
+ * @brief Runs the hook quiescence and capture control checks outside the game.
+ * @details The same checks are available as buttons in the overlay; here they run as a
+ *          plain executable so they can be built under ThreadSanitizer (see CMakeLists.txt).
+ *          Usage: kx_concurrency_tests <hook_quiescence|capture_control|background_threads>
+ *          Returns 0 if the check passed.
+ */
+
+#include "CaptureControl.h"
+#include "HookQuiescence.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+    // Short runs: under ThreadSanitizer every atomic access is instrumented.
+    constexpr unsigned TEST_THREADS = 8;
+    constexpr int TEST_DURATION_MS = 1000;
+
+    bool TestHookQuiescence() {
+        kx::Quiescence::StressTestConfig config;
+        config.producerThreads = TEST_THREADS;
+        config.durationMs = TEST_DURATION_MS;
+        const kx::Quiescence::StressTestResult result = kx::Quiescence::RunStressTest(config);
+
+        std::cout << "[Tests] Hook quiescence: " << result.shutdownCycles << " cycles, " << result.bodyEntries
+            << " bodies, " << result.violations << " violations, " << result.timeouts << " timeouts, max drain "
+            << result.maxDrainUs << " us." << std::endl;
+        return result.shutdownCycles > 0 && result.violations == 0 && result.timeouts == 0;
+    }
+
+    bool TestCaptureControl() {
+        const kx::Capture::ToggleTestResult result = kx::Capture::RunToggleTest(TEST_THREADS, TEST_DURATION_MS);
+
+        std::cout << "[Tests] Capture control: " << result.toggles << " toggles, " << result.reads << " reads, "
+            << result.lostUpdates << " lost updates, " << result.invariantViolations << " violations." << std::endl;
+        return result.toggles > 0 && result.reads > 0 && result.lostUpdates == 0 && result.invariantViolations == 0;
+    }
+
+    // Unload relies on WaitForBackgroundThreads() covering every started thread, including
+    // one whose body throws.
+    bool TestBackgroundThreads() {
+        constexpr int THREAD_COUNT = 16;
+        std::atomic<bool> release{ false };
+        std::atomic<int> finished{ 0 };
+
+        for (int n = 0; n < THREAD_COUNT; ++n) {
+            const bool started = kx::Quiescence::StartBackgroundThread("test", [&release, &finished, n]() {
+                while (!release.load()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                finished.fetch_add(1);
+                if (n == 0) {
+                    throw std::runtime_error("expected test exception");
+                }
+            });
+            if (!started) {
+                std::cerr << "[Tests] Background thread " << n << " did not start." << std::endl;
+                return false;
+            }
+        }
+
+        const bool timedOut = !kx::Quiescence::WaitForBackgroundThreads(std::chrono::milliseconds(50));
+        const std::size_t runningBeforeRelease = kx::Quiescence::BackgroundThreadCount();
+        release = true;
+        const bool drained = kx::Quiescence::WaitForBackgroundThreads(std::chrono::milliseconds(10000));
+
+        std::cout << "[Tests] Background threads: " << runningBeforeRelease << " running before release, "
+            << finished.load() << " finished, " << kx::Quiescence::BackgroundThreadCount() << " left." << std::endl;
+        return timedOut && runningBeforeRelease == THREAD_COUNT && drained
+            && finished.load() == THREAD_COUNT && kx::Quiescence::BackgroundThreadCount() == 0;
+    }
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <hook_quiescence|capture_control|background_threads>" << std::endl;
+        return 2;
+    }
+
+    bool passed = false;
+    if (std::strcmp(argv[1], "hook_quiescence") == 0) {
+        passed = TestHookQuiescence();
+    }
+    else if (std::strcmp(argv[1], "capture_control") == 0) {
+        passed = TestCaptureControl();
+    }
+    else if (std::strcmp(argv[1], "background_threads") == 0) {
+        passed = TestBackgroundThreads();
+    }
+    else {
+        std::cerr << "[Tests] Unknown test: " << argv[1] << std::endl;
+        return 2;
+    }
+
+    std::cout << "[Tests] " << argv[1] << (passed ? " passed." : " FAILED.") << std::endl;
+    return passed ? 0 : 1;
+}